@@ -0,0 +1,4 @@
+#! /bin/bash
+
+make clean
+rm -f msg
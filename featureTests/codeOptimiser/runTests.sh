@@ -0,0 +1,8 @@
+#! /bin/bash
+
+echo \# building testCodeOptimiser
+make clean &>msg
+make $@ &>msg
+echo \#-----------------------------------------------------------
+echo \# running testCodeOptimiser ...
+./testCodeOptimiser
@@ -0,0 +1,123 @@
+//--------------------------------------------------------------------------
+/*! \file testCodeOptimiser.cc
+
+  \brief Regression test of the optimiser that is applied to code snippets (codeOptimiser.cc). Every expression is optimised, the variable y is replaced by several values in the original and in the optimised code, and both are evaluated at generation time; they have to agree. Repeated subexpressions of statements have to be hoisted into temporaries of the floating point type of the model only if they are made of floating point names.
+*/
+//--------------------------------------------------------------------------
+
+#include "codeOptimiser.h"
+#include "global.h"
+
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+
+using namespace std;
+
+const char *expressions[]= {
+    "y / -2.0 * 3.0",
+    "y / +2.0 * 3.0",
+    "y / -2.0 * 3.0 > 1.0",
+    "y / - -2.0 * 3.0",
+    "y * -2.0 * 3.0",
+    "y * 2.0 / -4.0 * 3.0",
+    "y - 2.0 * 3.0",
+    "y - -2.0 * 3.0 / 4.0",
+    "-2.0 * 3.0 * y",
+    "(0.5)/2.0*y",
+    "y / (2.0) * 3.0",
+    "y / (-2.0) * (3.0)",
+    "(1.0 - 2.0) * y + 3.0 / 4.0",
+    NULL
+};
+
+const char *values[]= { "(1.7)", "(-1.0)", "(-3.25)", NULL };
+
+//! statements of a float model with repeated subexpressions and whether these may be hoisted; lV and gSyn are float, lD is a double and lN a uint64_t variable of the model
+struct Hoisting {
+    const char *code;
+    bool hoisted;
+} hoisting[]= {
+    { "x= exp(lV*2.0) + exp(lV*2.0);", true },
+    { "x= (lV*gSyn[ipre*10+j]) + (lV*gSyn[ipre*10+j]);", true },
+    { "x= exp(lD*2.0) + exp(lD*2.0);", false },
+    { "x= (lD-1.5)*(lD-1.5);", false },
+    { "x= (lV*lD+1.0) - (lV*lD+1.0)*lV;", false },
+    { "x= (lN*3.0+1.0) + (lN*3.0+1.0);", false },
+    { NULL, false }
+};
+
+
+//! replace the identifier y by value
+string substitute(const string &code, const string &value)
+{
+    string s;
+    for (size_t i= 0; i < code.size(); i++) {
+	bool before= (i > 0) && (isalnum(code[i-1]) || (code[i-1] == '_') || (code[i-1] == '.'));
+	bool after= (i+1 < code.size()) && (isalnum(code[i+1]) || (code[i+1] == '_'));
+	if ((code[i] == 'y') && !before && !after) s+= value;
+	else s+= code[i];
+    }
+    return s;
+}
+
+
+//! compare the original and the optimised code for all values of y
+bool check(const string &what, const string &code, const string &opt)
+{
+    bool ok= true;
+    for (int v= 0; values[v] != NULL; v++) {
+	double a, b;
+	if (!evaluateExpression(substitute(code, values[v]), a) || !evaluateExpression(substitute(opt, values[v]), b)
+	    || (fabs(a - b) > 1e-12*(1.0 + fabs(a)))) {
+	    fprintf(stderr, "%s: \"%s\" was optimised to \"%s\", which differs for y= %s\n", what.c_str(), code.c_str(), opt.c_str(), values[v]);
+	    ok= false;
+	}
+    }
+    return ok;
+}
+
+
+int main()
+{
+    int failed= 0;
+    vector<string> floatNames(1, "y");
+    for (int reduce= 0; reduce < 2; reduce++) {
+	GENN_PREFERENCES::optimizeCode= (reduce == 1);
+	for (int k= 0; expressions[k] != NULL; k++) {
+	    string code= expressions[k];
+	    if (!check("optimiseExpression", code, optimiseExpression(code))) failed++;
+
+	    // the right-hand side of an assignment is optimised in the same way
+	    string stmt= optimiseStatements("x= " + code + ";", "double", floatNames);
+	    size_t from= stmt.find("x= "), to= stmt.rfind(';');
+	    if ((from != 0) || (to == string::npos)) {
+		fprintf(stderr, "optimiseStatements: unexpected result \"%s\" for \"x= %s;\"\n", stmt.c_str(), code.c_str());
+		failed++;
+	    }
+	    else if (!check("optimiseStatements", code, stmt.substr(3, to-3))) failed++;
+	}
+    }
+
+    // temporaries of the float model must not narrow double or integer expressions
+    vector<string> modelFloatNames;
+    modelFloatNames.push_back("lV");
+    modelFloatNames.push_back("gSyn");
+    for (int k= 0; hoisting[k].code != NULL; k++) {
+	string stmt= optimiseStatements(hoisting[k].code, "float", modelFloatNames);
+	bool hoisted= (stmt.find("const float _cse") != string::npos);
+	if (hoisted != hoisting[k].hoisted) {
+	    fprintf(stderr, "optimiseStatements: \"%s\" was optimised to \"%s\"; a repeated subexpression should %sbe hoisted\n", hoisting[k].code, stmt.c_str(), (hoisting[k].hoisted ? "" : "not "));
+	    failed++;
+	}
+    }
+
+    if (failed > 0) {
+	fprintf(stderr, "%d tests of the code optimiser failed\n", failed);
+	return 1;
+    }
+    printf("all tests of the code optimiser passed\n");
+    return 0;
+}
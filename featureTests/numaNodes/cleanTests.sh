@@ -0,0 +1,6 @@
+#! /bin/bash
+
+make clean
+rm -rf *_CODE
+rm -f msg
+rm -f generateALL_CPU_ONLY generateALL*.d generateALL*.flags
@@ -0,0 +1,33 @@
+#define DT 0.1
+
+#include "modelSpec.h"
+
+
+// NEURONS
+//==============
+
+double *neuron_p= NULL;
+double neuron_ini[1] = { // one neuron variable
+    0.0 // 0 - the number of time steps
+};
+
+
+void modelDefinition(NNmodel &model) 
+{
+  initGeNN();
+  model.setName("numaRealloc");
+
+  neuronModel n;
+  n.varNames.push_back("x");
+  n.varTypes.push_back("scalar");
+  n.simCode= "$(x)+= 1.0;";
+  int COUNTER= nModels.size();
+  nModels.push_back(n);
+  model.addNeuronPopulation("node0", 100000, COUNTER, neuron_p, neuron_ini);
+  model.addNeuronPopulation("node1", 100000, COUNTER, neuron_p, neuron_ini);
+  // the second group is simulated by the worker thread of a second NUMA node; nodes that do not exist
+  // leave the thread unpinned
+  model.setNeuronClusterIndex("node1", 0, 1);
+  model.setPrecision(GENN_FLOAT);
+  model.finalize();
+}
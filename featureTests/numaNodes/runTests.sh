@@ -0,0 +1,9 @@
+#! /bin/bash
+
+echo \# building numaRealloc
+genn-buildmodel.sh -c numaRealloc.cc &>msg
+make clean &>>msg
+make &>>msg
+echo \#-----------------------------------------------------------
+echo \# running testNumaRealloc ...
+./testNumaRealloc
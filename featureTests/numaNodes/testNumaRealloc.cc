@@ -0,0 +1,60 @@
+//--------------------------------------------------------------------------
+/*! \file testNumaRealloc.cc
+
+  \brief Test of the worker threads of a model whose groups are simulated on two NUMA nodes (numaUtils.h). The memory of the model is allocated and freed repeatedly, which stops the workers and starts new ones; every cycle has to count exactly the time steps it ran in both groups. As the generated code usually hands the new workers their first task before they are ready, the workers are also restarted directly and given time to pick up any task of their predecessors.
+*/
+//--------------------------------------------------------------------------
+
+#include "numaRealloc_CODE/definitions.h"
+
+#include "numaUtils.h"
+
+#include <cstdio>
+#include <unistd.h>
+
+//! task that counts how often it ran on each node
+void countRuns(int node, void *arg)
+{
+    ((int *) arg)[node]++;
+}
+
+int main()
+{
+    const int cycles= 50, steps= 20;
+    int failed= 0;
+    for (int c= 0; c < cycles; c++) {
+	allocateMem();
+	initialize();
+	for (int s= 0; s < steps; s++) stepTimeCPU();
+	for (int i= 0; i < 100000; i++) {
+	    if ((xnode0[i] != steps) || (xnode1[i] != steps)) {
+		fprintf(stderr, "cycle %d, neuron %d: %g and %g steps instead of %d\n", c, i, xnode0[i], xnode1[i], steps);
+		failed++;
+		break;
+	    }
+	}
+	freeMem();
+    }
+
+    // workers that are started again must not run the last task of the stopped ones
+    const int nodes[2]= {0, 1};
+    int runs[2]= {0, 0};
+    numaStartWorkers(nodes, 2);
+    numaRun(countRuns, runs);
+    numaStopWorkers();
+    numaStartWorkers(nodes, 2);
+    usleep(100000);
+    numaRun(countRuns, runs);
+    numaStopWorkers();
+    if ((runs[0] != 2) || (runs[1] != 2)) {
+	fprintf(stderr, "restarted workers: the task ran %d and %d times instead of twice\n", runs[0], runs[1]);
+	failed++;
+    }
+
+    if (failed > 0) {
+	fprintf(stderr, "%d tests of the NUMA worker threads failed\n", failed);
+	return 1;
+    }
+    printf("all tests of the NUMA worker threads passed\n");
+    return 0;
+}
@@ -0,0 +1,32 @@
+#define DT 0.1
+
+#include "modelSpec.h"
+
+
+// NEURONS
+//==============
+
+double poisson_p[4]= {
+    0.0, // 0 - firing rate (the rates are taken from the array rates)
+    2.55, // 1 - refractory period in ms
+    20.0, // 2 - Vspike
+    -60.0 // 3 - Vrest
+};
+
+double poisson_ini[3]= {
+    -60.0, // 0 - V
+    -10.0, // 1 - spike time
+    0.0 // 2 - time step of the next spike (drawn at the first time step)
+};
+
+
+void modelDefinition(NNmodel &model) 
+{
+  initGeNN();
+  model.setName("poissonWheel");
+  // without incoming synapses the groups are simulated event-driven on a timing wheel
+  model.addNeuronPopulation("spiking", 1000, POISSONNEURON_EVENT, poisson_p, poisson_ini);
+  model.addNeuronPopulation("silent", 1000, POISSONNEURON_EVENT, poisson_p, poisson_ini);
+  model.setPrecision(GENN_FLOAT);
+  model.finalize();
+}
@@ -0,0 +1,9 @@
+#! /bin/bash
+
+echo \# building poissonWheel
+genn-buildmodel.sh -c poissonWheel.cc &>msg
+make clean &>>msg
+make &>>msg
+echo \#-----------------------------------------------------------
+echo \# running testPoissonWheel ...
+./testPoissonWheel
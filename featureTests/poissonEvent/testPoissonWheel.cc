@@ -0,0 +1,71 @@
+//--------------------------------------------------------------------------
+/*! \file testPoissonWheel.cc
+
+  \brief Test of the event-driven simulation of POISSONNEURON_EVENT groups on a timing wheel. The run covers several turns of the wheel and the mean waiting time of the spikes is about half a turn, so that many neurons are kept in their bucket for a later turn. The spike counts of the first and the second half of the run have to match the mean rate of the model, no neuron may spike within its refractory period, and neurons with a rate of zero may never spike.
+*/
+//--------------------------------------------------------------------------
+
+#include "poissonWheel_CODE/definitions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+#define N 1000 //!< Number of neurons of each group
+#define STEPS 5000 //!< Number of time steps of the run
+#define TREFRACT 2.55 //!< Refractory period of the model in ms
+
+int main()
+{
+    int failed= 0;
+    allocateMem();
+    vector<uint64_t> rates(N, (1ULL << 48) / 500), zeros(N, 0);
+    ratesspiking= &rates[0];
+    offsetspiking= 0;
+    ratessilent= &zeros[0];
+    offsetsilent= 0;
+    initialize();
+
+    // the spike probability per time step is rate/MYRAND_MAX, and the neurons become ready to spike again
+    // refractSteps after a spike
+    double p= 1.0 / 500;
+    unsigned int refractSteps= (unsigned int) max(floor(TREFRACT / DT) + 1.0, 2.0);
+    double expected= (STEPS / 2) * N / (refractSteps + (1.0 - p) / p);
+    vector<long> lastSpike(N, -1000000);
+    unsigned int counts[2]= {0, 0}, early= 0, silent= 0;
+    for (int s= 0; s < STEPS; s++) {
+	stepTimeCPU();
+	for (unsigned int k= 0; k < glbSpkCntspiking[0]; k++) {
+	    unsigned int n= glbSpkspiking[k];
+	    if (s - lastSpike[n] < refractSteps) early++;
+	    lastSpike[n]= s;
+	}
+	counts[2 * s / STEPS]+= glbSpkCntspiking[0];
+	silent+= glbSpkCntsilent[0];
+    }
+    for (int h= 0; h < 2; h++) {
+	if (fabs(counts[h] - expected) > 0.07 * expected) {
+	    fprintf(stderr, "half %d of the run: %u spikes instead of about %.0f\n", h, counts[h], expected);
+	    failed++;
+	}
+    }
+    if (early > 0) {
+	fprintf(stderr, "%u spikes within the refractory period of %u time steps\n", early, refractSteps);
+	failed++;
+    }
+    if (silent > 0) {
+	fprintf(stderr, "%u spikes of neurons with a rate of zero\n", silent);
+	failed++;
+    }
+    freeMem();
+
+    if (failed > 0) {
+	fprintf(stderr, "%d tests of the event-driven Poisson neurons failed\n", failed);
+	return 1;
+    }
+    printf("all tests of the event-driven Poisson neurons passed (%u and %u spikes, about %.0f expected)\n", counts[0], counts[1], expected);
+    return 0;
+}
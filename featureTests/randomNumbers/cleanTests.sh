@@ -0,0 +1,7 @@
+#! /bin/bash
+
+make clean
+rm -rf *_CODE
+rm -f msg
+rm -f sm_version.mk
+rm -f generateALL generateALL_CPU_ONLY generateALL*.d generateALL*.flags
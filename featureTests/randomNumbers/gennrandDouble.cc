@@ -0,0 +1,29 @@
+#define DT 0.1
+
+#include "modelSpec.h"
+
+
+// NEURONS
+//==============
+
+double *neuron_p= NULL;
+double neuron_ini[1] = { // one neuron variable
+    0.0 // 0 - the last random number
+};
+
+
+void modelDefinition(NNmodel &model) 
+{
+  initGeNN();
+  model.setName("gennrandDouble");
+
+  neuronModel n;
+  n.varNames.push_back("x");
+  n.varTypes.push_back("scalar");
+  n.simCode= "$(x)= $(gennrand_uniform);";
+  int RANDNEURON= nModels.size();
+  nModels.push_back(n);
+  model.addNeuronPopulation("rand", 1, RANDNEURON, neuron_p, neuron_ini);
+  model.setPrecision(GENN_DOUBLE);
+  model.finalize();
+}
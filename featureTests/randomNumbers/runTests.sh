@@ -0,0 +1,17 @@
+#! /bin/bash
+
+# pass CPU_ONLY=1 to test a CPU_ONLY installation of GeNN
+for arg in "$@"; do
+    if [[ "$arg" == "CPU_ONLY=1" ]]; then BUILD_FLAGS=-c; fi
+done
+
+echo \# building gennrandFloat and gennrandDouble
+genn-buildmodel.sh $BUILD_FLAGS gennrandFloat.cc &>msg
+genn-buildmodel.sh $BUILD_FLAGS gennrandDouble.cc &>>msg
+make clean &>>msg
+make $@ &>>msg
+echo \#-----------------------------------------------------------
+echo \# running testGennrandFloat ...
+./testGennrandFloat
+echo \# running testGennrandDouble ...
+./testGennrandDouble
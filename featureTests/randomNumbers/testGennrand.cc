@@ -0,0 +1,64 @@
+//--------------------------------------------------------------------------
+/*! \file testGennrand.cc
+
+  \brief Test of the counter-based random number generator that GeNN generates into definitions.h for $(gennrand_uniform) and $(gennrand_normal). gennPhilox() has to reproduce the known-answer vectors of Philox4x32-10 that are published with Random123, and uniform numbers have to lie in the open interval (0,1) also for the extreme bit patterns. The test is compiled once for the float and once for the double model.
+*/
+//--------------------------------------------------------------------------
+
+#include "definitions.h"
+
+#include <cstdio>
+#include <cmath>
+
+//! known-answer vectors of Philox4x32-10 from Random123: counter, key, result
+const uint32_t kat[3][10]= {
+    { 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+      0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+    { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+      0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+    { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0,
+      0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }
+};
+
+
+int main()
+{
+    int failed= 0;
+    for (int k= 0; k < 3; k++) {
+	uint32_t c[4]= { kat[k][0], kat[k][1], kat[k][2], kat[k][3] };
+	gennPhilox(c, kat[k][4], kat[k][5]);
+	for (int i= 0; i < 4; i++) {
+	    if (c[i] != kat[k][6+i]) {
+		fprintf(stderr, "known-answer vector %d: word %d is %08x instead of %08x\n", k, i, c[i], kat[k][6+i]);
+		failed++;
+	    }
+	}
+    }
+
+    // the extreme bit patterns and the draws of one neuron over many time steps
+    const uint32_t bits[4]= { 0x00000000, 0x00000001, 0xfffffffe, 0xffffffff };
+    for (int i= 0; i < 4; i++) {
+	for (int j= 0; j < 4; j++) {
+	    scalar u= gennrandUniformBits(bits[i], bits[j]);
+	    if (!(u > 0) || !(u < 1)) {
+		fprintf(stderr, "gennrandUniformBits(%08x, %08x)= %.17g is not in (0,1)\n", bits[i], bits[j], (double) u);
+		failed++;
+	    }
+	}
+    }
+    for (unsigned long long step= 0; step < 1000000; step++) {
+	scalar u= gennrandUniform(1234, 0, 0, step, 0);
+	scalar n= gennrandNormal(1234, 0, 0, step, 0);
+	if (!(u > 0) || !(u < 1) || !std::isfinite(n)) {
+	    fprintf(stderr, "step %llu: uniform %.17g, normal %.17g\n", step, (double) u, (double) n);
+	    failed++;
+	}
+    }
+
+    if (failed > 0) {
+	fprintf(stderr, "%d tests of the random number generator failed\n", failed);
+	return 1;
+    }
+    printf("all tests of the random number generator passed\n");
+    return 0;
+}
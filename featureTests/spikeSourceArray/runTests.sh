@@ -0,0 +1,8 @@
+#! /bin/bash
+
+echo \# building testSpikeSourceArray
+make clean &>msg
+make $@ &>msg
+echo \#-----------------------------------------------------------
+echo \# running testSpikeSourceArray ...
+./testSpikeSourceArray
@@ -0,0 +1,109 @@
+//--------------------------------------------------------------------------
+/*! \file testSpikeSourceArray.cc
+
+  \brief Test of the spike source array files of SPIKESOURCEARRAY neuron groups (spikeSourceUtils.h). A small file is written and loaded, and the spike-time cursors and spike times have to match the written spikes. Files with decreasing or out-of-range row starts, truncated files and files with spike times of the wrong size have to be rejected; as gennError() ends the program, each of them is loaded in a child process that has to fail.
+*/
+//--------------------------------------------------------------------------
+
+#include "spikeSourceUtils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+#define N 4 //!< Number of neurons of the test group
+
+//! spike times of the test group, the first neuron unsorted and the second one without spikes
+const float times[N][3]= { {3.0f, 1.0f}, {}, {0.5f}, {2.0f, 2.0f, 4.5f} };
+const int spikeN[N]= { 2, 0, 1, 3 };
+const unsigned int rowStart[N+1]= { 0, 2, 2, 3, 6 };
+const float sorted[6]= { 1.0f, 3.0f, 0.5f, 2.0f, 2.0f, 4.5f };
+
+
+//! write the spikes of the test group with spike times of type T
+template <class T>
+void writeSpikes(const string &file)
+{
+    vector<vector<T> > spikeTimes(N);
+    for (int n= 0; n < N; n++) {
+	for (int k= 0; k < spikeN[n]; k++) spikeTimes[n].push_back(times[n][k]);
+    }
+    gennWriteSpikeSourceArray(file, spikeTimes);
+}
+
+
+//! overwrite the row start of neuron n in a file
+void setRowStart(const string &file, int n, unsigned int rowStart)
+{
+    FILE *f= fopen(file.c_str(), "r+b");
+    fseek(f, (4 + n) * sizeof(unsigned int), SEEK_SET);
+    fwrite(&rowStart, sizeof(unsigned int), 1, f);
+    fclose(f);
+}
+
+
+//! check that loading a file as float spike times fails in a child process
+bool rejected(const string &file)
+{
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid= fork();
+    if (pid == 0) {
+	unsigned int startSpike[N], endSpike[N];
+	gennLoadSpikeSourceArray<float>(file, N, startSpike, endSpike);
+	_exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_FAILURE);
+}
+
+
+int main()
+{
+    int failed= 0;
+    writeSpikes<float>("spikes.ssa");
+    unsigned int startSpike[N], endSpike[N];
+    float *spikeTimes= gennLoadSpikeSourceArray<float>("spikes.ssa", N, startSpike, endSpike);
+    for (int n= 0; n < N; n++) {
+	if ((startSpike[n] != rowStart[n]) || (endSpike[n] != rowStart[n+1])) {
+	    fprintf(stderr, "neuron %d: the spikes are %u to %u instead of %u to %u\n", n, startSpike[n], endSpike[n], rowStart[n], rowStart[n+1]);
+	    failed++;
+	}
+    }
+    for (int k= 0; k < 6; k++) {
+	if (spikeTimes[k] != sorted[k]) {
+	    fprintf(stderr, "spike %d: the time is %g instead of %g\n", k, spikeTimes[k], sorted[k]);
+	    failed++;
+	}
+    }
+    gennUnmapSpikeSourceArray(spikeTimes);
+
+    // invalid files
+    writeSpikes<float>("decreasing.ssa");
+    setRowStart("decreasing.ssa", 2, 1);
+    writeSpikes<float>("outOfRange.ssa");
+    setRowStart("outOfRange.ssa", N, 7);
+    writeSpikes<float>("truncated.ssa");
+    if (truncate("truncated.ssa", 16 + 6 * sizeof(unsigned int) + 5 * sizeof(float)) != 0) failed++;
+    writeSpikes<double>("double.ssa");
+    const char *invalid[]= { "decreasing.ssa", "outOfRange.ssa", "truncated.ssa", "double.ssa", NULL };
+    for (int k= 0; invalid[k] != NULL; k++) {
+	if (!rejected(invalid[k])) {
+	    fprintf(stderr, "the invalid file %s was loaded\n", invalid[k]);
+	    failed++;
+	}
+    }
+
+    if (failed > 0) {
+	fprintf(stderr, "%d tests of the spike source array files failed\n", failed);
+	return 1;
+    }
+    printf("all tests of the spike source array files passed\n");
+    return 0;
+}
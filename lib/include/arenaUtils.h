@@ -0,0 +1,57 @@
+//--------------------------------------------------------------------------
+/*! \file arenaUtils.h
+
+  \brief Functions used by generated CPU code to allocate the arrays of a model from one block of memory (arena).
+
+  Arrays in an arena start at multiples of GENN_ARENA_ALIGN bytes, so that they are aligned for the widest SIMD loads, and their sizes are padded to this alignment. Arenas of at least one huge page can be backed by transparent or explicit huge pages (Linux only) to reduce TLB misses.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef ARENAUTILS_H
+#define ARENAUTILS_H
+
+#include <cstddef>
+
+#define GENN_ARENA_ALIGN 64 //!< Alignment of the arrays in an arena in bytes, which is the size of a cache line and of an AVX-512 vector
+#define GENN_HUGE_PAGE_SIZE 2097152 //!< Size of a huge page in bytes
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that reserves space for an array at the end of an arena and returns its offset in bytes.
+
+  The array starts at a multiple of align bytes and its size is padded to a multiple of GENN_ARENA_ALIGN bytes. As the sizes are usually known at compile time, the function is inline so that the offsets are computed by the compiler.
+ */
+//--------------------------------------------------------------------------
+
+inline size_t gennArenaReserve(size_t &arenaSize, //!< Size of the arena in bytes, which is increased by the array
+			       size_t size, //!< Size of the array in bytes
+			       size_t align= GENN_ARENA_ALIGN //!< Alignment of the start of the array in bytes
+    )
+{
+    size_t offset= ((arenaSize + align - 1) / align) * align;
+    arenaSize= offset + ((size + GENN_ARENA_ALIGN - 1) / GENN_ARENA_ALIGN) * GENN_ARENA_ALIGN;
+    return offset;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that allocates an arena.
+
+  With hugePages 1 arenas of at least one huge page are aligned to huge pages and transparent huge pages are requested for them; with hugePages 2 explicit huge pages are used if the system provides enough of them, and transparent huge pages otherwise.
+ */
+//--------------------------------------------------------------------------
+
+char *gennArenaAlloc(size_t size, //!< Size of the arena in bytes
+		     int hugePages //!< Use of huge pages (0: none, 1: transparent, 2: explicit)
+    );
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that frees an arena allocated by gennArenaAlloc(); NULL is ignored.
+ */
+//--------------------------------------------------------------------------
+
+void gennArenaFree(char *arena //!< The arena
+    );
+
+#endif // ARENAUTILS_H
@@ -0,0 +1,72 @@
+//--------------------------------------------------------------------------
+/*! \file codeOptimiser.h
+
+  \brief Small expression-level optimiser that is applied to code snippets after parameter values have been substituted. Part of the code generation section.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef CODEOPTIMISER_H
+#define CODEOPTIMISER_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function folds constant subexpressions and strength-reduces divisions by constants in a code snippet that is a single expression (e.g. a threshold condition).
+ */
+//--------------------------------------------------------------------------
+
+string optimiseExpression(string code);
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function folds constant subexpressions, hoists subexpressions and pure math function calls that are repeated within a statement into temporaries of type ftype, and strength-reduces divisions by constants in a code snippet made of statements (e.g. a simCode). Only subexpressions made of the identifiers and arrays in floatNames, floating point literals and pure math functions are hoisted.
+ */
+//--------------------------------------------------------------------------
+
+string optimiseStatements(string code, string ftype, const vector<string> &floatNames);
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function moves the floating point subexpressions of a code snippet in the body of a loop that do not change within the loop into temporaries of type ftype, whose declarations are returned in hoisted for emission in front of the loop.
+ */
+//--------------------------------------------------------------------------
+
+string hoistLoopInvariant(string code, const vector<string> &variant, const vector<string> &floatNames, string ftype, string &hoisted);
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function checks whether a code snippet (e.g. a condition) in the body of a loop does not change within the loop, i.e. it refers to none of the identifiers in variant, has no side effects and calls only pure math functions.
+ */
+//--------------------------------------------------------------------------
+
+bool isLoopInvariant(string code, const vector<string> &variant);
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function checks whether the only effect of a code snippet is to add a value to target (e.g. the postsynaptic input of a synapse) in its last statement. It returns the preceding statements in body and the added value in value.
+ */
+//--------------------------------------------------------------------------
+
+bool splitAccumulation(string code, string target, const vector<string> &locals, string &body, string &value);
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function checks whether a code snippet is linear and homogeneous in the variable name, so that applying it to a sum of values is the same as applying it to each of them and adding the results.
+ */
+//--------------------------------------------------------------------------
+
+bool isLinearIn(string code, string name);
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function evaluates a code snippet that is a constant expression at generation time. It returns false if the snippet refers to anything but constants and pure math functions.
+ */
+//--------------------------------------------------------------------------
+
+bool evaluateExpression(string code, double &val);
+
+#endif // CODEOPTIMISER_H
@@ -27,6 +27,112 @@
 using namespace std;
 
 
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that lists the NUMA nodes the CPU code of the model runs on, which are the distinct device IDs of the cluster indices of the groups.
+*/
+//--------------------------------------------------------------------------
+
+vector<int> cpuNodes(NNmodel &model //!< Model description
+    );
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the index in cpuNodes() of the NUMA node a neuron group is simulated on.
+*/
+//--------------------------------------------------------------------------
+
+unsigned int neuronCPUNode(NNmodel &model, //!< Model description
+			   int i //!< Index of the neuron group
+    );
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the index in cpuNodes() of the NUMA node a synapse group is simulated on, which by default is the node of its postsynaptic neuron group.
+*/
+//--------------------------------------------------------------------------
+
+unsigned int synapseCPUNode(NNmodel &model, //!< Model description
+			    int i //!< Index of the synapse group
+    );
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that lists the hosts (MPI ranks) the CPU code of the model runs on, which are the distinct host IDs of the cluster indices of the groups.
+*/
+//--------------------------------------------------------------------------
+
+vector<int> cpuHosts(NNmodel &model //!< Model description
+    );
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the synapse group whose postsynaptic input array a synapse group adds to, which is the group itself unless its inputs are merged.
+*/
+//--------------------------------------------------------------------------
+
+unsigned int inSynGroup(NNmodel &model, //!< Model description
+			int i //!< Index of the synapse group
+    );
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that checks whether the CPU code of a synapse group chooses at every time step between pushing the spikes along the rows of its connectivity and pulling them into the targets along the reverse connectivity.
+*/
+//--------------------------------------------------------------------------
+
+bool pullsSpikes(NNmodel &model, //!< Model description
+		 int i //!< Index of the synapse group
+    );
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the host (MPI rank) a synapse group is simulated on, which is the host of its postsynaptic neuron group.
+*/
+//--------------------------------------------------------------------------
+
+int synapseHost(NNmodel &model, //!< Model description
+		int i //!< Index of the synapse group
+    );
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that checks whether the spikes of a neuron group are needed on other hosts (MPI ranks).
+*/
+//--------------------------------------------------------------------------
+
+bool exportsSpikes(NNmodel &model, //!< Model description
+		   int i //!< Index of the neuron group
+    );
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the number of time steps after which spikes are exchanged between the hosts (MPI ranks) of a distributed model.
+*/
+//--------------------------------------------------------------------------
+
+unsigned int spikeExchangeWindow(NNmodel &model //!< Model description
+    );
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that partitions the neuron groups into sets whose CPU code is generated as one function, named after the first group of each set.
+*/
+//--------------------------------------------------------------------------
+
+vector<vector<unsigned int> > mergeNeuronGroups(NNmodel &model //!< Model description
+    );
+
+
 //--------------------------------------------------------------------------
 /*!
   \brief Function that generates the code of the function the will simulate all neurons on the CPU.
@@ -32,14 +32,14 @@ using namespace std;
 //! \brief This fucntion generates host and device variable definitions, of the given type and name.
 //--------------------------------------------------------------------------
 
-void variable_def(ofstream &os, string type, string name);
+void variable_def(ostream &os, string type, string name);
 
 
 //--------------------------------------------------------------------------
 //! \brief This fucntion generates host extern variable definitions, of the given type and name.
 //--------------------------------------------------------------------------
 
-void extern_variable_def(ofstream &os, string type, string name);
+void extern_variable_def(ostream &os, string type, string name);
 
 
 //--------------------------------------------------------------------------
@@ -0,0 +1,191 @@
+/*--------------------------------------------------------------------------*/
+/*! \file gennChannel.h
+
+  \brief Lock-free single-producer single-consumer channels in shared memory, which stream inputs into and spikes out of a running simulation.
+
+  A channel is a ring of a fixed number of message slots of a fixed size in a memory mapped file (e.g. in /dev/shm), so that the simulation and another local process can open it by the same file name. One process writes messages and the other reads them; neither ever waits for the other. A producer that finds the ring full drops its message and counts it in dropped.
+
+  The header is plain C (with the __atomic builtins of gcc and clang) and is used both by the code generated for NNmodel::addInputChannel() and NNmodel::addSpikeOutputChannel() and by the processes at the other end of the channels. It is only available on POSIX systems.
+*/
+/*--------------------------------------------------------------------------*/
+
+#ifndef GENNCHANNEL_H
+#define GENNCHANNEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define GENN_CHANNEL_MAGIC 0x4e484347 /*!< Marker of an initialised channel ("GCHN") */
+#define GENN_CHANNEL_SPIKE_SLOT_SIZE(N) ((12 + 4*(N) + 7) & ~7) /*!< Slot size of the spike output channel of a group of N neurons; a message is the time step (uint64_t), the spike count (uint32_t) and the spiking neurons (uint32_t each) */
+
+
+/*--------------------------------------------------------------------------*/
+/*! \brief Header of a channel, which is followed by its message slots.
+
+  The counters written by the producer and by the consumer are in separate cache lines.
+*/
+/*--------------------------------------------------------------------------*/
+
+typedef struct {
+    uint32_t magic; /*!< GENN_CHANNEL_MAGIC once the channel is initialised */
+    uint32_t slotSize; /*!< Size of a message slot in bytes, a multiple of 8 */
+    uint32_t slots; /*!< Number of message slots */
+    uint32_t reserved;
+    uint64_t dropped; /*!< Number of messages dropped by the producer because the ring was full */
+    char pad0[40];
+    uint64_t head; /*!< Number of messages written; only changed by the producer */
+    char pad1[56];
+    uint64_t tail; /*!< Number of messages read; only changed by the consumer */
+    char pad2[56];
+} gennChannel;
+
+
+/*--------------------------------------------------------------------------*/
+/*! \brief Function that opens a channel, which is created if the file does not exist yet; returns NULL if the file cannot be mapped or holds a channel with a different slot size or number of slots.
+
+  Both ends of a channel open it with the same slot size and number of slots, in any order.
+*/
+/*--------------------------------------------------------------------------*/
+
+static inline gennChannel *gennChannelOpen(const char *file, /*!< Name of the file that holds the channel */
+					   uint32_t slotSize, /*!< Size of a message in bytes, which is rounded up to a multiple of 8 */
+					   uint32_t slots /*!< Number of messages the channel can hold */
+    )
+{
+    struct stat st;
+    void *mapped= MAP_FAILED;
+    gennChannel *c= NULL;
+    size_t size;
+    int fd;
+    slotSize= (slotSize + 7) & ~7u;
+    size= sizeof(gennChannel) + (size_t) slotSize * slots;
+    fd= open(file, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) return NULL;
+    if ((flock(fd, LOCK_EX) == 0) && (fstat(fd, &st) == 0)
+	&& (((st.st_size == 0) && (ftruncate(fd, size) == 0)) || ((size_t) st.st_size == size))) {
+	mapped= mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (mapped != MAP_FAILED) {
+	c= (gennChannel *) mapped;
+	if (c->magic != GENN_CHANNEL_MAGIC) {
+	    memset(c, 0, sizeof(gennChannel));
+	    c->slotSize= slotSize;
+	    c->slots= slots;
+	    __atomic_store_n(&c->magic, GENN_CHANNEL_MAGIC, __ATOMIC_RELEASE);
+	}
+	else if ((c->slotSize != slotSize) || (c->slots != slots)) {
+	    munmap(mapped, size);
+	    c= NULL;
+	}
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+    return c;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/*! \brief Function that closes a channel; the file is kept for the other end and for later runs.
+*/
+/*--------------------------------------------------------------------------*/
+
+static inline void gennChannelClose(gennChannel *c /*!< The channel */
+    )
+{
+    if (c != NULL) munmap(c, sizeof(gennChannel) + (size_t) c->slotSize * c->slots);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/*! \brief Function that returns the slot for the next message of the producer, or NULL (and counts the message as dropped) if the channel is full.
+
+  The message is sent with gennChannelCommit().
+*/
+/*--------------------------------------------------------------------------*/
+
+static inline void *gennChannelReserve(gennChannel *c /*!< The channel */
+    )
+{
+    uint64_t head= __atomic_load_n(&c->head, __ATOMIC_RELAXED);
+    if (head - __atomic_load_n(&c->tail, __ATOMIC_ACQUIRE) >= c->slots) {
+	c->dropped++;
+	return NULL;
+    }
+    return (char *) (c + 1) + (size_t) (head % c->slots) * c->slotSize;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/*! \brief Function that sends the message written into the slot returned by gennChannelReserve().
+*/
+/*--------------------------------------------------------------------------*/
+
+static inline void gennChannelCommit(gennChannel *c /*!< The channel */
+    )
+{
+    __atomic_store_n(&c->head, __atomic_load_n(&c->head, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/*! \brief Function that sends a message of at most slotSize bytes; returns 0 if the channel is full and the message was dropped.
+*/
+/*--------------------------------------------------------------------------*/
+
+static inline int gennChannelPush(gennChannel *c, /*!< The channel */
+				  const void *msg, /*!< The message */
+				  size_t size /*!< Size of the message in bytes */
+    )
+{
+    void *slot= gennChannelReserve(c);
+    if (slot == NULL) return 0;
+    memcpy(slot, msg, size);
+    gennChannelCommit(c);
+    return 1;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/*! \brief Function that receives the oldest message of a channel into msg (slotSize bytes); returns 0 if there is none.
+*/
+/*--------------------------------------------------------------------------*/
+
+static inline int gennChannelPop(gennChannel *c, /*!< The channel */
+				 void *msg /*!< Buffer for the message */
+    )
+{
+    uint64_t tail= __atomic_load_n(&c->tail, __ATOMIC_RELAXED);
+    if (tail == __atomic_load_n(&c->head, __ATOMIC_ACQUIRE)) return 0;
+    memcpy(msg, (char *) (c + 1) + (size_t) (tail % c->slots) * c->slotSize, c->slotSize);
+    __atomic_store_n(&c->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+
+/*--------------------------------------------------------------------------*/
+/*! \brief Function that receives the newest message of a channel into msg (size bytes) and discards the older ones; returns the number of messages consumed.
+
+  The cost does not depend on the number of waiting messages, so that a consumer that only needs the latest value of an input keeps a bounded latency.
+*/
+/*--------------------------------------------------------------------------*/
+
+static inline uint64_t gennChannelPopLatest(gennChannel *c, /*!< The channel */
+					    void *msg, /*!< Buffer for the message */
+					    size_t size /*!< Number of bytes of the message to receive */
+    )
+{
+    uint64_t tail= __atomic_load_n(&c->tail, __ATOMIC_RELAXED);
+    uint64_t head= __atomic_load_n(&c->head, __ATOMIC_ACQUIRE);
+    if (tail == head) return 0;
+    memcpy(msg, (char *) (c + 1) + (size_t) ((head - 1) % c->slots) * c->slotSize, size);
+    __atomic_store_n(&c->tail, head, __ATOMIC_RELEASE);
+    return head - tail;
+}
+
+#endif /* GENNCHANNEL_H */
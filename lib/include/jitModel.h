@@ -0,0 +1,82 @@
+//--------------------------------------------------------------------------
+/*! \file jitModel.h
+
+  \brief Functions for generating, compiling and loading the code of a model from within a running program. Part of the code generation section.
+
+  This is an alternative to building a model with genn-buildmodel.sh and linking the generated runner.o into the simulation. The code is compiled into a shared library with the flags of the generated Makefile and is loaded with dlopen(). A long running program can therefore build and replace models without restarting. Programs using these functions link against libgenn (and libdl where needed) and need GENN_PATH to be set. Not available on Windows.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef JITMODEL_H
+#define JITMODEL_H
+
+#include "modelSpec.h"
+
+#include <string>
+
+using namespace std;
+
+
+//--------------------------------------------------------------------------
+/*! \brief Handle of a model that was generated, compiled and loaded by buildModelJIT().
+
+  The generated functions are called through the function pointers. State arrays and other global variables of the model are looked up by their name in the generated code, e.g. getArray<float>("VPN") for the variable V of neuron population PN. Runtime parameters are changed through their setters, e.g. getFunction<void (*)(float)>("setVthreshPN").
+*/
+//--------------------------------------------------------------------------
+
+class JITModel
+{
+public:
+    string name; //!< Name of the model
+    string path; //!< Directory in which the code of the model was generated
+    void *library; //!< Handle of the loaded shared library
+
+    void (*allocateMem)(); //!< allocateMem() of the generated code
+    void (*initialize)(); //!< initialize() of the generated code
+    void (*init)(); //!< init<model name>() of the generated code, which initializes sparse connectivity
+    void (*stepTimeCPU)(); //!< stepTimeCPU() of the generated code
+    void (*freeMem)(); //!< freeMem() of the generated code
+    void (*exitGeNN)(); //!< exitGeNN() of the generated code
+#ifndef CPU_ONLY
+    void (*stepTimeGPU)(); //!< stepTimeGPU() of the generated code
+    void (*copyStateToDevice)(); //!< copyStateToDevice() of the generated code
+    void (*copyStateFromDevice)(); //!< copyStateFromDevice() of the generated code
+#endif
+
+    void *getSymbol(const string &symbol);
+    bool hasSymbol(const string &symbol);
+
+    //! Returns a pointer to a global variable of the model, e.g. getVar<unsigned long long>("iT")
+    template <class T>
+    T *getVar(const string &var) { return (T *) getSymbol(var); }
+
+    //! Returns a generated function with C linkage, e.g. the setter of a runtime parameter
+    template <class F>
+    F getFunction(const string &function) { return (F) getSymbol(function); }
+
+    //! Returns the host array of a state variable or spike buffer, e.g. getArray<float>("VPN"); only valid after allocateMem()
+    template <class T>
+    T *getArray(const string &var) { return *((T **) getSymbol(var)); }
+};
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that generates the code of a finalized model, compiles it into a shared library and loads it.
+
+  If no path is given, the code is generated in a new temporary directory. A path that is used again for a changed model only recompiles the translation units that changed; the model previously loaded from that path must be unloaded first.
+ */
+//--------------------------------------------------------------------------
+
+JITModel *buildModelJIT(NNmodel &model, //!< Model description
+			string path= "" //!< Directory in which the code is generated
+    );
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that unloads a model loaded by buildModelJIT() and deletes its handle. Memory of the model should be freed with freeMem() before.
+ */
+//--------------------------------------------------------------------------
+
+void unloadModelJIT(JITModel *jit);
+
+#endif // JITMODEL_H
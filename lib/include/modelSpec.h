@@ -62,6 +62,10 @@ extern unsigned int GeNNReady;
 #define GENN_FLOAT 0  //!< Macro attaching the label "GENN_FLOAT" to flag 0. Used by NNModel::setPrecision()
 #define GENN_DOUBLE 1  //!< Macro attaching the label "GENN_DOUBLE" to flag 1. Used by NNModel::setPrecision()
 
+#define GENN_MATH_EXACT 0  //!< Macro attaching the label "GENN_MATH_EXACT" to flag 0. Used by NNModel::setMathPrecision()
+#define GENN_MATH_FAST 1  //!< Macro attaching the label "GENN_MATH_FAST" to flag 1. Used by NNModel::setMathPrecision()
+#define GENN_MATH_APPROX 2  //!< Macro attaching the label "GENN_MATH_APPROX" to flag 2. Used by NNModel::setMathPrecision()
+
 #define AUTODEVICE -1  //!< Macro attaching the label AUTODEVICE to flag -1. Used by setGPUDevice
 
 
@@ -79,11 +83,13 @@ public:
 
   string name; //!< Name of the neuronal newtwork model
   string ftype; //!< Type of floating point variables (float, double, ...; default: float)
+  unsigned int mathPrecision; //!< Precision tier of the exp, log, tanh and pow functions in the code snippets (GENN_MATH_EXACT, GENN_MATH_FAST or GENN_MATH_APPROX; default: GENN_MATH_EXACT)
   string RNtype; //!< Underlying type for random number generation (default: long)
   double dt; //!< The integration time step of the model
   int final; //!< Flag for whether the model has been finalized
   unsigned int needSt; //!< Whether last spike times are needed at all in this network model (related to STDP)
   unsigned int needSynapseDelay; //!< Whether delayed synapse conductance is required in the network
+  bool needGennrand; //!< Whether any neuron group draws counter-based random numbers with $(gennrand_uniform) or $(gennrand_normal)
   bool timing;
   unsigned int seed;
   unsigned int resetKernel;  //!< The identity of the kernel in which the spike counters will be reset.
@@ -101,6 +107,7 @@ public:
   vector<unsigned int> neuronType; //!< Types of neurons
   vector<vector<double> > neuronPara; //!< Parameters of neurons
   vector<vector<double> > dnp; //!< Derived neuron parameters
+  vector<vector<bool> > neuronParaRuntime; //!< Whether a neuron parameter is a runtime parameter rather than a constant in the generated code
   vector<vector<double> > neuronIni; //!< Initial values of neurons
   vector<vector<unsigned int> > inSyn; //!< The ids of the incoming synapse groups
   vector<vector<unsigned int> > outSyn; //!< The ids of the outgoing synapse groups
@@ -110,8 +117,8 @@ public:
   vector<vector<bool> > neuronVarNeedQueue; //!< Whether a neuron variable needs queueing for syn code
   vector<string> neuronSpkEvntCondition; //!< Will contain the spike event condition code when spike events are used
   vector<unsigned int> neuronDelaySlots; //!< The number of slots needed in the synapse delay queues of a neuron group
-  vector<int> neuronHostID; //!< The ID of the cluster node which the neuron groups are computed on
-  vector<int> neuronDeviceID; //!< The ID of the CUDA device which the neuron groups are comnputed on
+  vector<int> neuronHostID; //!< The ID of the cluster node which the neuron groups are computed on; in CPU_ONLY code the MPI rank
+  vector<int> neuronDeviceID; //!< The ID of the CUDA device which the neuron groups are comnputed on; in CPU_ONLY code the NUMA node
 
 
   // PUBLIC SYNAPSE VARIABLES
@@ -138,10 +145,12 @@ public:
   vector<vector<double> > synapsePara; //!< parameters of synapses
   vector<vector<double> > synapseIni; //!< Initial values of synapse variables
   vector<vector<double> > dsp_w;  //!< Derived synapse parameters (weightUpdateModel only)
+  vector<vector<bool> > synapseParaRuntime; //!< Whether a synapse parameter is a runtime parameter rather than a constant in the generated code
   vector<unsigned int> postSynapseType; //!< Types of post-synaptic model
   vector<vector<double> > postSynapsePara; //!< parameters of postsynapses
   vector<vector<double> > postSynIni; //!< Initial values of postsynaptic variables
   vector<vector<double> > dpsp;  //!< Derived postsynapse parameters
+  vector<vector<bool> > postSynapseParaRuntime; //!< Whether a postsynapse parameter is a runtime parameter rather than a constant in the generated code
   unsigned int lrnGroups; //!< Number of synapse groups with learning
   vector<unsigned int> padSumLearnN; //!< Padded summed neuron numbers of learn group source populations
   vector<unsigned int> lrnSynGrp; //!< Enumeration of the IDs of synapse groups that learn
@@ -149,8 +158,18 @@ public:
   unsigned int synDynGroups; //!< Number of synapse groups that define continuous synapse dynamics
   vector<unsigned int> synDynGrp; //!< Enumeration of the IDs of synapse groups that have synapse Dynamics
   vector<unsigned int> padSumSynDynN; //!< Padded summed neuron numbers of synapse dynamics group source populations
-  vector<int> synapseHostID; //!< The ID of the cluster node which the synapse groups are computed on
-  vector<int> synapseDeviceID; //!< The ID of the CUDA device which the synapse groups are comnputed on
+  vector<int> synapseHostID; //!< The ID of the cluster node which the synapse groups are computed on; -1 (the default) means the host of the postsynaptic group, which is the only host allowed in CPU_ONLY code
+  vector<int> synapseDeviceID; //!< The ID of the CUDA device which the synapse groups are comnputed on; -1 (the default) means the device of the postsynaptic group
+
+
+  // PUBLIC CHANNEL VARIABLES
+  //=========================
+
+  vector<string> channelFile; //!< Files of the shared-memory channels that stream inputs into and spikes out of the simulation
+  vector<unsigned int> channelNeuronGrp; //!< Neuron groups the channels are bound to
+  vector<string> channelParameter; //!< Extra global parameters the input channels write; empty for spike output channels
+  vector<unsigned int> channelSize; //!< Number of values of a message of an input channel
+  vector<unsigned int> channelSlots; //!< Number of messages a channel can hold
 
 
   // PUBLIC KERNEL PARAMETER VARIABLES
@@ -192,6 +211,7 @@ private:
   void initDerivedSynapsePara(); //!< Method for calculating the values of derived synapse parameters.
   void initDerivedPostSynapsePara(); //!< Method for calculating the values of derived postsynapse parameters.
   void registerSynapsePopulation(unsigned int); //!< Method to register a new synapse population with the inSyn list of the target neuron population
+  void registerRuntimeKernelParameters(); //!< Method to add the runtime parameters to the kernel parameter lists
 
 public:
 
@@ -203,6 +223,7 @@ public:
   ~NNmodel();
   void setName(const string); //!< Method to set the neuronal network model name
   void setPrecision(unsigned int); //!< Set numerical precision for floating point
+  void setMathPrecision(unsigned int); //!< Set the precision tier of the math functions used in the code snippets
   void setDT(double); //!< Set the integration step size of the model
   void setTiming(bool); //!< Set whether timers and timing commands are to be included
   void setSeed(unsigned int); //!< Set the random seed (disables automatic seeding if argument not 0).
@@ -224,6 +245,10 @@ public:
   void activateDirectInput(const string, unsigned int type); //! This function has been deprecated in GeNN 2.2
   void setConstInp(const string, double);
   unsigned int findNeuronGrp(const string); //!< Find the the ID number of a neuron group by its name 
+  void setNeuronParaRuntime(const string neuronGroup, const string paraName); //!< Method for making a parameter of a neuron group a runtime parameter that can be changed during the simulation
+  vector<string> runtimeNeuronParaNames(unsigned int); //!< Names of the runtime and derived parameters of a neuron group that are global variables in the generated code
+  void addInputChannel(const string neuronGroup, const string paraName, const string file, unsigned int size= 1, unsigned int slots= 16); //!< Method for streaming the values of an extra global parameter of a neuron group from a shared-memory channel
+  void addSpikeOutputChannel(const string neuronGroup, const string file, unsigned int slots= 16); //!< Method for streaming the spikes of a neuron group to a shared-memory channel
   
 
   // PUBLIC SYNAPSE FUNCTIONS
@@ -239,6 +264,10 @@ public:
   void setSynapseClusterIndex(const string synapseGroup, int hostID, int deviceID); //!< Function for setting which host and which device a synapse group will be simulated on
   void initLearnGrps();
   unsigned int findSynapseGrp(const string); //< Find the the ID number of a synapse group by its name
+  void setSynapseParaRuntime(const string synapseGroup, const string paraName); //!< Method for making a weight update parameter of a synapse group a runtime parameter that can be changed during the simulation
+  void setPostSynapseParaRuntime(const string synapseGroup, const string paraName); //!< Method for making a postsynaptic parameter of a synapse group a runtime parameter that can be changed during the simulation
+  vector<string> runtimeSynapseParaNames(unsigned int); //!< Names of the runtime and derived weight update parameters of a synapse group that are global variables in the generated code
+  vector<string> runtimePostSynapseParaNames(unsigned int); //!< Names of the runtime and derived postsynaptic parameters of a synapse group that are global variables in the generated code
  
 };
 
@@ -6,6 +6,8 @@
 
 #include <string>
 #include <vector>
+#include <cmath>
+#include <algorithm>
 
 using namespace std;
 
@@ -33,9 +35,24 @@ public:
     dpclass *dps; //!< \brief Derived parameters
     bool needPreSt; //!< \brief Whether presynaptic spike times are needed or not
     bool needPostSt; //!< \brief Whether postsynaptic spike times are needed or not
+    bool needAutoRefractory; //!< \brief Whether spikes are suppressed while the threshold condition stays true (GENN_PREFERENCES::autoRefractory); true by default, models whose reset code makes the threshold condition false can switch this off to spike in consecutive time steps
+    vector<string> gateNames; /*!< \brief Names of variables of the model that are gating variables, i.e. obey dy/dt= alpha_y (1-y) - beta_y y.
+				The gating variables are integrated with the Rush-Larsen scheme wherever the simCode contains $(updateGates). The scheme is exact for constant membrane potential and stays stable for time steps much larger than the forward Euler step. */
+    vector<string> gateAlphaCode; //!< Code for the opening rates alpha_y of the gating variables named in gateNames, matched by their order of occurrence
+    vector<string> gateBetaCode; //!< Code for the closing rates beta_y of the gating variables named in gateNames, matched by their order of occurrence
+    string gateDT; //!< Time step used in $(updateGates); "DT" by default, models integrating in sub-steps give the expression for their sub-step here
+    vector<string> tableNames; /*!< \brief Names of functions of a single variable of the model that are tabulated at generation time, e.g. the rates of gating variables. The code refers to the value of such a function as $(NAME).
+				 The functions are evaluated with the parameter values of each neuron group, stored in a table of the given range and step and interpolated linearly. Parameters used by tabulated functions cannot be runtime parameters. */
+    vector<string> tableCode; //!< Code of the tabulated functions named in tableNames, matched by their order of occurrence; the code may only refer to its variable, parameters, constants and math functions
+    vector<string> tableVars; //!< Names of the variables the tabulated functions depend on
+    vector<double> tableMin; //!< Lower ends of the ranges of the tabulated functions; smaller arguments are clamped
+    vector<double> tableMax; //!< Upper ends of the ranges of the tabulated functions; larger arguments are clamped
+    vector<double> tableStep; //!< Resolutions of the tabulated functions
 
     neuronModel(); //!< \brief Constructor for neuronModel objects
     ~neuronModel(); //!< \brief Destructor for neuronModel objects
+    string gateUpdateCode() const; //!< \brief Returns the code of the Rush-Larsen update of the gating variables that replaces $(updateGates) in the simCode
+    bool needsGennrand() const; //!< \brief Returns whether the simCode or resetCode draws counter-based random numbers with $(gennrand_uniform) or $(gennrand_normal)
 };
 
 
@@ -51,6 +68,10 @@ extern unsigned int TRAUBMILES_PSTEP;//!< variable attaching the name "TRAUBMILE
 extern unsigned int IZHIKEVICH; //!< variable attaching the name "IZHIKEVICH" 
 extern unsigned int IZHIKEVICH_V; //!< variable attaching the name "IZHIKEVICH_V" 
 extern unsigned int SPIKESOURCE; //!< variable attaching the name "SPIKESOURCE"
+extern unsigned int TRAUBMILES_RL; //!< variable attaching the name "TRAUBMILES_RL"
+extern unsigned int POISSONNEURON_PHILOX; //!< variable attaching the name "POISSONNEURON_PHILOX"
+extern unsigned int POISSONNEURON_EVENT; //!< variable attaching the name "POISSONNEURON_EVENT"
+extern unsigned int SPIKESOURCEARRAY; //!< variable attaching the name "SPIKESOURCEARRAY"
 const unsigned int MAXNRN = 7; // maximum number of neuron types: SpineML needs to know this
 
 
@@ -87,6 +108,28 @@ public:
 };
 
 
+//--------------------------------------------------------------------------
+//! \brief Class defining the dependent parameters of the event-driven Poisson neuron.
+//--------------------------------------------------------------------------
+
+class poissonEventdp : public dpclass
+{
+public:
+    double calculateDerivedParameter(int index, vector<double> pars, double dt = 1.0) {
+	switch (index) {
+	case 0:
+	    return refractSteps(pars, dt);
+	}
+	return -1;
+    }
+
+    //! Number of time steps from a spike to the first time step in which the neuron can spike again, which is after the refractory period and after the step in which V is reset
+    double refractSteps(vector<double> pars, double dt) {
+	return max(floor(pars[1]/dt) + 1.0, 2.0);
+    }
+};
+
+
 //--------------------------------------------------------------------------
 /*! \brief Function that defines standard neuron models
 
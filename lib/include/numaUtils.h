@@ -0,0 +1,53 @@
+//--------------------------------------------------------------------------
+/*! \file numaUtils.h
+
+  \brief Functions used by generated CPU code to simulate groups on the NUMA nodes given by their cluster index.
+
+  One thread per NUMA node simulates the groups of that node; the calling thread takes the first node. Every thread is pinned to the CPUs of its node (Linux only), so that the memory first touched by it is local to these CPUs. On Windows the tasks of all nodes are run one after the other by the calling thread.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef NUMAUTILS_H
+#define NUMAUTILS_H
+
+#include <cstddef>
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that pins the calling thread to nodes[0] and starts one pinned worker thread for each of the other NUMA nodes.
+ */
+//--------------------------------------------------------------------------
+
+void numaStartWorkers(const int *nodes, //!< NUMA node IDs
+		      int nodeN //!< Number of NUMA nodes
+    );
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that runs task(k, arg) on the thread of the k-th node for all nodes and waits until all of them are done.
+ */
+//--------------------------------------------------------------------------
+
+void numaRun(void (*task)(int, void *), //!< Task to run; its first argument is the index of the node
+	     void *arg //!< Argument passed on to the task
+    );
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that stops the worker threads.
+ */
+//--------------------------------------------------------------------------
+
+void numaStopWorkers();
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that writes zeros to an array, so that its pages are placed on the NUMA node of the calling thread.
+ */
+//--------------------------------------------------------------------------
+
+void numaTouch(void *array, //!< The array
+	       size_t size //!< Size of the array in bytes
+    );
+
+#endif // NUMAUTILS_H
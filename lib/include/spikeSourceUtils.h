@@ -0,0 +1,102 @@
+//--------------------------------------------------------------------------
+/*! \file spikeSourceUtils.h
+
+  \brief Functions for writing and loading the spike times of SPIKESOURCEARRAY neuron groups.
+
+  A spike source array file holds the spike times of the N neurons of a group in compressed sparse row format: a header of four unsigned ints (GENN_SSA_MAGIC, the size of a spike time in bytes, N and the total number of spikes), the N+1 row starts of the neurons, padded to 8 bytes, and the spike times of all neurons, sorted within each neuron. Files are loaded by mapping them into memory, so that only the pages holding the spikes that are actually reached are read from disk.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef SPIKESOURCEUTILS_H
+#define SPIKESOURCEUTILS_H
+
+#include "utils.h"
+#include "stringUtils.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+#define GENN_SSA_MAGIC 0x41535347 //!< First word of a spike source array file ("GSSA")
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that writes the spike times of the neurons of a group to a spike source array file.
+
+  spikeTimes[n] holds the spike times of neuron n, which are sorted when written. T is the type of the spike times, which needs to be the scalar type of the model that loads the file.
+ */
+//--------------------------------------------------------------------------
+
+template <class T>
+void gennWriteSpikeSourceArray(const string &file, //!< Name of the file
+			       const vector<vector<T> > &spikeTimes //!< Spike times of each neuron
+    )
+{
+    FILE *f= fopen(file.c_str(), "wb");
+    if (f == NULL) {
+	gennError("Could not open spike source array file " + file + " for writing.");
+    }
+    unsigned int N= spikeTimes.size();
+    vector<unsigned int> rowStart(N + 1 + (N + 1) % 2, 0);
+    for (unsigned int n= 0; n < N; n++) {
+	rowStart[n+1]= rowStart[n] + spikeTimes[n].size();
+    }
+    unsigned int header[4]= {GENN_SSA_MAGIC, (unsigned int) sizeof(T), N, rowStart[N]};
+    bool ok= (fwrite(header, sizeof(unsigned int), 4, f) == 4);
+    ok= ok && (fwrite(&rowStart[0], sizeof(unsigned int), rowStart.size(), f) == rowStart.size());
+    for (unsigned int n= 0; ok && (n < N); n++) {
+	vector<T> times(spikeTimes[n]);
+	sort(times.begin(), times.end());
+	if (times.size() > 0) ok= (fwrite(&times[0], sizeof(T), times.size(), f) == times.size());
+    }
+    if ((fclose(f) != 0) || !ok) {
+	gennError("Could not write spike source array file " + file + ".");
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that maps a spike source array file into memory and returns the address of its spike times.
+
+  The cursors startSpike and the ends endSpike of the N neurons are set from the row starts in the file. Files whose row starts decrease or point beyond the spikes in the file are rejected. The mapping is private, i.e. the file is never changed.
+ */
+//--------------------------------------------------------------------------
+
+void *gennMapSpikeSourceArray(const string &file, //!< Name of the file
+			      unsigned int N, //!< Number of neurons of the group
+			      unsigned int timeSize, //!< Size of a spike time of the model in bytes
+			      unsigned int *startSpike, //!< Array of the startSpike variables of the group
+			      unsigned int *endSpike //!< Array of the endSpike variables of the group
+    );
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that maps a spike source array file into memory and sets up the spike-time cursors of a SPIKESOURCEARRAY group.
+
+  The returned spike times are assigned to the extra global parameter spikeTimes of the group. With CPU_ONLY they can be used in place; on the GPU they need to be copied to device memory.
+ */
+//--------------------------------------------------------------------------
+
+template <class T>
+T *gennLoadSpikeSourceArray(const string &file, //!< Name of the file
+			    unsigned int N, //!< Number of neurons of the group
+			    unsigned int *startSpike, //!< Array of the startSpike variables of the group
+			    unsigned int *endSpike //!< Array of the endSpike variables of the group
+    )
+{
+    return (T *) gennMapSpikeSourceArray(file, N, sizeof(T), startSpike, endSpike);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that unmaps the spike times returned by gennLoadSpikeSourceArray(); NULL is ignored.
+ */
+//--------------------------------------------------------------------------
+
+void gennUnmapSpikeSourceArray(void *spikeTimes //!< Spike times returned by gennLoadSpikeSourceArray()
+    );
+
+#endif // SPIKESOURCEUTILS_H
@@ -69,6 +69,14 @@ void extended_value_substitutions(string &code, vector<string> &names, string ex
 void ensureMathFunctionFtype(string &code, string type);
 
 
+//--------------------------------------------------------------------------
+/*! \brief This function replaces the calls of exp, log, tanh and pow by calls of the inline functions of the fast and approximate math precision tiers (see NNmodel::setMathPrecision()).
+ */
+//--------------------------------------------------------------------------
+
+void ensureMathPrecision(string &code, string type, unsigned int mathPrecision);
+
+
 //--------------------------------------------------------------------------
 /*! \brief This function is part of the parser that converts any floating point constant in a code snippet to a floating point constant with an explicit precision (by appending "f" or removing it). 
  */
@@ -78,11 +86,19 @@ void doFinal(string &code, unsigned int i, string type, unsigned int &state);
 
 
 //--------------------------------------------------------------------------
-/*! \brief This function implements a parser that converts any floating point constant in a code snippet to a floating point constant with an explicit precision (by appending "f" or removing it). 
+/*! \brief This function implements a parser that converts any floating point constant in a code snippet to a floating point constant with an explicit precision (by appending "f" or removing it). Math functions are converted to the precision and to the math precision tier of the model.
  */
 //--------------------------------------------------------------------------
 
-string ensureFtype(string oldcode, string type);
+string ensureFtype(string oldcode, string type, unsigned int mathPrecision= GENN_MATH_EXACT);
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function returns a floating point constant of type ftype with all the digits needed to reproduce val.
+ */
+//--------------------------------------------------------------------------
+
+string ftypeConstant(double val, const string &ftype);
 
 
 //--------------------------------------------------------------------------
@@ -93,6 +109,54 @@ string ensureFtype(string oldcode, string type);
 void checkUnreplacedVariables(string code, string codeName);
 
 
+//--------------------------------------------------------------------------
+/*! \brief This function substitutes the parameters and derived parameters of a neuron group in a code snippet, using the names of the global variables for runtime parameters.
+ */
+//--------------------------------------------------------------------------
+
+void neuron_para_substitutions(string &code, NNmodel &model, unsigned int i, string ext= "");
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function replaces the references to the tabulated functions of the model of a neuron group by calls of their lookup functions.
+ */
+//--------------------------------------------------------------------------
+
+void neuron_table_substitutions(string &code, NNmodel &model, unsigned int i);
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function replaces $(gennrand_uniform) and $(gennrand_normal) in the code of a neuron group by draws from the counter-based random number generator.
+ */
+//--------------------------------------------------------------------------
+
+void gennrand_substitutions(string &code, unsigned int i, const string &id);
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function generates the lookup tables of the tabulated functions of the model of a neuron group and the functions that interpolate them.
+ */
+//--------------------------------------------------------------------------
+
+string neuron_tables_code(NNmodel &model, unsigned int i, string qualifier, bool report);
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function substitutes the weight update parameters and derived parameters of a synapse group in a code snippet, using the names of the global variables for runtime parameters.
+ */
+//--------------------------------------------------------------------------
+
+void synapse_para_substitutions(string &code, NNmodel &model, unsigned int i);
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function substitutes the postsynaptic parameters and derived parameters of a synapse group in a code snippet, using the names of the global variables for runtime parameters.
+ */
+//--------------------------------------------------------------------------
+
+void postsynapse_para_substitutions(string &code, NNmodel &model, unsigned int i);
+
+
 //-------------------------------------------------------------------------
 /*!
   \brief Function for performing the code and value substitutions necessary to insert neuron related variables, parameters, and extraGlobal parameters into synaptic code.
@@ -113,4 +177,20 @@ void neuron_substitutions_in_synaptic_code(
     string devPrefix //!< device prefix, "dd_" for GPU, nothing for CPU
 					   );
 
+
+//--------------------------------------------------------------------------
+/*! \brief This function returns the names of the floating point variables, arrays and parameters that the code snippets of a neuron group can refer to after substitution.
+ */
+//--------------------------------------------------------------------------
+
+vector<string> neuronFloatNames(NNmodel &model, unsigned int i, const string &suffix= "", const vector<string> &inSynSuffix= vector<string>());
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function returns the names of the floating point variables, arrays and parameters that the code snippets of a synapse group can refer to after substitution.
+ */
+//--------------------------------------------------------------------------
+
+vector<string> synapseFloatNames(NNmodel &model, unsigned int i);
+
 #endif // STRINGUTILS_H
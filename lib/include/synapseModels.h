@@ -20,7 +20,7 @@ public:
     string simCodeEvnt; //!< \brief Simulation code that is used for spike events (all the instances where event threshold condition is met)
     string simLearnPost; //!< \brief Simulation code which is used in the learnSynapsesPost kernel/function, where postsynaptic neuron spikes before the presynaptic neuron in the STDP window.
     string evntThreshold; //!< \brief Simulation code for spike event detection.
-    string synapseDynamics; //!< \brief Simulation code for synapse dynamics independent of spike detection
+    string synapseDynamics; //!< \brief Simulation code for synapse dynamics independent of spike detection; it may add to the postsynaptic input with $(addtoinSyn) and $(updatelinsyn) for continuous coupling (e.g. graded synapses or gap junctions)
     string simCode_supportCode; //!< \brief Support code is made available within the synapse kernel definition file and is meant to contain user defined device functions that are used in the neuron codes. Preprocessor defines are also allowed if appropriately safeguarded against multiple definition by using ifndef; functions should be declared as "__host__ __device__" to be available for both GPU and CPU versions; note that this support code is available to simCode, evntThreshold and simCodeEvnt
     string simLearnPost_supportCode; //!< \brief Support code is made available within the synapse kernel definition file and is meant to contain user defined device functions that are used in the neuron codes. Preprocessor defines are also allowed if appropriately safeguarded against multiple definition by using ifndef; functions should be declared as "__host__ __device__" to be available for both GPU and CPU versions
     string synapseDynamics_supportCode; //!< \brief Support code is made available within the synapse kernel definition file and is meant to contain user defined device functions that are used in the neuron codes. Preprocessor defines are also allowed if appropriately safeguarded against multiple definition by using ifndef; functions should be declared as "__host__ __device__" to be available for both GPU and CPU versions
@@ -0,0 +1,34 @@
+//--------------------------------------------------------------------------
+/*! \file tuneCPU.h
+
+  \brief Functions for choosing the configuration of the generated CPU code by timing variants of a model. Part of the code generation section.
+
+  This is the CPU counterpart of the block size optimisation in chooseDevice(). The variants differ in whether neuron groups are merged (GENN_PREFERENCES::mergeNeuronGroups), whether code snippets are optimised (GENN_PREFERENCES::optimiseSnippets), whether SPARSE synapse groups with reverse connectivity pull the spikes of strongly active steps into their targets (GENN_PREFERENCES::pullSpikeFraction) and in the instruction set level of the multiversioned CPU functions (GENN_PREFERENCES::maxCPUISA). Each variant is built with buildModelJIT() and simulated for a number of time steps; the fastest configuration is stored in the file cpu_tuning next to the generated code and reused by later builds into the same directory. Not available on Windows.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef TUNECPU_H
+#define TUNECPU_H
+
+#include "modelSpec.h"
+#include "jitModel.h"
+
+#include <string>
+
+using namespace std;
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that chooses the configuration of the CPU code of a finalized model and sets the corresponding GENN_PREFERENCES.
+
+  The setup function is called for every variant after allocateMem(), initialize() and init(). It has to provide everything the simulation needs and the model description does not contain, e.g. sparse connectivity or the rates of Poisson neurons, and should provide typical input, so that the timing reflects the real simulation. Models that need such data are not tuned without a setup function.
+ */
+//--------------------------------------------------------------------------
+
+void tuneCPUCode(NNmodel &model, //!< Model description
+		 string path, //!< Directory in which the code of the model is generated
+		 void (*setup)(JITModel *)= NULL, //!< Function that prepares a loaded variant for simulation
+		 unsigned int steps= 500 //!< Number of time steps for which each variant is timed
+    );
+
+#endif // TUNECPU_H
@@ -22,7 +22,10 @@
 #define _UTILS_H_ //!< macro for avoiding multiple inclusion during compilation
 
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
+#include <stdint.h>
 #ifndef CPU_ONLY
 #include <cuda.h>
 #include <cuda_runtime.h>
@@ -116,4 +119,61 @@ unsigned int theSize(string type);
 void writeHeader(ostream &os);
 
 
+//--------------------------------------------------------------------------
+/*! \brief Function that writes content to a file only if the file does not exist yet or its current content differs. Unchanged files keep their time stamp so that make does not recompile them.
+ */
+//--------------------------------------------------------------------------
+
+void writeFileIfChanged(const string &name, const string &content);
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that extends a 64 bit FNV-1a hash by the characters of a string.
+ */
+//--------------------------------------------------------------------------
+
+uint64_t hashString(const string &s, uint64_t hash= 14695981039346656037ULL);
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that extends a 64 bit FNV-1a hash by the content of a file. Missing files do not change the hash.
+ */
+//--------------------------------------------------------------------------
+
+uint64_t hashFile(const string &name, uint64_t hash= 14695981039346656037ULL);
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that returns the names of the entries (files and subdirectories) of a directory in alphabetical order. The list is empty if the directory does not exist.
+ */
+//--------------------------------------------------------------------------
+
+vector<string> listDirectory(const string &path);
+
+
+//--------------------------------------------------------------------------
+/*! \brief Output stream for generated code files. The code is collected in memory and only written to disk on close() if it differs from what is already in the file.
+ */
+//--------------------------------------------------------------------------
+
+class GeneratedFile : public ostringstream
+{
+public:
+    void open(const char *name)
+    {
+	fileName= name;
+	str("");
+	clear();
+    }
+
+    void close()
+    {
+	writeFileIfChanged(fileName, str());
+    }
+
+private:
+    string fileName;
+};
+
+
 #endif  // _UTILS_H_
@@ -0,0 +1,100 @@
+//--------------------------------------------------------------------------
+/*! \file arenaUtils.cc
+
+  \brief Implementation of the functions used by generated CPU code to allocate the arrays of a model from one block of memory (arena).
+*/
+//--------------------------------------------------------------------------
+
+#ifndef ARENAUTILS_CC
+#define ARENAUTILS_CC
+
+#include "arenaUtils.h"
+#include "utils.h"
+#include "stringUtils.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+namespace {
+    map<char *, size_t> mappedArenas; //!< Arenas in explicit huge pages and the sizes of their mappings
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that allocates an arena.
+
+  With hugePages 1 arenas of at least one huge page are aligned to huge pages and transparent huge pages are requested for them; with hugePages 2 explicit huge pages are used if the system provides enough of them, and transparent huge pages otherwise.
+ */
+//--------------------------------------------------------------------------
+
+char *gennArenaAlloc(size_t size, //!< Size of the arena in bytes
+		     int hugePages //!< Use of huge pages (0: none, 1: transparent, 2: explicit)
+    )
+{
+    void *arena= NULL;
+    size_t align= GENN_ARENA_ALIGN;
+    if (size == 0) size= GENN_ARENA_ALIGN;
+#ifdef __linux__
+    if ((hugePages > 0) && (size >= GENN_HUGE_PAGE_SIZE)) {
+	size= ((size + GENN_HUGE_PAGE_SIZE - 1) / GENN_HUGE_PAGE_SIZE) * GENN_HUGE_PAGE_SIZE;
+	if (hugePages > 1) {
+	    arena= mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	    if (arena != MAP_FAILED) {
+		mappedArenas[(char *) arena]= size;
+		return (char *) arena;
+	    }
+	    cerr << "Warning: there are not enough huge pages for " << size << " bytes of model arrays; transparent huge pages are used instead." << endl;
+	    arena= NULL;
+	}
+	align= GENN_HUGE_PAGE_SIZE;
+    }
+#endif
+#ifdef _WIN32
+    arena= _aligned_malloc(size, align);
+#else
+    if (posix_memalign(&arena, align, size) != 0) arena= NULL;
+#endif
+    if (arena == NULL) {
+	gennError("Could not allocate " + tS(size) + " bytes for the arrays of the model.");
+    }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (align == GENN_HUGE_PAGE_SIZE) madvise(arena, size, MADV_HUGEPAGE);
+#endif
+    return (char *) arena;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that frees an arena allocated by gennArenaAlloc(); NULL is ignored.
+ */
+//--------------------------------------------------------------------------
+
+void gennArenaFree(char *arena //!< The arena
+    )
+{
+    if (arena == NULL) return;
+#ifdef __linux__
+    map<char *, size_t>::iterator mapped= mappedArenas.find(arena);
+    if (mapped != mappedArenas.end()) {
+	munmap(arena, mapped->second);
+	mappedArenas.erase(mapped);
+	return;
+    }
+#endif
+#ifdef _WIN32
+    _aligned_free(arena);
+#else
+    free(arena);
+#endif
+}
+
+#endif // ARENAUTILS_CC
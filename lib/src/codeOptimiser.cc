@@ -0,0 +1,1094 @@
+//--------------------------------------------------------------------------
+/*! \file codeOptimiser.cc
+
+  \brief Small expression-level optimiser that is applied to code snippets after parameter values have been substituted. Part of the code generation section.
+
+  Parameters and derived parameters are pasted into snippets as parenthesised literals, so that snippets contain many constant subexpressions such as "(0.5)/2.0*x". The functions in this file tokenise a snippet and
+  - fold constant floating point subexpressions,
+  - hoist subexpressions and pure math function calls that occur repeatedly within one statement into temporaries,
+  - replace divisions by constants with multiplications (only exact ones, i.e. by powers of two, unless GENN_PREFERENCES::optimizeCode is set).
+  Integer literals are never folded as integer arithmetic has different semantics in C. The optimiser can be switched off with GENN_PREFERENCES::optimiseSnippets.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef CODEOPTIMISER_CC
+#define CODEOPTIMISER_CC
+
+#include "codeOptimiser.h"
+#include "global.h"
+#include "stringUtils.h"
+
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+
+
+namespace {
+
+enum TokenType { TK_SPACE, TK_ID, TK_NUM, TK_STR, TK_PP, TK_OP };
+
+struct Token
+{
+    TokenType type;
+    string text;
+};
+
+//! math functions that are free of side effects and return a floating point value
+const char *pureFunctions[]= {
+    "cos", "sin", "tan", "acos", "asin", "atan", "atan2", "cosh", "sinh", "tanh",
+    "acosh", "asinh", "atanh", "exp", "log", "log10", "exp2", "expm1", "log1p", "log2",
+    "pow", "sqrt", "cbrt", "hypot", "erf", "erfc", "fabs", "fmin", "fmax", "fma",
+    "cosf", "sinf", "tanf", "acosf", "asinf", "atanf", "atan2f", "coshf", "sinhf", "tanhf",
+    "acoshf", "asinhf", "atanhf", "expf", "logf", "log10f", "exp2f", "expm1f", "log1pf", "log2f",
+    "powf", "sqrtf", "cbrtf", "hypotf", "erff", "erfcf", "fabsf", "fminf", "fmaxf", "fmaf",
+    NULL
+};
+
+const char *keywords[]= {
+    "if", "else", "for", "while", "do", "switch", "case", "default", "return", "break",
+    "continue", "goto", "sizeof", "typedef", "struct", "using", "namespace",
+    NULL
+};
+
+const char *multiCharOps[]= {
+    "<<=", ">>=", "->", "++", "--", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||",
+    "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "::",
+    NULL
+};
+
+unsigned int cseCount= 0; //!< counter for unique names of hoisted temporaries
+unsigned int invCount= 0; //!< counter for unique names of temporaries hoisted out of loops
+
+
+bool inList(const char **list, const string &s)
+{
+    for (int i= 0; list[i] != NULL; i++) {
+	if (s == list[i]) return true;
+    }
+    return false;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Split a code snippet into tokens; whitespace and comments are kept as tokens so that the code can be reassembled.
+ */
+//--------------------------------------------------------------------------
+
+vector<Token> tokenise(const string &code)
+{
+    vector<Token> toks;
+    size_t i= 0, n= code.size();
+    while (i < n) {
+	Token t;
+	size_t j= i;
+	char c= code[i];
+	if (isspace(c)) {
+	    while ((j < n) && isspace(code[j])) j++;
+	    t.type= TK_SPACE;
+	}
+	else if ((c == '/') && (i+1 < n) && (code[i+1] == '/')) {
+	    while ((j < n) && (code[j] != '\n')) j++;
+	    t.type= TK_SPACE;
+	}
+	else if ((c == '/') && (i+1 < n) && (code[i+1] == '*')) {
+	    j= code.find("*/", i+2);
+	    j= (j == string::npos) ? n : j+2;
+	    t.type= TK_SPACE;
+	}
+	else if (c == '#') {
+	    while ((j < n) && (code[j] != '\n')) {
+		if ((code[j] == '\\') && (j+1 < n)) j++;
+		j++;
+	    }
+	    t.type= TK_PP;
+	}
+	else if ((c == '"') || (c == '\'')) {
+	    j++;
+	    while ((j < n) && (code[j] != c)) {
+		if (code[j] == '\\') j++;
+		j++;
+	    }
+	    if (j < n) j++;
+	    t.type= TK_STR;
+	}
+	else if (isalpha(c) || (c == '_') || (c == '$')) {
+	    while ((j < n) && (isalnum(code[j]) || (code[j] == '_') || (code[j] == '$'))) j++;
+	    t.type= TK_ID;
+	}
+	else if (isdigit(c) || ((c == '.') && (i+1 < n) && isdigit(code[i+1]))) {
+	    while (j < n) {
+		if (isalnum(code[j]) || (code[j] == '.')) j++;
+		else if (((code[j] == '+') || (code[j] == '-'))
+			 && ((code[j-1] == 'e') || (code[j-1] == 'E'))
+			 && (code[i] != '0' || (i+1 < n && tolower(code[i+1]) != 'x'))) j++;
+		else break;
+	    }
+	    t.type= TK_NUM;
+	}
+	else {
+	    t.type= TK_OP;
+	    j= i+1;
+	    for (int k= 0; multiCharOps[k] != NULL; k++) {
+		if (code.compare(i, strlen(multiCharOps[k]), multiCharOps[k]) == 0) {
+		    j= i+strlen(multiCharOps[k]);
+		    break;
+		}
+	    }
+	}
+	t.text= code.substr(i, j-i);
+	toks.push_back(t);
+	i= j;
+    }
+    return toks;
+}
+
+
+string join(const vector<Token> &toks, size_t from, size_t to, bool withSpace= true)
+{
+    string s;
+    for (size_t i= from; i < to; i++) {
+	if (withSpace || (toks[i].type != TK_SPACE)) s+= toks[i].text;
+    }
+    return s;
+}
+
+
+//! index of the next non-whitespace token at or after i
+size_t nextTok(const vector<Token> &toks, size_t i)
+{
+    while ((i < toks.size()) && (toks[i].type == TK_SPACE)) i++;
+    return i;
+}
+
+
+//! index of the previous non-whitespace token before i (toks.size() if there is none)
+size_t prevTok(const vector<Token> &toks, size_t i)
+{
+    while (i > 0) {
+	i--;
+	if (toks[i].type != TK_SPACE) return i;
+    }
+    return toks.size();
+}
+
+
+bool isOp(const vector<Token> &toks, size_t i, const char *op)
+{
+    return (i < toks.size()) && (toks[i].type == TK_OP) && (toks[i].text == op);
+}
+
+
+bool isAssignOp(const string &s)
+{
+    return (s == "=") || (s == "+=") || (s == "-=") || (s == "*=") || (s == "/=") || (s == "%=")
+	|| (s == "&=") || (s == "|=") || (s == "^=") || (s == "<<=") || (s == ">>=");
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Interpret a numeric token as a floating point constant. Integer, hexadecimal and suffixed integer literals are rejected.
+ */
+//--------------------------------------------------------------------------
+
+bool floatLiteral(const Token &t, double &val)
+{
+    if (t.type != TK_NUM) return false;
+    string s= t.text;
+    if ((s.size() > 1) && (tolower(s[1]) == 'x')) return false;
+    if ((s.find('.') == string::npos) && (s.find('e') == string::npos) && (s.find('E') == string::npos)) return false;
+    if ((s[s.size()-1] == 'f') || (s[s.size()-1] == 'F') || (s[s.size()-1] == 'l') || (s[s.size()-1] == 'L')) {
+	s= s.substr(0, s.size()-1);
+    }
+    char *end;
+    val= strtod(s.c_str(), &end);
+    return (*end == '\0');
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Print a constant with the shortest representation that reproduces the double value; the result always parses as a floating point literal.
+ */
+//--------------------------------------------------------------------------
+
+string formatConstant(double val)
+{
+    char buf[64];
+    for (int prec= 15; prec <= 17; prec++) {
+	snprintf(buf, sizeof(buf), "%.*g", prec, fabs(val));
+	if (strtod(buf, NULL) == fabs(val)) break;
+    }
+    string s(buf);
+    if ((s.find('.') == string::npos) && (s.find('e') == string::npos)) {
+	s+= ".0";
+    }
+    if (val < 0) s= "(-" + s + ")";
+    return s;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Recursive descent evaluation of constant expressions. The parsers stop at the first token that is not part of a constant expression and report how far they got.
+ */
+//--------------------------------------------------------------------------
+
+bool parseAdditive(const vector<Token> &toks, size_t &i, double &val);
+
+bool parseFactor(const vector<Token> &toks, size_t &i, double &val)
+{
+    size_t j= nextTok(toks, i);
+    if (j >= toks.size()) return false;
+    if (isOp(toks, j, "-") || isOp(toks, j, "+")) {
+	size_t k= j+1;
+	if (!parseFactor(toks, k, val)) return false;
+	if (toks[j].text == "-") val= -val;
+	i= k;
+	return true;
+    }
+    if (isOp(toks, j, "(")) {
+	size_t k= j+1;
+	if (!parseAdditive(toks, k, val)) return false;
+	k= nextTok(toks, k);
+	if (!isOp(toks, k, ")")) return false;
+	i= k+1;
+	return true;
+    }
+    if (floatLiteral(toks[j], val)) {
+	i= j+1;
+	return true;
+    }
+    return false;
+}
+
+bool parseTerm(const vector<Token> &toks, size_t &i, double &val)
+{
+    if (!parseFactor(toks, i, val)) return false;
+    while (true) {
+	size_t j= nextTok(toks, i);
+	if (!isOp(toks, j, "*") && !isOp(toks, j, "/")) return true;
+	size_t k= j+1;
+	double rhs;
+	if (!parseFactor(toks, k, rhs)) return true;
+	if (toks[j].text == "*") val*= rhs;
+	else val/= rhs;
+	i= k;
+    }
+}
+
+bool parseAdditive(const vector<Token> &toks, size_t &i, double &val)
+{
+    if (!parseTerm(toks, i, val)) return false;
+    while (true) {
+	size_t j= nextTok(toks, i);
+	// the term so far must not be continued by a non-constant factor
+	if (isOp(toks, j, "*") || isOp(toks, j, "/")) return false;
+	if (!isOp(toks, j, "+") && !isOp(toks, j, "-")) return true;
+	size_t k= j+1;
+	double rhs;
+	if (!parseTerm(toks, k, rhs)) return true;
+	size_t l= nextTok(toks, k);
+	if (isOp(toks, l, "*") || isOp(toks, l, "/")) return true;
+	if (toks[j].text == "+") val+= rhs;
+	else val-= rhs;
+	i= k;
+    }
+}
+
+
+//! tokens after which a new (additive) expression starts
+bool startsExpression(const vector<Token> &toks, size_t p)
+{
+    if (p >= toks.size()) return true;
+    const Token &t= toks[p];
+    if (t.type == TK_ID) return (t.text == "return");
+    if (t.type == TK_PP) return true;
+    if (t.type != TK_OP) return false;
+    const string &s= t.text;
+    return (s == "(") || (s == "[") || (s == ",") || (s == ";") || (s == "{") || (s == "}")
+	|| (s == "?") || (s == ":") || (s == "==") || (s == "!=") || (s == "<") || (s == ">")
+	|| (s == "<=") || (s == ">=") || (s == "&&") || (s == "||") || isAssignOp(s);
+}
+
+
+//! binary + or - at position p, i.e. a sign that follows an operand
+bool binarySign(const vector<Token> &toks, size_t p)
+{
+    if (!isOp(toks, p, "+") && !isOp(toks, p, "-")) return false;
+    size_t q= prevTok(toks, p);
+    if (q >= toks.size()) return false;
+    if (toks[q].type == TK_NUM) return true;
+    if (toks[q].type == TK_ID) return (toks[q].text != "return");
+    return isOp(toks, q, ")") || isOp(toks, q, "]");
+}
+
+
+//! tokens that may legally follow a complete expression
+bool endsExpression(const vector<Token> &toks, size_t p)
+{
+    if (p >= toks.size()) return true;
+    const Token &t= toks[p];
+    if (t.type != TK_OP) return false;
+    const string &s= t.text;
+    return (s == ")") || (s == "]") || (s == ",") || (s == ";") || (s == "}") || (s == "?")
+	|| (s == ":") || (s == "==") || (s == "!=") || (s == "<") || (s == ">") || (s == "<=")
+	|| (s == ">=") || (s == "&&") || (s == "||") || (s == "+") || (s == "-");
+}
+
+
+//! replace tokens [from, to) by a single token
+void replaceTokens(vector<Token> &toks, size_t from, size_t to, TokenType type, const string &text)
+{
+    Token t;
+    t.type= type;
+    t.text= text;
+    toks.erase(toks.begin()+from, toks.begin()+to);
+    toks.insert(toks.begin()+from, t);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Constant folding. For every position where an expression starts, the longest constant additive expression (or, failing that, the longest leading constant product) is evaluated and replaced by its value.
+ */
+//--------------------------------------------------------------------------
+
+bool foldConstants(vector<Token> &toks)
+{
+    bool changed= false;
+    for (size_t s= 0; s < toks.size(); s++) {
+	if (toks[s].type == TK_SPACE) continue;
+	size_t p= prevTok(toks, s);
+	bool exprStart= startsExpression(toks, p);
+	// a unary sign only starts a term if it starts an expression itself; after * or / (as in
+	// "y / -2.0 * 3.0") the factors that follow it belong to the product on its left
+	bool termStart= exprStart || binarySign(toks, p)
+	    || ((isOp(toks, p, "+") || isOp(toks, p, "-")) && startsExpression(toks, prevTok(toks, p)));
+	if (!termStart) continue;
+	if (isOp(toks, s, "+") || isOp(toks, s, "-")) {
+	    // leave unary signs in front of non-constants alone
+	    if (!exprStart) continue;
+	}
+
+	double val;
+	size_t e= s;
+	bool found= false;
+	if (exprStart) {
+	    size_t k= s;
+	    if (parseAdditive(toks, k, val) && endsExpression(toks, nextTok(toks, k))) {
+		e= k;
+		found= true;
+	    }
+	}
+	if (!found) {
+	    // leading constant factors of a product: c1*c2*x == (c1*c2)*x
+	    size_t k= s;
+	    if (parseTerm(toks, k, val)) {
+		size_t n= nextTok(toks, k);
+		if (isOp(toks, n, "*") || isOp(toks, n, "/") || endsExpression(toks, n)) {
+		    e= k;
+		    found= true;
+		}
+	    }
+	}
+	if (!found) continue;
+
+	// only replace if there was something to evaluate
+	int count= 0;
+	for (size_t k= s; k < e; k++) {
+	    if (toks[k].type == TK_NUM) count++;
+	}
+	if (count < 2) continue;
+	if (!std::isfinite(val)) continue;
+	replaceTokens(toks, s, e, TK_NUM, formatConstant(val));
+	changed= true;
+    }
+    return changed;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Replace divisions by floating point constants with multiplications by the reciprocal. This is exact for powers of two; other constants are only treated if GENN_PREFERENCES::optimizeCode allows trading accuracy for speed.
+ */
+//--------------------------------------------------------------------------
+
+void reduceDivisions(vector<Token> &toks)
+{
+    for (size_t i= 0; i < toks.size(); i++) {
+	if (!isOp(toks, i, "/") && !isOp(toks, i, "/=")) continue;
+	size_t j= nextTok(toks, i+1);
+	size_t last= j;
+	double val;
+	if (isOp(toks, j, "(")) {
+	    size_t k= nextTok(toks, j+1);
+	    if ((k >= toks.size()) || !floatLiteral(toks[k], val)) continue;
+	    last= nextTok(toks, k+1);
+	    if (!isOp(toks, last, ")")) continue;
+	}
+	else if ((j >= toks.size()) || !floatLiteral(toks[j], val)) continue;
+	if (toks[i].text == "/=") {
+	    // x /= c is only equivalent if c is the entire right-hand side
+	    size_t n= nextTok(toks, last+1);
+	    if (!isOp(toks, n, ";")) continue;
+	}
+	if ((val == 0.0) || !std::isfinite(val)) continue;
+	int ex;
+	bool exact= (fabs(frexp(val, &ex)) == 0.5);
+	if (!exact && !GENN_PREFERENCES::optimizeCode) continue;
+	double rec= 1.0/val;
+	if (!std::isfinite(rec) || (rec == 0.0)) continue;
+	toks[i].text= (toks[i].text == "/") ? "*" : "*=";
+	replaceTokens(toks, j, last+1, TK_NUM, formatConstant(rec));
+    }
+}
+
+
+//! index of the bracket matching the opening bracket at position i
+size_t matchBracket(const vector<Token> &toks, size_t i, size_t end)
+{
+    int depth= 0;
+    for (size_t k= i; k < end; k++) {
+	if (isOp(toks, k, "(")) depth++;
+	if (isOp(toks, k, ")")) {
+	    depth--;
+	    if (depth == 0) return k;
+	}
+    }
+    return end;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Check whether a simple assignment statement [s, e) qualifies for hoisting of common subexpressions and return the position of its assignment operator.
+ */
+//--------------------------------------------------------------------------
+
+bool simpleAssignment(const vector<Token> &toks, size_t s, size_t e, size_t &assign)
+{
+    if ((toks[s].type != TK_ID) || inList(keywords, toks[s].text)) return false;
+    int nAssign= 0, depth= 0;
+    for (size_t k= s; k < e; k++) {
+	const Token &t= toks[k];
+	if (t.type == TK_STR || t.type == TK_PP) return false;
+	if (t.type == TK_ID) {
+	    size_t n= nextTok(toks, k+1);
+	    if (isOp(toks, n, "(") && !inList(pureFunctions, t.text)) return false; // unknown calls may have side effects
+	    if (inList(keywords, t.text)) return false;
+	}
+	if (t.type != TK_OP) continue;
+	if ((t.text == "(") || (t.text == "[")) depth++;
+	if ((t.text == ")") || (t.text == "]")) depth--;
+	if ((t.text == "++") || (t.text == "--") || (t.text == "?") || (t.text == "&&") || (t.text == "||")) return false;
+	if ((t.text == ",") && (depth == 0)) return false;
+	if (isAssignOp(t.text)) {
+	    if ((depth != 0) || (++nAssign > 1)) return false;
+	    assign= k;
+	}
+    }
+    return (nAssign == 1);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Check whether the expression [from, to) is of floating point type and worth a temporary: outside array indices it may only contain floating point literals, the identifiers in floatNames, pure math function calls and arithmetic operators, and it needs to contain an array element, a function call or an operation. Expressions of literals only, such as the bracketed parameter values "(-1.2e-05)", are left to the compiler.
+ */
+//--------------------------------------------------------------------------
+
+bool floatExpression(const vector<Token> &toks, size_t from, size_t to, const vector<string> &floatNames)
+{
+    bool worth= false, constant= true;
+    int index= 0;
+    for (size_t l= from; l < to; l++) {
+	const Token &t= toks[l];
+	double v;
+	if (isOp(toks, l, "[")) {
+	    index++;
+	    worth= true;
+	    constant= false;
+	}
+	if (isOp(toks, l, "]")) index--;
+	if ((index > 0) || isOp(toks, l, "]") || (t.type == TK_SPACE)) continue;
+	if ((t.type == TK_NUM) && !floatLiteral(t, v)) return false;
+	if (t.type == TK_ID) {
+	    if (inList(pureFunctions, t.text)) worth= true;
+	    else if (find(floatNames.begin(), floatNames.end(), t.text) == floatNames.end()) return false;
+	    constant= false;
+	}
+	if (t.type == TK_OP) {
+	    if ((t.text == "+") || (t.text == "-") || (t.text == "*") || (t.text == "/")) worth= true;
+	    else if ((t.text != "(") && (t.text != ")") && (t.text != ",")) return false;
+	}
+    }
+    return worth && !constant;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Hoist the largest subexpression that occurs more than once on the right-hand side of the statement [s, e) into a temporary. Only floating point expressions in the sense of floatExpression() are hoisted, so that the temporary of type ftype does not change their precision. Returns true if something was hoisted.
+ */
+//--------------------------------------------------------------------------
+
+bool hoistRepeated(vector<Token> &toks, size_t s, size_t e, size_t assign, const string &ftype, const vector<string> &floatNames, size_t &inserted)
+{
+    vector<size_t> from, to;
+    vector<string> keys;
+    for (size_t k= assign+1; k < e; k++) {
+	if (!isOp(toks, k, "(")) continue;
+	size_t q= matchBracket(toks, k, e);
+	if (q >= e) return false;
+	size_t p= prevTok(toks, k);
+	size_t a= k;
+	if ((p < toks.size()) && (toks[p].type == TK_ID)) {
+	    if (!inList(pureFunctions, toks[p].text)) continue;
+	    a= p; // the whole function call
+	}
+	// needs to be floating point valued, free of side effects and more than a single token in brackets
+	bool hasOp= (a != k), hasSideEffect= false;
+	int index= 0;
+	for (size_t l= k+1; l < q; l++) {
+	    if (isOp(toks, l, "++") || isOp(toks, l, "--") || ((toks[l].type == TK_OP) && isAssignOp(toks[l].text))) hasSideEffect= true;
+	    if (isOp(toks, l, "[")) index++;
+	    if (isOp(toks, l, "]")) index--;
+	    if (index > 0) continue; // array indices are integers
+	    if ((toks[l].type == TK_OP) && (toks[l].text != "(") && (toks[l].text != ")")) hasOp= true;
+	}
+	if (!hasOp || hasSideEffect || !floatExpression(toks, a, q+1, floatNames)) continue;
+	from.push_back(a);
+	to.push_back(q+1);
+	keys.push_back(join(toks, a, q+1, false));
+    }
+
+    // find the longest candidate that occurs more than once; bracketed
+    // groups with identical text are always disjoint
+    int best= -1;
+    for (size_t c= 0; c < keys.size(); c++) {
+	int n= 0;
+	for (size_t d= 0; d < keys.size(); d++) {
+	    if (keys[d] == keys[c]) n++;
+	}
+	if ((n > 1) && ((best < 0) || (keys[c].size() > keys[best].size()))) best= c;
+    }
+    if (best < 0) return false;
+
+    string name= "_cse" + tS(cseCount++);
+    string key= keys[best];
+    string text= join(toks, from[best], to[best], true);
+    for (size_t c= keys.size(); c-- > 0;) {
+	if (keys[c] == key) replaceTokens(toks, from[c], to[c], TK_ID, name);
+    }
+
+    // declare the temporary in front of the statement with the same indentation
+    string indent= " ";
+    size_t p= (s > 0) ? s-1 : toks.size();
+    if ((p < toks.size()) && (toks[p].type == TK_SPACE)) {
+	size_t nl= toks[p].text.rfind('\n');
+	if (nl != string::npos) indent= toks[p].text.substr(nl);
+    }
+    vector<Token> decl= tokenise("const " + ftype + " " + name + "= " + text + ";" + indent);
+    toks.insert(toks.begin()+s, decl.begin(), decl.end());
+    inserted= decl.size();
+    return true;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Walk through the statements of a snippet and apply hoistRepeated() to every simple assignment statement.
+ */
+//--------------------------------------------------------------------------
+
+void hoistStatements(vector<Token> &toks, const string &ftype, const vector<string> &floatNames)
+{
+    size_t s= nextTok(toks, 0);
+    while (s < toks.size()) {
+	// find the end of the statement at bracket depth zero
+	int depth= 0;
+	size_t e= s;
+	for (; e < toks.size(); e++) {
+	    if (toks[e].type == TK_PP) break;
+	    if (toks[e].type != TK_OP) continue;
+	    const string &t= toks[e].text;
+	    if ((t == "(") || (t == "[")) depth++;
+	    if ((t == ")") || (t == "]")) depth--;
+	    if ((depth == 0) && ((t == ";") || (t == "{") || (t == "}"))) break;
+	}
+	size_t assign;
+	if ((e < toks.size()) && isOp(toks, e, ";") && simpleAssignment(toks, s, e, assign)) {
+	    int guard= 0;
+	    size_t inserted;
+	    while ((guard++ < 16) && hoistRepeated(toks, s, e, assign, ftype, floatNames, inserted)) {
+		// the statement moved behind the declaration and shrank; find its end again
+		s+= inserted;
+		e= s;
+		while (!isOp(toks, e, ";")) e++;
+		simpleAssignment(toks, s, e, assign);
+	    }
+	}
+	s= nextTok(toks, e+1);
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Evaluation of complete constant expressions with the C operators of expressions, including comparisons and conditionals, and calls of pure math functions. Unlike the parsers used for folding, evaluation fails for any expression that refers to a variable.
+ */
+//--------------------------------------------------------------------------
+
+struct Evaluator
+{
+    vector<Token> toks;
+    size_t i;
+
+    bool peek(const char *op) { i= nextTok(toks, i); return isOp(toks, i, op); }
+    bool accept(const char *op) { if (!peek(op)) return false; i++; return true; }
+
+    bool conditional(double &val);
+    bool binary(int level, double &val);
+    bool unary(double &val);
+    bool call(const string &f, double &val);
+};
+
+//! binary operators by decreasing level of precedence
+const char *binaryOps[][5]= {
+    { "*", "/", NULL },
+    { "+", "-", NULL },
+    { "<", ">", "<=", ">=", NULL },
+    { "==", "!=", NULL },
+    { "&&", NULL },
+    { "||", NULL }
+};
+
+bool Evaluator::conditional(double &val)
+{
+    if (!binary(5, val)) return false;
+    if (!accept("?")) return true;
+    double a, b;
+    if (!conditional(a) || !accept(":") || !conditional(b)) return false;
+    val= (val != 0.0) ? a : b;
+    return true;
+}
+
+bool Evaluator::binary(int level, double &val)
+{
+    if (!((level == 0) ? unary(val) : binary(level-1, val))) return false;
+    while (true) {
+	int k;
+	for (k= 0; binaryOps[level][k] != NULL; k++) {
+	    if (peek(binaryOps[level][k])) break;
+	}
+	if (binaryOps[level][k] == NULL) return true;
+	string op= binaryOps[level][k];
+	i++;
+	double rhs;
+	if (!((level == 0) ? unary(rhs) : binary(level-1, rhs))) return false;
+	if (op == "*") val*= rhs;
+	else if (op == "/") val/= rhs;
+	else if (op == "+") val+= rhs;
+	else if (op == "-") val-= rhs;
+	else if (op == "<") val= (val < rhs);
+	else if (op == ">") val= (val > rhs);
+	else if (op == "<=") val= (val <= rhs);
+	else if (op == ">=") val= (val >= rhs);
+	else if (op == "==") val= (val == rhs);
+	else if (op == "!=") val= (val != rhs);
+	else if (op == "&&") val= ((val != 0.0) && (rhs != 0.0));
+	else val= ((val != 0.0) || (rhs != 0.0));
+    }
+}
+
+bool Evaluator::unary(double &val)
+{
+    if (accept("-")) {
+	if (!unary(val)) return false;
+	val= -val;
+	return true;
+    }
+    if (accept("+")) return unary(val);
+    if (accept("!")) {
+	if (!unary(val)) return false;
+	val= (val == 0.0);
+	return true;
+    }
+    if (accept("(")) {
+	return conditional(val) && accept(")");
+    }
+    i= nextTok(toks, i);
+    if (i >= toks.size()) return false;
+    const Token &t= toks[i];
+    if (t.type == TK_NUM) {
+	string s= t.text;
+	while ((s.size() > 1) && (strchr("fFlLuU", s[s.size()-1]) != NULL) && !((s.size() > 2) && (tolower(s[1]) == 'x'))) {
+	    s= s.substr(0, s.size()-1);
+	}
+	char *end;
+	val= strtod(s.c_str(), &end);
+	i++;
+	return (*end == '\0');
+    }
+    if ((t.type == TK_ID) && inList(pureFunctions, t.text)) {
+	string f= t.text;
+	i++;
+	return call(f, val);
+    }
+    return false;
+}
+
+bool Evaluator::call(const string &f, double &val)
+{
+    vector<double> args;
+    if (!accept("(")) return false;
+    if (!accept(")")) {
+	do {
+	    double a;
+	    if (!conditional(a)) return false;
+	    args.push_back(a);
+	} while (accept(","));
+	if (!accept(")")) return false;
+    }
+    string g= f;
+    if ((g.size() > 3) && (g[g.size()-1] == 'f') && (g != "erf")) g= g.substr(0, g.size()-1);
+    if (args.size() == 1) {
+	double x= args[0];
+	if (g == "cos") val= cos(x);
+	else if (g == "sin") val= sin(x);
+	else if (g == "tan") val= tan(x);
+	else if (g == "acos") val= acos(x);
+	else if (g == "asin") val= asin(x);
+	else if (g == "atan") val= atan(x);
+	else if (g == "cosh") val= cosh(x);
+	else if (g == "sinh") val= sinh(x);
+	else if (g == "tanh") val= tanh(x);
+	else if (g == "acosh") val= acosh(x);
+	else if (g == "asinh") val= asinh(x);
+	else if (g == "atanh") val= atanh(x);
+	else if (g == "exp") val= exp(x);
+	else if (g == "log") val= log(x);
+	else if (g == "log10") val= log10(x);
+	else if (g == "exp2") val= exp2(x);
+	else if (g == "expm1") val= expm1(x);
+	else if (g == "log1p") val= log1p(x);
+	else if (g == "log2") val= log2(x);
+	else if (g == "sqrt") val= sqrt(x);
+	else if (g == "cbrt") val= cbrt(x);
+	else if (g == "erf") val= erf(x);
+	else if (g == "erfc") val= erfc(x);
+	else if (g == "fabs") val= fabs(x);
+	else return false;
+	return true;
+    }
+    if (args.size() == 2) {
+	double x= args[0], y= args[1];
+	if (g == "pow") val= pow(x, y);
+	else if (g == "atan2") val= atan2(x, y);
+	else if (g == "hypot") val= hypot(x, y);
+	else if (g == "fmin") val= fmin(x, y);
+	else if (g == "fmax") val= fmax(x, y);
+	else return false;
+	return true;
+    }
+    if ((args.size() == 3) && (g == "fma")) {
+	val= fma(args[0], args[1], args[2]);
+	return true;
+    }
+    return false;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Collect the identifiers that a snippet assigns to, directly, through array elements, with increments or in declarations.
+ */
+//--------------------------------------------------------------------------
+
+void assignedNames(const vector<Token> &toks, vector<string> &names)
+{
+    for (size_t k= 0; k < toks.size(); k++) {
+	if (toks[k].type != TK_OP) continue;
+	bool incr= (toks[k].text == "++") || (toks[k].text == "--");
+	if (!incr && !isAssignOp(toks[k].text)) continue;
+	size_t p= prevTok(toks, k);
+	while (isOp(toks, p, "]")) { // skip the indices of an array element
+	    int depth= 0;
+	    for (; p < toks.size(); p= prevTok(toks, p)) {
+		if (isOp(toks, p, "]")) depth++;
+		if (isOp(toks, p, "[") && (--depth == 0)) break;
+	    }
+	    if (p < toks.size()) p= prevTok(toks, p);
+	}
+	if ((p < toks.size()) && (toks[p].type == TK_ID)) names.push_back(toks[p].text);
+	size_t n= nextTok(toks, k+1);
+	if (incr && (n < toks.size()) && (toks[n].type == TK_ID)) names.push_back(toks[n].text);
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Check whether the tokens [from, to) are free of side effects, of calls of functions other than pure math functions and of the identifiers in variant.
+ */
+//--------------------------------------------------------------------------
+
+bool invariantTokens(const vector<Token> &toks, size_t from, size_t to, const vector<string> &variant)
+{
+    for (size_t l= from; l < to; l++) {
+	const Token &t= toks[l];
+	if ((t.type == TK_STR) || (t.type == TK_PP)) return false;
+	if (t.type == TK_OP) {
+	    if ((t.text == "++") || (t.text == "--") || isAssignOp(t.text)
+		|| (t.text == ";") || (t.text == "{") || (t.text == "}")) return false;
+	}
+	if (t.type != TK_ID) continue;
+	if (inList(keywords, t.text)) return false;
+	if (find(variant.begin(), variant.end(), t.text) != variant.end()) return false;
+	if (isOp(toks, nextTok(toks, l+1), "(") && !inList(pureFunctions, t.text)) return false;
+    }
+    return true;
+}
+
+
+string optimise(string code, bool statements, const string &ftype, const vector<string> &floatNames)
+{
+    if (!GENN_PREFERENCES::optimiseSnippets) return code;
+    vector<Token> toks= tokenise(code);
+    int guard= 0;
+    while ((guard++ < 8) && foldConstants(toks));
+    if (statements) hoistStatements(toks, ftype, floatNames);
+    reduceDivisions(toks);
+    return join(toks, 0, toks.size());
+}
+
+//! check whether the expression [from, to) is a product of name and of factors that do not refer to name
+bool linearProduct(const vector<Token> &toks, size_t from, size_t to, const string &name)
+{
+    int found= 0, depth= 0;
+    bool divisor= false, factor= true;
+    for (size_t l= nextTok(toks, from); l < to; l= nextTok(toks, l+1)) {
+	const Token &t= toks[l];
+	if (isOp(toks, l, "(") || isOp(toks, l, "[")) depth++;
+	else if (isOp(toks, l, ")") || isOp(toks, l, "]")) depth--;
+	else if ((depth == 0) && (t.type == TK_OP)) {
+	    if ((t.text != "*") && (t.text != "/")) return false;
+	    divisor= (t.text == "/");
+	    factor= true;
+	    continue;
+	}
+	else if ((t.type == TK_ID) && (t.text == name)) {
+	    // name has to be a factor of its own
+	    size_t n= nextTok(toks, l+1);
+	    if ((depth > 0) || divisor || !factor || ((n < to) && !isOp(toks, n, "*") && !isOp(toks, n, "/"))) return false;
+	    found++;
+	}
+	factor= false;
+    }
+    return (found == 1);
+}
+
+} // end of anonymous namespace
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function folds constant subexpressions and strength-reduces divisions by constants in a code snippet that is a single expression (e.g. a threshold condition).
+ */
+//--------------------------------------------------------------------------
+
+string optimiseExpression(string code)
+{
+    return optimise(code, false, "", vector<string>());
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function folds constant subexpressions, hoists subexpressions and pure math function calls that are repeated within a statement into temporaries of type ftype, and strength-reduces divisions by constants in a code snippet made of statements (e.g. a simCode). Only subexpressions made of the identifiers and arrays in floatNames, floating point literals and pure math functions are hoisted.
+ */
+//--------------------------------------------------------------------------
+
+string optimiseStatements(string code, string ftype, const vector<string> &floatNames)
+{
+    return optimise(code, true, ftype, floatNames);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function moves the floating point subexpressions of a code snippet in the body of a loop that do not change within the loop into temporaries of type ftype, whose declarations are returned in hoisted for emission in front of the loop.
+
+  Subexpressions are loop-invariant if they refer neither to the identifiers in variant (e.g. the loop index) nor to anything the snippet assigns to, and call only pure math functions. To be sure of their type, they may only combine the identifiers and arrays in floatNames, floating point literals and pure math functions. The largest such subexpressions (bracketed groups, function calls and array elements) are hoisted; identical ones share a temporary.
+ */
+//--------------------------------------------------------------------------
+
+string hoistLoopInvariant(string code, const vector<string> &variant, const vector<string> &floatNames, string ftype, string &hoisted)
+{
+    hoisted= "";
+    if (!GENN_PREFERENCES::optimiseSnippets) return code;
+    vector<Token> toks= tokenise(code);
+    vector<string> changing(variant);
+    assignedNames(toks, changing);
+    vector<string> texts, names;
+    for (size_t k= 0; k < toks.size(); k++) {
+	size_t a= k, q;
+	if (isOp(toks, k, "(")) {
+	    q= matchBracket(toks, k, toks.size());
+	    size_t p= prevTok(toks, k);
+	    if ((p < toks.size()) && (toks[p].type == TK_ID)) {
+		if (!inList(pureFunctions, toks[p].text)) continue; // look inside other calls and statements
+		a= p;
+	    }
+	}
+	else if ((toks[k].type == TK_ID) && isOp(toks, nextTok(toks, k+1), "[")) {
+	    size_t p= prevTok(toks, k);
+	    if (isOp(toks, p, ".") || isOp(toks, p, "->") || isOp(toks, p, "&")) continue;
+	    q= nextTok(toks, k+1);
+	    int depth= 0;
+	    for (; q < toks.size(); q++) {
+		if (isOp(toks, q, "[")) depth++;
+		if (isOp(toks, q, "]") && (--depth == 0)) {
+		    size_t n= nextTok(toks, q+1);
+		    if (!isOp(toks, n, "[")) break; // further dimensions belong to the element
+		    q= n-1;
+		}
+	    }
+	}
+	else continue;
+	if (q >= toks.size()) return code;
+	if (!floatExpression(toks, a, q+1, floatNames) || !invariantTokens(toks, a, q+1, changing)) continue;
+	string text= join(toks, a, q+1, true);
+	string key= join(toks, a, q+1, false);
+	vector<string>::iterator it= find(texts.begin(), texts.end(), key);
+	string name;
+	if (it == texts.end()) {
+	    name= "_inv" + tS(invCount++);
+	    texts.push_back(key);
+	    names.push_back(name);
+	    hoisted+= "const " + ftype + " " + name + "= " + text + ";\n";
+	}
+	else name= names[it - texts.begin()];
+	replaceTokens(toks, a, q+1, TK_ID, name);
+	k= a;
+    }
+    return join(toks, 0, toks.size());
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function checks whether a code snippet (e.g. a condition) in the body of a loop does not change within the loop, i.e. it refers to none of the identifiers in variant, has no side effects and calls only pure math functions.
+ */
+//--------------------------------------------------------------------------
+
+bool isLoopInvariant(string code, const vector<string> &variant)
+{
+    vector<Token> toks= tokenise(code);
+    return invariantTokens(toks, 0, toks.size(), variant);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function checks whether the only effect of a code snippet is to add a value to target (e.g. the postsynaptic input of a synapse) in its last statement. It returns the preceding statements in body and the added value in value.
+
+  The preceding statements may only assign side-effect free expressions to variables they declare or to the variables in locals (e.g. addtoinSyn); no statement may refer to target otherwise. Snippets with control flow, function calls other than pure math functions or any other assignment are rejected.
+ */
+//--------------------------------------------------------------------------
+
+bool splitAccumulation(string code, string target, const vector<string> &locals, string &body, string &value)
+{
+    vector<Token> toks= tokenise(code);
+    vector<Token> tt= tokenise(target);
+    string targetKey= join(tt, 0, tt.size(), false);
+    size_t tb= nextTok(tt, 0);
+    if (tb >= tt.size()) return false;
+    vector<string> base(1, tt[tb].text); // the array of the target must not be used otherwise
+    vector<string> declared(locals);
+    body= "";
+    value= "";
+    bool added= false;
+    size_t s= 0;
+    while (nextTok(toks, s) < toks.size()) {
+	if (added) return false; // the addition has to be the last statement
+	size_t e= s;
+	while ((e < toks.size()) && !isOp(toks, e, ";")) e++;
+	if (e >= toks.size()) return false;
+	size_t assign= s;
+	while ((assign < e) && !((toks[assign].type == TK_OP) && isAssignOp(toks[assign].text))) assign++;
+	if (assign >= e) return false;
+	size_t from= nextTok(toks, assign+1);
+	if (!invariantTokens(toks, from, e, base)) return false;
+	if (join(toks, s, assign, false) == targetKey) {
+	    if (toks[assign].text != "+=") return false;
+	    value= join(toks, from, e, true);
+	    added= true;
+	}
+	else {
+	    if (toks[assign].text != "=") return false;
+	    size_t name= prevTok(toks, assign);
+	    if ((name >= toks.size()) || (name < s) || (toks[name].type != TK_ID)) return false;
+	    bool declaration= false;
+	    for (size_t l= nextTok(toks, s); l < name; l= nextTok(toks, l+1)) {
+		if ((toks[l].type != TK_ID) || inList(keywords, toks[l].text)) return false;
+		declaration= true; // type of a declaration
+	    }
+	    if (declaration) declared.push_back(toks[name].text);
+	    else if (find(declared.begin(), declared.end(), toks[name].text) == declared.end()) return false;
+	    body+= join(toks, nextTok(toks, s), e+1, true) + "\n";
+	}
+	s= e+1;
+    }
+    return added;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function checks whether a code snippet is linear and homogeneous in the variable name, so that applying it to a sum of values is the same as applying it to each of them and adding the results.
+
+  The snippet may be model code, in which $(name) is read as name. Each statement of the snippet has to be a product of name and factors that do not refer to name, or an assignment to name of such a product or of 0, or a multiplication or division of name by factors that do not refer to it (e.g. the postSyntoCurrent and postSynDecay codes of EXPDECAY and IZHIKEVICH_PS with name inSyn).
+ */
+//--------------------------------------------------------------------------
+
+bool isLinearIn(string code, string name)
+{
+    // the $(...) keywords of model code are read as plain names
+    for (size_t p= code.find("$("); p != string::npos; p= code.find("$(", p)) {
+	size_t q= code.find(')', p);
+	if (q == string::npos) return false;
+	code= code.substr(0, p) + code.substr(p+2, q-p-2) + code.substr(q+1);
+    }
+    vector<Token> toks= tokenise(code);
+    vector<string> variant(1, name);
+    size_t s= 0;
+    while (nextTok(toks, s) < toks.size()) {
+	size_t e= s;
+	while ((e < toks.size()) && !isOp(toks, e, ";")) e++;
+	size_t assign= s;
+	while ((assign < e) && !((toks[assign].type == TK_OP) && isAssignOp(toks[assign].text))) assign++;
+	if (assign >= e) {
+	    if ((nextTok(toks, s) < e) && !linearProduct(toks, s, e, name)) return false;
+	}
+	else {
+	    size_t target= nextTok(toks, s);
+	    size_t from= nextTok(toks, assign+1);
+	    if ((toks[target].text != name) || (nextTok(toks, target+1) != assign)) return false;
+	    if ((toks[assign].text == "*=") || (toks[assign].text == "/=")) {
+		if (!invariantTokens(toks, from, e, variant)) return false;
+	    }
+	    else if (toks[assign].text == "=") {
+		bool zero= (from < e) && (toks[from].type == TK_NUM) && (strtod(toks[from].text.c_str(), NULL) == 0.0) && (nextTok(toks, from+1) >= e);
+		if (!zero && !linearProduct(toks, from, e, name)) return false;
+	    }
+	    else return false;
+	}
+	s= (e < toks.size()) ? e+1 : e;
+    }
+    return true;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function evaluates a code snippet that is a constant expression at generation time. It returns false if the snippet refers to anything but constants and pure math functions.
+ */
+//--------------------------------------------------------------------------
+
+bool evaluateExpression(string code, double &val)
+{
+    Evaluator e;
+    e.toks= tokenise(code);
+    e.i= 0;
+    if (!e.conditional(val)) return false;
+    return (nextTok(e.toks, e.i) == e.toks.size());
+}
+
+#endif // CODEOPTIMISER_CC
@@ -23,324 +23,1277 @@
 #include "global.h"
 #include "utils.h"
 #include "stringUtils.h"
+#include "codeOptimiser.h"
 #include "CodeHelper.h"
 
 #include <algorithm>
 
+const unsigned int poissonWheelSize= 1024; //!< Number of buckets of the timing wheels of event-driven Poisson neurons
+
 
 //--------------------------------------------------------------------------
 /*!
-  \brief Function that generates the code of the function the will simulate all neurons on the CPU.
+  \brief Function that writes the beginning of a separately compiled CPU code file: the header, a doxygen comment and the includes.
 */
 //--------------------------------------------------------------------------
 
-void genNeuronFunction(NNmodel &model, //!< Model description 
-		       string &path //!< Path for code generation
+static void genCPUFileHeader(ostream &os, //!< output stream for code
+			     NNmodel &model, //!< Model description
+			     string fileName, //!< Name of the generated file
+			     string brief //!< Description of the file content
     )
 {
-    string name, s, localID;
-    unsigned int nt;
-    ofstream os;
-
-    name = path + toString("/") + model.name + toString("_CODE/neuronFnct.cc");
-    os.open(name.c_str());
-
-    // write header content
     writeHeader(os);
     os << ENDL;
 
-    // compiler/include control (include once)
-    os << "#ifndef _" << model.name << "_neuronFnct_cc" << ENDL;
-    os << "#define _" << model.name << "_neuronFnct_cc" << ENDL;
-    os << ENDL;
-
     // write doxygen comment
     os << "//-------------------------------------------------------------------------" << ENDL;
-    os << "/*! \\file neuronFnct.cc" << ENDL << ENDL;
-    os << "\\brief File generated from GeNN for the model " << model.name;
-    os << " containing the the equivalent of neuron kernel function for the CPU-only version." << ENDL;
+    os << "/*! \\file " << fileName << ENDL << ENDL;
+    os << "\\brief File generated from GeNN for the model " << model.name << " " << brief << ENDL;
     os << "*/" << ENDL;
     os << "//-------------------------------------------------------------------------" << ENDL << ENDL;
 
-    os << "// include the support codes provided by the user for neuron or synaptic models" << ENDL;
-    os << "#include \"support_code.h\"" << ENDL << ENDL; 
+    os << "#include \"definitions.h\"" << ENDL;
+    os << "#include <cstdlib>" << ENDL;
+    os << "#include <cstdio>" << ENDL;
+    os << "#include <cmath>" << ENDL;
+    os << "#include <stdint.h>" << ENDL;
+    os << ENDL;
+}
+
 
-    // function header
-    os << "void calcNeuronsCPU(" << model.ftype << " t)" << ENDL;
-    os << OB(51);
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that writes user support code into a separately compiled CPU code file. The code is wrapped into an unnamed namespace so that the copies in different files do not clash at link time.
+*/
+//--------------------------------------------------------------------------
+
+static void genSupportCodeNamespace(ostream &os, //!< output stream for code
+				    string nspace, //!< Name of the support code namespace
+				    string code //!< The support code
+    )
+{
+    if (code == tS("")) return;
+    os << "namespace" << OB(12);
+    os << "namespace " << nspace << OB(11) << ENDL;
+    os << code << ENDL;
+    os << CB(11) << " // end of support code namespace " << nspace << ENDL;
+    os << CB(12) << ENDL;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that writes the head of the CPU simulation function of a group.
+
+  With GENN_PREFERENCES::multiversionCPUCode the code of the function goes into the always inlined function <name>Body, which genCPUFunctionVersions() instantiates for several instruction set levels.
+*/
+//--------------------------------------------------------------------------
+
+static void genCPUFunctionHead(ostream &os, //!< output stream for code
+			       NNmodel &model, //!< Model description
+			       string name //!< Name of the function
+    )
+{
+    if (GENN_PREFERENCES::multiversionCPUCode) {
+	os << "static GENN_ISA_INLINE void " << name << "Body(" << model.ftype << " t)" << ENDL;
+    }
+    else {
+	os << "void " << name << "(" << model.ftype << " t)" << ENDL;
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that writes the versions of a CPU simulation function for the SSE4.2, AVX2 and AVX-512 instruction set levels and the function that calls the version chosen in allocateMem().
+*/
+//--------------------------------------------------------------------------
 
-    // function code
+static void genCPUFunctionVersions(ostream &os, //!< output stream for code
+				   NNmodel &model, //!< Model description
+				   string name //!< Name of the function
+    )
+{
+    if (!GENN_PREFERENCES::multiversionCPUCode) return;
+    const char *levels[]= {"AVX512", "AVX2", "SSE42"};
+    const char *suffixes[]= {"_avx512", "_avx2", "_sse42"};
+    os << "#ifdef GENN_ISA_DISPATCH" << ENDL;
+    for (int k= 0; k < 3; k++) {
+	os << "static GENN_TARGET_" << levels[k] << " void " << name << suffixes[k] << "(" << model.ftype << " t)" << ENDL;
+	os << "{" << ENDL;
+	os << "    " << name << "Body(t);" << ENDL;
+	os << "}" << ENDL;
+	os << ENDL;
+    }
+    os << "#endif" << ENDL;
+    os << ENDL;
+    os << "void " << name << "(" << model.ftype << " t)" << ENDL;
+    os << "{" << ENDL;
+    os << "#ifdef GENN_ISA_DISPATCH" << ENDL;
+    os << "    switch (genn_isa) {" << ENDL;
+    for (int k= 0; k < 3; k++) {
+	os << "    case GENN_ISA_" << levels[k] << ": " << name << suffixes[k] << "(t); return;" << ENDL;
+    }
+    os << "    }" << ENDL;
+    os << "#endif" << ENDL;
+    os << "    " << name << "Body(t);" << ENDL;
+    os << "}" << ENDL;
+    os << ENDL;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that lists the NUMA nodes the CPU code of the model runs on, which are the distinct device IDs of the cluster indices of the groups.
+
+  Code for GPUs uses the device IDs for CUDA devices, so that all CPU code runs on one node.
+*/
+//--------------------------------------------------------------------------
+
+vector<int> cpuNodes(NNmodel &model //!< Model description
+    )
+{
+    vector<int> nodes;
+#ifdef CPU_ONLY
     for (int i = 0; i < model.neuronGrpN; i++) {
-	nt = model.neuronType[i];
+	nodes.push_back(model.neuronDeviceID[i]);
+    }
+    for (int i = 0; i < model.synapseGrpN; i++) {
+	if (model.synapseDeviceID[i] >= 0) nodes.push_back(model.synapseDeviceID[i]);
+    }
+    sort(nodes.begin(), nodes.end());
+    nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+#endif
+    if (nodes.size() == 0) nodes.push_back(0);
+    return nodes;
+}
 
-	string queueOffset = (model.neuronDelaySlots[i] > 1 ? "(spkQuePtr" + model.neuronName[i] + " * " + tS(model.neuronN[i]) + ") + " : "");
-	string queueOffsetTrueSpk = (model.neuronNeedTrueSpk[i] ? queueOffset : "");
 
-	os << "// neuron group " << model.neuronName[i] << ENDL;
-	os << OB(55);
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the index in cpuNodes() of the NUMA node a neuron group is simulated on.
+*/
+//--------------------------------------------------------------------------
+
+unsigned int neuronCPUNode(NNmodel &model, //!< Model description
+			   int i //!< Index of the neuron group
+    )
+{
+    vector<int> nodes= cpuNodes(model);
+    if (nodes.size() == 1) return 0;
+    return lower_bound(nodes.begin(), nodes.end(), model.neuronDeviceID[i]) - nodes.begin();
+}
 
-	// increment spike queue pointer and reset spike count
-	if (model.neuronDelaySlots[i] > 1) { // with delay
-	    os << "spkQuePtr" << model.neuronName[i] << " = (spkQuePtr" << model.neuronName[i] << " + 1) % " << model.neuronDelaySlots[i] << ";" << ENDL;
-	    if (model.neuronNeedSpkEvnt[i]) {
-		os << "glbSpkCntEvnt" << model.neuronName[i] << "[spkQuePtr" << model.neuronName[i] << "] = 0;" << ENDL;
-	    }
-	    if (model.neuronNeedTrueSpk[i]) {
-		os << "glbSpkCnt" << model.neuronName[i] << "[spkQuePtr" << model.neuronName[i] << "] = 0;" << ENDL;
-	    }
-	    else {
-		os << "glbSpkCnt" << model.neuronName[i] << "[0] = 0;" << ENDL;
-	    }
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the index in cpuNodes() of the NUMA node a synapse group is simulated on, which by default is the node of its postsynaptic neuron group.
+*/
+//--------------------------------------------------------------------------
+
+unsigned int synapseCPUNode(NNmodel &model, //!< Model description
+			    int i //!< Index of the synapse group
+    )
+{
+    if (model.synapseDeviceID[i] < 0) return neuronCPUNode(model, model.synapseTarget[i]);
+    vector<int> nodes= cpuNodes(model);
+    if (nodes.size() == 1) return 0;
+    return lower_bound(nodes.begin(), nodes.end(), model.synapseDeviceID[i]) - nodes.begin();
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that lists the hosts (MPI ranks) the CPU code of the model runs on, which are the distinct host IDs of the cluster indices of the groups.
+
+  Code for GPUs runs on one host.
+*/
+//--------------------------------------------------------------------------
+
+vector<int> cpuHosts(NNmodel &model //!< Model description
+    )
+{
+    vector<int> hosts;
+#ifdef CPU_ONLY
+    for (int i = 0; i < model.neuronGrpN; i++) {
+	hosts.push_back(model.neuronHostID[i]);
+    }
+    sort(hosts.begin(), hosts.end());
+    hosts.erase(unique(hosts.begin(), hosts.end()), hosts.end());
+#endif
+    if (hosts.size() == 0) hosts.push_back(0);
+    return hosts;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the host (MPI rank) a synapse group is simulated on, which is the host of its postsynaptic neuron group.
+*/
+//--------------------------------------------------------------------------
+
+int synapseHost(NNmodel &model, //!< Model description
+		int i //!< Index of the synapse group
+    )
+{
+    return model.neuronHostID[model.synapseTarget[i]];
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that checks whether the postsynaptic input of a synapse group can be added to that of other groups before the postsynaptic model is applied: the model has no variables or runtime parameters and its codes are linear in the input.
+*/
+//--------------------------------------------------------------------------
+
+static bool linearPostSynapse(NNmodel &model, //!< Model description
+			      int i //!< Index of the synapse group
+    )
+{
+    postSynModel &psm= postSynModels[model.postSynapseType[i]];
+    if ((psm.varNames.size() > 0) || (model.runtimePostSynapseParaNames(i).size() > 0)) return false;
+    return isLinearIn(psm.postSyntoCurrent, tS("inSyn")) && isLinearIn(psm.postSynDecay, tS("inSyn"));
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the synapse group whose postsynaptic input array a synapse group adds to, which is the group itself unless its inputs are merged.
+
+  In CPU_ONLY code, incoming synapse groups of a neuron group whose postsynaptic models are of the same type, linear in the input (see isLinearIn()) and have the same parameters add to the input of the first of them, if they run on the same NUMA node. The neuron code then converts and decays one input instead of one per group. Merging is requested with GENN_PREFERENCES::sharePostsynapticInputs.
+*/
+//--------------------------------------------------------------------------
+
+unsigned int inSynGroup(NNmodel &model, //!< Model description
+			int i //!< Index of the synapse group
+    )
+{
+#ifdef CPU_ONLY
+    if (!GENN_PREFERENCES::sharePostsynapticInputs || !linearPostSynapse(model, i)) return i;
+    vector<unsigned int> &inSyn= model.inSyn[model.synapseTarget[i]];
+    for (int j= 0; (j < inSyn.size()) && (inSyn[j] != i); j++) {
+	unsigned int k= inSyn[j];
+	if ((model.postSynapseType[k] == model.postSynapseType[i]) && (model.postSynapsePara[k] == model.postSynapsePara[i])
+	    && (model.dpsp[k] == model.dpsp[i]) && (synapseCPUNode(model, k) == synapseCPUNode(model, i)) && linearPostSynapse(model, k)) return k;
+    }
+#endif
+    return i;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that checks whether the CPU code of a synapse group chooses at every time step between pushing the spikes along the rows of its connectivity and pulling them into the targets along the reverse connectivity.
+
+  This needs the reverse connectivity of a SPARSE group, which is only created for groups with postsynaptic learning, and GENN_PREFERENCES::pullSpikeFraction below 1.
+*/
+//--------------------------------------------------------------------------
+
+bool pullsSpikes(NNmodel &model, //!< Model description
+		 int i //!< Index of the synapse group
+    )
+{
+    return (model.synapseConnType[i] == SPARSE) && model.synapseUsesPostLearning[i] && (GENN_PREFERENCES::pullSpikeFraction < 1.0);
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that checks whether the spikes of a neuron group are needed on other hosts (MPI ranks).
+*/
+//--------------------------------------------------------------------------
+
+bool exportsSpikes(NNmodel &model, //!< Model description
+		   int i //!< Index of the neuron group
+    )
+{
+    if (cpuHosts(model).size() == 1) return false;
+    for (int j = 0; j < model.outSyn[i].size(); j++) {
+	if (synapseHost(model, model.outSyn[i][j]) != model.neuronHostID[i]) return true;
+    }
+    return false;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the number of time steps after which spikes are exchanged between the hosts (MPI ranks) of a distributed model.
+
+  Spikes emitted in a time step reach a synapse group with delay d in the (d+1)-th time step after it, so that the spikes of d+1 time steps can be sent together. The window is the shortest such time of all synapse groups whose presynaptic neurons are on another host. These synapse groups only see the spikes of their presynaptic neurons, so that their code must not refer to presynaptic variables or use spike-like events.
+*/
+//--------------------------------------------------------------------------
+
+unsigned int spikeExchangeWindow(NNmodel &model //!< Model description
+    )
+{
+    unsigned int window= 0;
+    for (int i = 0; i < model.synapseGrpN; i++) {
+	if ((model.synapseHostID[i] >= 0) && (model.synapseHostID[i] != synapseHost(model, i))) {
+	    gennError("The synapse group " + model.synapseName[i] + " must be simulated on the host of its postsynaptic neuron group.");
 	}
-	else { // no delay
-	    if (model.neuronNeedSpkEvnt[i]) {
-		os << "glbSpkCntEvnt" << model.neuronName[i] << "[0] = 0;" << ENDL;
-	    }
-	    os << "glbSpkCnt" << model.neuronName[i] << "[0] = 0;" << ENDL;
+	unsigned int src= model.synapseSource[i];
+	if (model.neuronHostID[src] == synapseHost(model, i)) continue;
+	weightUpdateModel &wu= weightUpdateModels[model.synapseType[i]];
+	string code= wu.simCode + wu.simLearnPost + wu.synapseDynamics;
+	if (model.synapseUsesSpikeEvents[i] || (code.find("_pre)") != string::npos)) {
+	    gennError("The synapse group " + model.synapseName[i] + " connects neurons on different hosts and can therefore neither use presynaptic variables nor spike-like events.");
 	}
-	vector<bool> varNeedQueue = model.neuronVarNeedQueue[i];
-	if ((find(varNeedQueue.begin(), varNeedQueue.end(), true) != varNeedQueue.end()) && (model.neuronDelaySlots[i] > 1)) {
-	    os << "unsigned int delaySlot = (spkQuePtr" << model.neuronName[i];
-	    os << " + " << (model.neuronDelaySlots[i] - 1);
-	    os << ") % " << model.neuronDelaySlots[i] << ";" << ENDL;
+	if ((window == 0) || (model.synapseDelay[i] + 1 < window)) window= model.synapseDelay[i] + 1;
+    }
+    return (window == 0) ? 1 : window;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that writes a function of neuronFnct.cc or synapseFnct.cc that calls the functions of the individual groups.
+
+  If the model runs on several NUMA nodes, the calls of each node are made by the thread of that node and the function returns when all nodes are done. If the model is distributed over several hosts, each call is only made on its host (MPI rank), and other hosts run the given replacement code.
+*/
+//--------------------------------------------------------------------------
+
+static void genCPUDispatch(ostream &os, //!< output stream for code
+			   NNmodel &model, //!< Model description
+			   string name, //!< Name of the function
+			   vector<string> &calls, //!< Functions to call
+			   vector<unsigned int> &callNodes, //!< Index of the NUMA node of each call
+			   vector<int> &callHosts, //!< Host (MPI rank) of each call
+			   vector<string> &remoteCode //!< Code run instead of each call on other hosts
+    )
+{
+    unsigned int nodeN= (calls.size() > 0) ? cpuNodes(model).size() : 1;
+    bool distributed= (cpuHosts(model).size() > 1);
+    vector<vector<string> > callCode(nodeN);
+    for (int k = 0; k < calls.size(); k++) {
+	unsigned int n= (nodeN > 1) ? callNodes[k] : 0;
+	if (distributed) {
+	    callCode[n].push_back("if (genn_rank == " + tS(callHosts[k]) + ") " + calls[k] + "(t);");
+	    if (remoteCode[k] != tS("")) callCode[n].push_back("else " + remoteCode[k]);
 	}
+	else {
+	    callCode[n].push_back(calls[k] + "(t);");
+	}
+    }
+    if (nodeN > 1) {
+	os << "static void " << name << "Node(int node, void *arg)" << ENDL;
+	os << "{" << ENDL;
+	os << "    " << model.ftype << " t= *((" << model.ftype << " *) arg);" << ENDL;
+	os << "    switch (node) {" << ENDL;
+	for (unsigned int n = 0; n < nodeN; n++) {
+	    os << "    case " << n << ":" << ENDL;
+	    for (int k = 0; k < callCode[n].size(); k++) {
+		os << "        " << callCode[n][k] << ENDL;
+	    }
+	    os << "        break;" << ENDL;
+	}
+	os << "    }" << ENDL;
+	os << "}" << ENDL;
 	os << ENDL;
+    }
+    os << "void " << name << "(" << model.ftype << " t)" << ENDL;
+    os << "{" << ENDL;
+    if (nodeN > 1) {
+	os << "    numaRun(" << name << "Node, &t);" << ENDL;
+    }
+    else {
+	for (int k = 0; k < callCode[0].size(); k++) {
+	    os << "    " << callCode[0][k] << ENDL;
+	}
+    }
+    os << "}" << ENDL;
+    os << ENDL;
+}
 
-	os << "for (int n = 0; n < " <<  model.neuronN[i] << "; n++)" << OB(10);
-	for (int k = 0; k < nModels[nt].varNames.size(); k++) {
-	    os << nModels[nt].varTypes[k] << " l" << nModels[nt].varNames[k] << " = ";
-	    os << nModels[nt].varNames[k] << model.neuronName[i] << "[";
-	    if ((model.neuronVarNeedQueue[i][k]) && (model.neuronDelaySlots[i] > 1)) {
-		os << "(delaySlot * " << model.neuronN[i] << ") + ";
-	    }
-	    os << "n];" << ENDL;
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Names under which the generated CPU code of a neuron group refers to its arrays, its size, the support code and the parameters.
+
+  The code of a single neuron group uses the global variables of the group. The code of a set of merged neuron groups uses local names that are bound to the arrays, size and parameter values of each of the groups in turn. Parameters that differ between the merged groups are looked up in tables, all other parameters are inserted as constants.
+*/
+//--------------------------------------------------------------------------
+
+struct NeuronGroupNames
+{
+    bool merged; //!< Whether the code is generated for a set of merged neuron groups
+    string suffix; //!< Suffix of the state variable and spike arrays
+    string size; //!< Number of neurons
+    string nspace; //!< Support code namespace of the neuron model
+    vector<string> inSynSuffix; //!< Suffixes of the arrays of the incoming synapse groups
+    vector<string> inSynNspace; //!< Support code namespaces of the postsynaptic models of the incoming synapse groups
+    vector<bool> paraSymbolic; //!< For merged groups, whether a parameter (followed by the derived parameters) of the neuron model is looked up rather than inserted as a constant
+    vector<vector<bool> > inSynParaSymbolic; //!< For merged groups, the same for the parameters of the postsynaptic models of the incoming synapse groups
+};
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the names used by the code of a single neuron group.
+*/
+//--------------------------------------------------------------------------
+
+static NeuronGroupNames singleGroupNames(NNmodel &model, //!< Model description
+					 int i //!< Index of the neuron group
+    )
+{
+    NeuronGroupNames names;
+    names.merged= false;
+    names.suffix= model.neuronName[i];
+    names.size= tS(model.neuronN[i]);
+    names.nspace= model.neuronName[i] + tS("_neuron");
+    for (int j = 0; j < model.inSyn[i].size(); j++) {
+	unsigned int synPopID= model.inSyn[i][j];
+	names.inSynSuffix.push_back(model.synapseName[synPopID]);
+	names.inSynNspace.push_back(model.synapseName[synPopID] + tS("_postsyn"));
+    }
+    return names;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that returns the names used by the code of a set of merged neuron groups. The support code namespaces are those of the first group of the set.
+*/
+//--------------------------------------------------------------------------
+
+static NeuronGroupNames mergedGroupNames(NNmodel &model, //!< Model description
+					 vector<unsigned int> &groups //!< Indices of the merged neuron groups
+    )
+{
+    unsigned int i= groups[0];
+    NeuronGroupNames names;
+    names.merged= true;
+    names.suffix= tS("_m");
+    names.size= tS("N_m");
+    names.nspace= model.neuronName[i] + tS("_neuron");
+    vector<double> paras= model.neuronPara[i];
+    paras.insert(paras.end(), model.dnp[i].begin(), model.dnp[i].end());
+    names.paraSymbolic.assign(paras.size(), false);
+    for (int k= 1; k < groups.size(); k++) {
+	vector<double> other= model.neuronPara[groups[k]];
+	other.insert(other.end(), model.dnp[groups[k]].begin(), model.dnp[groups[k]].end());
+	for (int p= 0; p < paras.size(); p++) {
+	    if (other[p] != paras[p]) names.paraSymbolic[p]= true;
 	}
-	if ((nModels[nt].simCode.find(tS("$(sT)")) != string::npos)
-	    || (nModels[nt].thresholdConditionCode.find(tS("$(sT)")) != string::npos)
-	    || (nModels[nt].resetCode.find(tS("$(sT)")) != string::npos)) { // load sT into local variable
-	    os << model.ftype << " lsT= sT" <<  model.neuronName[i] << "[";
-	    if (model.neuronDelaySlots[i] > 1) {
-		os << "(delaySlot * " << model.neuronN[i] << ") + ";
+    }
+    for (int j = 0; j < model.inSyn[i].size(); j++) {
+	unsigned int synPopID= model.inSyn[i][j];
+	names.inSynSuffix.push_back(tS("_m") + tS(j));
+	names.inSynNspace.push_back(model.synapseName[synPopID] + tS("_postsyn"));
+	paras= model.postSynapsePara[synPopID];
+	paras.insert(paras.end(), model.dpsp[synPopID].begin(), model.dpsp[synPopID].end());
+	vector<bool> symbolic(paras.size(), false);
+	for (int k= 1; k < groups.size(); k++) {
+	    unsigned int otherSynPopID= model.inSyn[groups[k]][j];
+	    vector<double> other= model.postSynapsePara[otherSynPopID];
+	    other.insert(other.end(), model.dpsp[otherSynPopID].begin(), model.dpsp[otherSynPopID].end());
+	    for (int p= 0; p < paras.size(); p++) {
+		if (other[p] != paras[p]) symbolic[p]= true;
 	    }
-	    os << "n];" << ENDL;
 	}
-	os << ENDL;
+	names.inSynParaSymbolic.push_back(symbolic);
+    }
+    return names;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that substitutes parameters and derived parameters in the code of merged groups: looked up parameters by their local name, the others by their value.
+*/
+//--------------------------------------------------------------------------
+
+static void mergedParaSubstitutions(string &code, //!< the code string to work on
+				    vector<string> &pNames, //!< Names of the parameters
+				    vector<string> &dpNames, //!< Names of the derived parameters
+				    vector<double> &paras, //!< Parameter values of the first group
+				    vector<double> &dparas, //!< Derived parameter values of the first group
+				    vector<bool> &symbolic, //!< Which parameters are looked up
+				    string suffix //!< Suffix of the local names of looked up parameters
+    )
+{
+    for (int k= 0, l= pNames.size(); k < l; k++) {
+	substitute(code, tS("$(") + pNames[k] + tS(")"), (symbolic[k] ? pNames[k] + suffix : tS("(") + tS(paras[k]) + tS(")")));
+    }
+    for (int k= 0, l= dpNames.size(); k < l; k++) {
+	substitute(code, tS("$(") + dpNames[k] + tS(")"), (symbolic[pNames.size() + k] ? dpNames[k] + suffix : tS("(") + tS(dparas[k]) + tS(")")));
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that substitutes the parameters of neuron group i, or of the merged groups it represents, in a code snippet.
+*/
+//--------------------------------------------------------------------------
+
+static void neuronGroupParaSubstitutions(string &code, NNmodel &model, int i, NeuronGroupNames &names)
+{
+    unsigned int nt= model.neuronType[i];
+    if (names.merged) {
+	mergedParaSubstitutions(code, nModels[nt].pNames, nModels[nt].dpNames, model.neuronPara[i], model.dnp[i], names.paraSymbolic, names.suffix);
+    }
+    else {
+	neuron_para_substitutions(code, model, i);
+    }
+}
 
-	if ((model.inSyn[i].size() > 0) || (nModels[nt].simCode.find(tS("Isyn")) != string::npos)) {
-	    os << model.ftype << " Isyn = 0;" << ENDL;
-	} 
-	for (int j = 0; j < model.inSyn[i].size(); j++) {
-	    unsigned int synPopID= model.inSyn[i][j]; // number of (post)synapse group
-	    postSynModel psm= postSynModels[model.postSynapseType[synPopID]];
-	    string sName= model.synapseName[synPopID];
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that substitutes the parameters of the j-th incoming synapse group of neuron group i, or of the merged groups it represents, in a code snippet.
+*/
+//--------------------------------------------------------------------------
+
+static void inSynParaSubstitutions(string &code, NNmodel &model, int i, int j, NeuronGroupNames &names)
+{
+    unsigned int synPopID= model.inSyn[i][j];
+    postSynModel &psm= postSynModels[model.postSynapseType[synPopID]];
+    if (names.merged) {
+	mergedParaSubstitutions(code, psm.pNames, psm.dpNames, model.postSynapsePara[synPopID], model.dpsp[synPopID], names.inSynParaSymbolic[j], names.inSynSuffix[j]);
+    }
+    else {
+	postsynapse_para_substitutions(code, model, synPopID);
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that generates the code that advances the spike queue of a neuron group and resets its spike counts at the start of a time step on the CPU.
+*/
+//--------------------------------------------------------------------------
+
+static void genNeuronQueueUpdate(ostream &os, //!< output stream for code
+				 NNmodel &model, //!< Model description 
+				 int i, //!< Index of the neuron group
+				 NeuronGroupNames &names //!< Names used in the code
+    )
+{
+    // increment spike queue pointer and reset spike count
+    if (model.neuronDelaySlots[i] > 1) { // with delay
+	os << "spkQuePtr" << model.neuronName[i] << " = (spkQuePtr" << model.neuronName[i] << " + 1) % " << model.neuronDelaySlots[i] << ";" << ENDL;
+	if (model.neuronNeedSpkEvnt[i]) {
+	    os << "glbSpkCntEvnt" << names.suffix << "[spkQuePtr" << model.neuronName[i] << "] = 0;" << ENDL;
+	}
+	if (model.neuronNeedTrueSpk[i]) {
+	    os << "glbSpkCnt" << names.suffix << "[spkQuePtr" << model.neuronName[i] << "] = 0;" << ENDL;
+	}
+	else {
+	    os << "glbSpkCnt" << names.suffix << "[0] = 0;" << ENDL;
+	}
+    }
+    else { // no delay
+	if (model.neuronNeedSpkEvnt[i]) {
+	    os << "glbSpkCntEvnt" << names.suffix << "[0] = 0;" << ENDL;
+	}
+	os << "glbSpkCnt" << names.suffix << "[0] = 0;" << ENDL;
+    }
+    vector<bool> varNeedQueue = model.neuronVarNeedQueue[i];
+    if ((find(varNeedQueue.begin(), varNeedQueue.end(), true) != varNeedQueue.end()) && (model.neuronDelaySlots[i] > 1)) {
+	os << "unsigned int delaySlot = (spkQuePtr" << model.neuronName[i];
+	os << " + " << (model.neuronDelaySlots[i] - 1);
+	os << ") % " << model.neuronDelaySlots[i] << ";" << ENDL;
+    }
+    os << ENDL;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that generates the code that simulates one time step of neuron n of a neuron group on the CPU.
+*/
+//--------------------------------------------------------------------------
+
+static void genNeuronCode(ostream &os, //!< output stream for code
+			  NNmodel &model, //!< Model description 
+			  int i, //!< Index of the neuron group
+			  NeuronGroupNames &names //!< Names used in the code
+    )
+{
+    unsigned int nt = model.neuronType[i];
+    string queueOffset = (model.neuronDelaySlots[i] > 1 ? "(spkQuePtr" + model.neuronName[i] + " * " + names.size + ") + " : "");
+    string queueOffsetTrueSpk = (model.neuronNeedTrueSpk[i] ? queueOffset : "");
+    vector<string> floatNames= neuronFloatNames(model, i, (names.merged ? names.suffix : tS("")), names.inSynSuffix);
+
+    for (int k = 0; k < nModels[nt].varNames.size(); k++) {
+	os << nModels[nt].varTypes[k] << " l" << nModels[nt].varNames[k] << " = ";
+	os << nModels[nt].varNames[k] << names.suffix << "[";
+	if ((model.neuronVarNeedQueue[i][k]) && (model.neuronDelaySlots[i] > 1)) {
+	    os << "(delaySlot * " << names.size << ") + ";
+	}
+	os << "n];" << ENDL;
+    }
+    if ((nModels[nt].simCode.find(tS("$(sT)")) != string::npos)
+	|| (nModels[nt].thresholdConditionCode.find(tS("$(sT)")) != string::npos)
+	|| (nModels[nt].resetCode.find(tS("$(sT)")) != string::npos)) { // load sT into local variable
+	os << model.ftype << " lsT= sT" <<  names.suffix << "[";
+	if (model.neuronDelaySlots[i] > 1) {
+	    os << "(delaySlot * " << names.size << ") + ";
+	}
+	os << "n];" << ENDL;
+    }
+    if (nModels[nt].needsGennrand()) {
+	os << "unsigned int rndN= 0; // number of random numbers drawn by this neuron" << ENDL;
+    }
+    os << ENDL;
+
+    if ((model.inSyn[i].size() > 0) || (nModels[nt].simCode.find(tS("Isyn")) != string::npos)) {
+	os << model.ftype << " Isyn = 0;" << ENDL;
+    } 
+    for (int j = 0; j < model.inSyn[i].size(); j++) {
+	unsigned int synPopID= model.inSyn[i][j]; // number of (post)synapse group
+	if (inSynGroup(model, synPopID) != synPopID) continue; // added to the input of an earlier group
+	postSynModel psm= postSynModels[model.postSynapseType[synPopID]];
+	string sName= names.inSynSuffix[j];
 	    
-	    if (model.synapseGType[synPopID] == INDIVIDUALG) {
-		for (int k = 0, l = psm.varNames.size(); k < l; k++) {
-		    os << psm.varTypes[k] << " lps" << psm.varNames[k] << sName;
-		    os << " = " <<  psm.varNames[k] << sName << "[n];" << ENDL;
+	if (model.synapseGType[synPopID] == INDIVIDUALG) {
+	    for (int k = 0, l = psm.varNames.size(); k < l; k++) {
+		os << psm.varTypes[k] << " lps" << psm.varNames[k] << sName;
+		os << " = " <<  psm.varNames[k] << sName << "[n];" << ENDL;
 		    
-		}
-	    }
-	    if (psm.supportCode != tS("")) {
-		os << OB(29) << " using namespace " << sName << "_postsyn;" << ENDL;
-	    }
-	    os << "Isyn += ";
-	    string psCode = psm.postSyntoCurrent;
-	    substitute(psCode, tS("$(id)"), tS("n"));
-	    substitute(psCode, tS("$(t)"), tS("t"));
-	    substitute(psCode, tS("$(inSyn)"), tS("inSyn") + sName + tS("[n]"));
-	    name_substitutions(psCode, tS("l"), nModels[nt].varNames, tS(""));
-	    value_substitutions(psCode, nModels[nt].pNames, model.neuronPara[i]);
-	    value_substitutions(psCode, nModels[nt].dpNames, model.dnp[i]);
-	    if (model.synapseGType[synPopID] == INDIVIDUALG) {
-		name_substitutions(psCode, tS("lps"), psm.varNames, sName);
-	    }
-	    else {
-		value_substitutions(psCode, psm.varNames, model.postSynIni[synPopID]);
-	    }
-	    value_substitutions(psCode, psm.pNames, model.postSynapsePara[synPopID]);
-	    value_substitutions(psCode, psm.dpNames, model.dpsp[synPopID]);
-	    name_substitutions(psCode, tS(""), nModels[nt].extraGlobalNeuronKernelParameters, model.neuronName[i]);
-	    psCode= ensureFtype(psCode, model.ftype);
-	    checkUnreplacedVariables(psCode, tS("postSyntoCurrent"));
-	    os << psCode << ";" << ENDL;
-	    if (psm.supportCode != tS("")) {
-		os << CB(29) << " // namespace bracket closed" << ENDL;
 	    }
 	}
-    
-    
-	os << "// test whether spike condition was fulfilled previously" << ENDL;
-	string thCode= nModels[nt].thresholdConditionCode;
-	if (thCode == tS("")) { // no condition provided
-	    cerr << "Warning: No thresholdConditionCode for neuron type " << model.neuronType[i] << " used for population \"" << model.neuronName[i] << "\" was provided. There will be no spikes detected in this population!" << endl;
+	if (psm.supportCode != tS("")) {
+	    os << OB(29) << " using namespace " << names.inSynNspace[j] << ";" << ENDL;
+	}
+	os << "Isyn += ";
+	string psCode = psm.postSyntoCurrent;
+	substitute(psCode, tS("$(id)"), tS("n"));
+	substitute(psCode, tS("$(t)"), tS("t"));
+	substitute(psCode, tS("$(inSyn)"), tS("inSyn") + sName + tS("[n]"));
+	name_substitutions(psCode, tS("l"), nModels[nt].varNames, tS(""));
+	neuronGroupParaSubstitutions(psCode, model, i, names);
+	if (model.synapseGType[synPopID] == INDIVIDUALG) {
+	    name_substitutions(psCode, tS("lps"), psm.varNames, sName);
 	}
 	else {
-	    substitute(thCode, tS("$(id)"), tS("n"));
-	    substitute(thCode, tS("$(t)"), tS("t"));
-	    name_substitutions(thCode, tS("l"), nModels[nt].varNames, tS(""));
-	    substitute(thCode, tS("$(sT)"), tS("lsT"));
-	    value_substitutions(thCode, nModels[nt].pNames, model.neuronPara[i]);
-	    value_substitutions(thCode, nModels[nt].dpNames, model.dnp[i]);
-	    substitute(thCode, tS("$(Isyn)"), tS("Isyn"));
-	    thCode= ensureFtype(thCode, model.ftype);
-	    checkUnreplacedVariables(thCode, tS("thresholdConditionCode"));
-	    if (GENN_PREFERENCES::autoRefractory) {
-		if (nModels[nt].supportCode != tS("")) {
-		    os << OB(29) << " using namespace " << model.neuronName[i] << "_neuron;" << ENDL;
-		}
-		os << "bool oldSpike= (" << thCode << ");" << ENDL;  
-		if (nModels[nt].supportCode != tS("")) {
-		    os << CB(29) << " // namespace bracket closed" << endl;
-		}
+	    value_substitutions(psCode, psm.varNames, model.postSynIni[synPopID]);
+	}
+	inSynParaSubstitutions(psCode, model, i, j, names);
+	name_substitutions(psCode, tS(""), nModels[nt].extraGlobalNeuronKernelParameters, model.neuronName[i]);
+	psCode= optimiseExpression(psCode);
+	psCode= ensureFtype(psCode, model.ftype, model.mathPrecision);
+	checkUnreplacedVariables(psCode, tS("postSyntoCurrent"));
+	os << psCode << ";" << ENDL;
+	if (psm.supportCode != tS("")) {
+	    os << CB(29) << " // namespace bracket closed" << ENDL;
+	}
+    }
+    
+    
+    os << "// test whether spike condition was fulfilled previously" << ENDL;
+    string thCode= nModels[nt].thresholdConditionCode;
+    if (thCode != tS("")) {
+	neuron_table_substitutions(thCode, model, i);
+	substitute(thCode, tS("$(id)"), tS("n"));
+	substitute(thCode, tS("$(t)"), tS("t"));
+	name_substitutions(thCode, tS("l"), nModels[nt].varNames, tS(""));
+	substitute(thCode, tS("$(sT)"), tS("lsT"));
+	neuronGroupParaSubstitutions(thCode, model, i, names);
+	substitute(thCode, tS("$(Isyn)"), tS("Isyn"));
+	name_substitutions(thCode, tS(""), nModels[nt].extraGlobalNeuronKernelParameters, model.neuronName[i]);
+	thCode= optimiseExpression(thCode);
+	thCode= ensureFtype(thCode, model.ftype, model.mathPrecision);
+	checkUnreplacedVariables(thCode, tS("thresholdConditionCode"));
+	if (GENN_PREFERENCES::autoRefractory && nModels[nt].needAutoRefractory) {
+	    if (nModels[nt].supportCode != tS("")) {
+		os << OB(29) << " using namespace " << names.nspace << ";" << ENDL;
+	    }
+	    os << "bool oldSpike= (" << thCode << ");" << ENDL;  
+	    if (nModels[nt].supportCode != tS("")) {
+		os << CB(29) << " // namespace bracket closed" << endl;
 	    }
 	}
+    }
 
-	os << "// calculate membrane potential" << ENDL;
-	string sCode = nModels[nt].simCode;
-	substitute(sCode, tS("$(id)"), tS("n"));
-	substitute(sCode, tS("$(t)"), tS("t"));
-	name_substitutions(sCode, tS("l"), nModels[nt].varNames, tS(""));
-	value_substitutions(sCode, nModels[nt].pNames, model.neuronPara[i]);
-	value_substitutions(sCode, nModels[nt].dpNames, model.dnp[i]);
-	name_substitutions(sCode, tS(""), nModels[nt].extraGlobalNeuronKernelParameters, model.neuronName[i]);
-	if (nt == POISSONNEURON) {
-	    substitute(sCode, tS("lrate"), tS("rates") + model.neuronName[i] + tS("[n + offset") + model.neuronName[i] + tS("]"));
+    os << "// calculate membrane potential" << ENDL;
+    string sCode = nModels[nt].simCode;
+    neuron_table_substitutions(sCode, model, i);
+    gennrand_substitutions(sCode, i, tS("n"));
+    substitute(sCode, tS("$(id)"), tS("n"));
+    substitute(sCode, tS("$(t)"), tS("t"));
+    name_substitutions(sCode, tS("l"), nModels[nt].varNames, tS(""));
+    neuronGroupParaSubstitutions(sCode, model, i, names);
+    name_substitutions(sCode, tS(""), nModels[nt].extraGlobalNeuronKernelParameters, model.neuronName[i]);
+    if (nt == POISSONNEURON) {
+	substitute(sCode, tS("lrate"), tS("rates") + model.neuronName[i] + tS("[n + offset") + model.neuronName[i] + tS("]"));
+    }
+    substitute(sCode, tS("$(Isyn)"), tS("Isyn"));
+    substitute(sCode, tS("$(sT)"), tS("lsT"));
+    sCode= optimiseStatements(sCode, model.ftype, floatNames);
+    sCode= ensureFtype(sCode, model.ftype, model.mathPrecision);
+    checkUnreplacedVariables(sCode,tS("neuron simCode"));
+    if (nModels[nt].supportCode != tS("")) {
+	os << OB(29) << " using namespace " << names.nspace << ";" << ENDL;
+    }
+    os << sCode << ENDL;
+    if (nModels[nt].supportCode != tS("")) {
+	os << CB(29) << " // namespace bracket closed" << endl;
+    }
+
+    // look for spike type events first.
+    if (model.neuronNeedSpkEvnt[i]) {
+	string eCode= model.neuronSpkEvntCondition[i];
+	// code substitutions ----
+	extended_name_substitutions(eCode, tS("l"), nModels[model.neuronType[i]].varNames, tS("_pre"), tS(""));
+	substitute(eCode, tS("$(id)"), tS("n"));
+	substitute(eCode, tS("$(t)"), tS("t"));
+	name_substitutions(eCode, tS(""), nModels[model.neuronType[i]].extraGlobalNeuronKernelParameters, model.neuronName[i]);
+	eCode= optimiseExpression(eCode);
+	eCode= ensureFtype(eCode, model.ftype, model.mathPrecision);
+	checkUnreplacedVariables(eCode, tS("neuronSpkEvntCondition"));
+	// end code substitutions ----
+
+	os << "// test for and register a spike-like event" << ENDL;
+	if (nModels[nt].supportCode != tS("")) {
+	    os << OB(29) << " using namespace " << names.nspace << ";" << ENDL;	
+	}
+	os << "if (" + eCode + ")" << OB(30);
+	os << "glbSpkEvnt" << names.suffix << "[" << queueOffset << "glbSpkCntEvnt" << names.suffix;
+	if (model.neuronDelaySlots[i] > 1) { // WITH DELAY
+	    os << "[spkQuePtr" << model.neuronName[i] << "]++] = n;" << ENDL;
 	}
-	substitute(sCode, tS("$(Isyn)"), tS("Isyn"));
-	substitute(sCode, tS("$(sT)"), tS("lsT"));
-	sCode= ensureFtype(sCode, model.ftype);
-	checkUnreplacedVariables(sCode,tS("neuron simCode"));
+	else { // NO DELAY
+	    os << "[0]++] = n;" << ENDL;
+	}
+	os << CB(30);
 	if (nModels[nt].supportCode != tS("")) {
-	    os << OB(29) << " using namespace " << model.neuronName[i] << "_neuron;" << ENDL;
+	    os << CB(29) << " // namespace bracket closed" << endl;
 	}
-	os << sCode << ENDL;
+    }
+
+    // test for true spikes if condition is provided
+    if (thCode != tS("")) {
+	os << "// test for and register a true spike" << ENDL;
+	if (nModels[nt].supportCode != tS("")) {
+	    os << OB(29) << " using namespace " << names.nspace << ";" << ENDL;	
+	}
+	if (GENN_PREFERENCES::autoRefractory && nModels[nt].needAutoRefractory) {
+	  os << "if ((" << thCode << ") && !(oldSpike))" << OB(40);
+	}
+	else{
+	  os << "if (" << thCode << ") " << OB(40);
+	}
+	os << "glbSpk" << names.suffix << "[" << queueOffsetTrueSpk << "glbSpkCnt" << names.suffix;
+	if ((model.neuronDelaySlots[i] > 1) && (model.neuronNeedTrueSpk[i])) { // WITH DELAY
+	    os << "[spkQuePtr" << model.neuronName[i] << "]++] = n;" << ENDL;
+	}
+	else { // NO DELAY
+	    os << "[0]++] = n;" << ENDL;
+	}
+	if (model.neuronNeedSt[i]) {
+	    os << "sT" << names.suffix << "[" << queueOffset << "n] = t;" << ENDL;
+	}
+
+	// add after-spike reset if provided
+	if (nModels[nt].resetCode != tS("")) {
+	    string rCode = nModels[nt].resetCode;
+	    neuron_table_substitutions(rCode, model, i);
+	    gennrand_substitutions(rCode, i, tS("n"));
+	    substitute(rCode, tS("$(id)"), tS("n"));
+	    substitute(rCode, tS("$(t)"), tS("t"));
+	    name_substitutions(rCode, tS("l"), nModels[nt].varNames, tS(""));
+	    neuronGroupParaSubstitutions(rCode, model, i, names);
+	    substitute(rCode, tS("$(Isyn)"), tS("Isyn"));
+	    substitute(rCode, tS("$(sT)"), tS("lsT"));
+	    os << "// spike reset code" << ENDL;
+	    name_substitutions(rCode, tS(""), nModels[nt].extraGlobalNeuronKernelParameters, model.neuronName[i]);
+	    rCode= optimiseStatements(rCode, model.ftype, floatNames);
+	    rCode= ensureFtype(rCode, model.ftype, model.mathPrecision);
+	    checkUnreplacedVariables(rCode, tS("resetCode"));
+	    os << rCode << ENDL;
+	}
+	os << CB(40);
 	if (nModels[nt].supportCode != tS("")) {
 	    os << CB(29) << " // namespace bracket closed" << endl;
 	}
+    }
 
-	// look for spike type events first.
-	if (model.neuronNeedSpkEvnt[i]) {
-	    string eCode= model.neuronSpkEvntCondition[i];
-	    // code substitutions ----
-	    extended_name_substitutions(eCode, tS("l"), nModels[model.neuronType[i]].varNames, tS("_pre"), tS(""));
-	    substitute(eCode, tS("$(id)"), tS("n"));
-	    substitute(eCode, tS("$(t)"), tS("t"));
-	    name_substitutions(eCode, tS(""), nModels[model.neuronType[i]].extraGlobalNeuronKernelParameters, model.neuronName[i]);
-	    eCode= ensureFtype(eCode, model.ftype);
-	    checkUnreplacedVariables(eCode, tS("neuronSpkEvntCondition"));
-	    // end code substitutions ----
+    // store the defined parts of the neuron state into the global state variables V etc
+    for (int k = 0, l = nModels[nt].varNames.size(); k < l; k++) {
+	if (model.neuronVarNeedQueue[i][k]) {
+	    os << nModels[nt].varNames[k] << names.suffix << "[" << queueOffset << "n] = l" << nModels[nt].varNames[k] << ";" << ENDL;
+	}
+	else {
+	    os << nModels[nt].varNames[k] << names.suffix << "[n] = l" << nModels[nt].varNames[k] << ";" << ENDL;
+	}
+    }
 
-	    os << "// test for and register a spike-like event" << ENDL;
-	    if (nModels[nt].supportCode != tS("")) {
-		os << OB(29) << " using namespace " << model.neuronName[i] << "_neuron;" << ENDL;	
-	    }
-	    os << "if (" + eCode + ")" << OB(30);
-	    os << "glbSpkEvnt" << model.neuronName[i] << "[" << queueOffset << "glbSpkCntEvnt" << model.neuronName[i];
-	    if (model.neuronDelaySlots[i] > 1) { // WITH DELAY
-		os << "[spkQuePtr" << model.neuronName[i] << "]++] = n;" << ENDL;
-	    }
-	    else { // NO DELAY
-		os << "[0]++] = n;" << ENDL;
-	    }
-	    os << CB(30);
-	    if (nModels[nt].supportCode != tS("")) {
-		os << CB(29) << " // namespace bracket closed" << endl;
-	    }
+    for (int j = 0; j < model.inSyn[i].size(); j++) {
+	if (inSynGroup(model, model.inSyn[i][j]) != model.inSyn[i][j]) continue;
+	postSynModel psModel= postSynModels[model.postSynapseType[model.inSyn[i][j]]];
+	string sName= names.inSynSuffix[j];
+	string pdCode = psModel.postSynDecay;
+	substitute(pdCode, tS("$(id)"), tS("n"));
+	substitute(pdCode, tS("$(t)"), tS("t"));
+	substitute(pdCode, tS("$(inSyn)"), tS("inSyn") + sName + tS("[n]"));
+	name_substitutions(pdCode, tS("lps"), psModel.varNames, sName);
+	inSynParaSubstitutions(pdCode, model, i, j, names);
+	name_substitutions(pdCode, tS("l"), nModels[nt].varNames, tS(""));
+	neuronGroupParaSubstitutions(pdCode, model, i, names);
+	os << "// the post-synaptic dynamics" << ENDL;
+	pdCode= optimiseStatements(pdCode, model.ftype, floatNames);
+	pdCode= ensureFtype(pdCode, model.ftype, model.mathPrecision);
+	checkUnreplacedVariables(pdCode, tS("postSynDecay"));
+	if (psModel.supportCode != tS("")) {
+	    os << OB(29) << " using namespace " << names.inSynNspace[j] << ";" << ENDL;	
 	}
+	os << pdCode << ENDL;
+	if (psModel.supportCode != tS("")) {
+	    os << CB(29) << " // namespace bracket closed" << endl;
+	}
+	for (int k = 0, l = psModel.varNames.size(); k < l; k++) {
+	    os << psModel.varNames[k] << sName << "[n]" << " = lps" << psModel.varNames[k] << sName << ";" << ENDL;
+	}
+    }
+}
 
-        // test for true spikes if condition is provided
-	if (thCode != tS("")) {
-	    os << "// test for and register a true spike" << ENDL;
-	    if (nModels[nt].supportCode != tS("")) {
-		os << OB(29) << " using namespace " << model.neuronName[i] << "_neuron;" << ENDL;	
-	    }
-	    if (GENN_PREFERENCES::autoRefractory) {
-	      os << "if ((" << thCode << ") && !(oldSpike))" << OB(40);
-	    }
-	    else{
-	      os << "if (" << thCode << ") " << OB(40);
-	    }
-	    os << "glbSpk" << model.neuronName[i] << "[" << queueOffsetTrueSpk << "glbSpkCnt" << model.neuronName[i];
-	    if ((model.neuronDelaySlots[i] > 1) && (model.neuronNeedTrueSpk[i])) { // WITH DELAY
-		os << "[spkQuePtr" << model.neuronName[i] << "]++] = n;" << ENDL;
-	    }
-	    else { // NO DELAY
-		os << "[0]++] = n;" << ENDL;
-	    }
-	    if (model.neuronNeedSt[i]) {
-		os << "sT" << model.neuronName[i] << "[" << queueOffset << "n] = t;" << ENDL;
-	    }
-
-	    // add after-spike reset if provided
-	    if (nModels[nt].resetCode != tS("")) {
-		string rCode = nModels[nt].resetCode;
-		substitute(rCode, tS("$(id)"), tS("n"));
-		substitute(rCode, tS("$(t)"), tS("t"));
-		name_substitutions(rCode, tS("l"), nModels[nt].varNames, tS(""));
-		value_substitutions(rCode, nModels[nt].pNames, model.neuronPara[i]);
-		value_substitutions(rCode, nModels[nt].dpNames, model.dnp[i]);
-		substitute(rCode, tS("$(Isyn)"), tS("Isyn"));
-		substitute(rCode, tS("$(sT)"), tS("lsT"));
-		os << "// spike reset code" << ENDL;
-		name_substitutions(rCode, tS(""), nModels[nt].extraGlobalNeuronKernelParameters, model.neuronName[i]);
-		rCode= ensureFtype(rCode, model.ftype);
-		checkUnreplacedVariables(rCode, tS("resetCode"));
-		os << rCode << ENDL;
-	    }
-	    os << CB(40);
-	    if (nModels[nt].supportCode != tS("")) {
-		os << CB(29) << " // namespace bracket closed" << endl;
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that generates the code that simulates one time step of the neurons of a neuron group on the CPU, i.e. the body of the function of the group.
+*/
+//--------------------------------------------------------------------------
+
+static void genNeuronGroupCode(ostream &os, //!< output stream for code
+			       NNmodel &model, //!< Model description 
+			       int i, //!< Index of the neuron group
+			       NeuronGroupNames &names //!< Names used in the code
+    )
+{
+    genNeuronQueueUpdate(os, model, i, names);
+    os << "for (int n = 0; n < " <<  names.size << "; n++)" << OB(10);
+    genNeuronCode(os, model, i, names);
+    os << CB(10);
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that determines whether a neuron group of type POISSONNEURON_EVENT is simulated event-driven on the CPU.
+
+  Only the neurons that spike or are reset in a time step are then updated, which needs that no other code runs for every neuron of the group, i.e. that it has no incoming synapses, no spike-like events and no queued variables.
+*/
+//--------------------------------------------------------------------------
+
+static bool isEventDriven(NNmodel &model, //!< Model description
+			  int i //!< Index of the neuron group
+    )
+{
+    if (model.neuronType[i] != POISSONNEURON_EVENT) return false;
+    if (model.inSyn[i].size() > 0) return false;
+    if (model.neuronNeedSpkEvnt[i]) return false;
+    vector<bool> &varNeedQueue= model.neuronVarNeedQueue[i];
+    return (find(varNeedQueue.begin(), varNeedQueue.end(), true) == varNeedQueue.end());
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that generates the event-driven simulation of a neuron group of type POISSONNEURON_EVENT on the CPU.
+
+  The neurons are kept in a timing wheel, a ring of buckets of which the bucket of a time step modulo the ring size holds the neurons whose next spike is due in that step. In each time step, only the neurons in the bucket of the step and the neurons that spiked in the previous step, whose membrane potential is reset, are updated, so that the cost is proportional to the number of spikes rather than to the number of neurons. All neurons are updated when their spikes are rescheduled. The neurons are updated with the code of the neuron model, so that the spikes are those of the update of all neurons.
+*/
+//--------------------------------------------------------------------------
+
+static void genPoissonEventCode(ostream &os, //!< output stream for code
+				NNmodel &model, //!< Model description 
+				int i, //!< Index of the neuron group
+				NeuronGroupNames &names //!< Names used in the code
+    )
+{
+    string name= model.neuronName[i];
+    string wheel= tS("wheel") + name;
+    string slots= tS(poissonWheelSize);
+    string spkCnt= tS("glbSpkCnt") + name + ((model.neuronNeedTrueSpk[i] && (model.neuronDelaySlots[i] > 1)) ? tS("[spkQuePtr") + name + tS("]") : tS("[0]"));
+    string spk= tS("glbSpk") + name + ((model.neuronNeedTrueSpk[i] && (model.neuronDelaySlots[i] > 1)) ? tS(" + spkQuePtr") + name + tS(" * ") + names.size : tS(""));
+
+    genNeuronQueueUpdate(os, model, i, names);
+    os << "if (reschedule" << name << ")" << OB(60);
+    os << "for (int k = 0; k < " << slots << "; k++) " << wheel << "[k].clear();" << ENDL;
+    os << "for (int n = 0; n < " << names.size << "; n++)" << OB(61);
+    genNeuronCode(os, model, i, names);
+    os << "if (nextSpike" << name << "[n] != ~0ULL) " << wheel << "[nextSpike" << name << "[n] % " << slots << "].push_back(n);" << ENDL;
+    os << CB(61);
+    os << CB(60);
+    os << "else" << OB(62);
+    os << "// reset the neurons that spiked in the last time step" << ENDL;
+    os << "for (size_t k = 0; k < lastSpk" << name << ".size(); k++)" << OB(63);
+    os << "int n = lastSpk" << name << "[k];" << ENDL;
+    genNeuronCode(os, model, i, names);
+    os << CB(63);
+    os << "// update the neurons that are due in this time step, keeping those due in a later turn of the wheel" << ENDL;
+    os << "vector<unsigned int> &due = " << wheel << "[iT % " << slots << "];" << ENDL;
+    os << "size_t kept = 0;" << ENDL;
+    os << "for (size_t k = 0; k < due.size(); k++)" << OB(64);
+    os << "int n = due[k];" << ENDL;
+    os << "if (nextSpike" << name << "[n] != iT)" << OB(65);
+    os << "due[kept++] = n;" << ENDL;
+    os << "continue;" << ENDL;
+    os << CB(65);
+    genNeuronCode(os, model, i, names);
+    os << "if (nextSpike" << name << "[n] != ~0ULL) " << wheel << "[nextSpike" << name << "[n] % " << slots << "].push_back(n);" << ENDL;
+    os << CB(64);
+    os << "due.resize(kept);" << ENDL;
+    os << CB(62);
+    os << "lastSpk" << name << ".assign(" << spk << ", " << spk << " + " << spkCnt << ");" << ENDL;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that determines whether a neuron group could be merged with other groups at all.
+
+  Groups with delayed spikes, runtime parameters or extra global parameters refer to variables of their own that cannot be bound to local names, and the lookup tables of tabulated functions hold the parameter values of their own group.
+*/
+//--------------------------------------------------------------------------
+
+static bool isMergeable(NNmodel &model, //!< Model description
+			int i //!< Index of the neuron group
+    )
+{
+    unsigned int nt= model.neuronType[i];
+    if (model.neuronDelaySlots[i] > 1) return false;
+    if (nModels[nt].extraGlobalNeuronKernelParameters.size() > 0) return false;
+    if (nModels[nt].tableNames.size() > 0) return false;
+    if (nModels[nt].needsGennrand()) return false;
+    if (model.runtimeNeuronParaNames(i).size() > 0) return false;
+    for (int j = 0; j < model.inSyn[i].size(); j++) {
+	if (model.runtimePostSynapseParaNames(model.inSyn[i][j]).size() > 0) return false;
+    }
+    return true;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that partitions the neuron groups into sets whose CPU code is generated as one function.
+
+  Groups are merged if they run on the same host and NUMA node and their code is identical up to their names, sizes and parameter values, which is tested by generating their code with all parameters looked up. The sets are ordered by their first group; groups that cannot be merged form sets of their own. Merging is switched off with GENN_PREFERENCES::mergeNeuronGroups.
+*/
+//--------------------------------------------------------------------------
+
+vector<vector<unsigned int> > mergeNeuronGroups(NNmodel &model //!< Model description
+    )
+{
+    vector<vector<unsigned int> > sets;
+    vector<string> codes;
+    for (int i = 0; i < model.neuronGrpN; i++) {
+	string code;
+	if (GENN_PREFERENCES::mergeNeuronGroups && isMergeable(model, i)) {
+	    vector<unsigned int> single(1, i);
+	    NeuronGroupNames names= mergedGroupNames(model, single);
+	    names.nspace= tS("neuron");
+	    names.paraSymbolic.assign(names.paraSymbolic.size(), true);
+	    for (int j = 0; j < names.inSynParaSymbolic.size(); j++) {
+		unsigned int synPopID= model.inSyn[i][j];
+		names.inSynNspace[j]= tS("postsyn") + tS(model.postSynapseType[synPopID]) + tS("_") + tS(model.synapseGType[synPopID]);
+		names.inSynParaSymbolic[j].assign(names.inSynParaSymbolic[j].size(), true);
 	    }
+	    ostringstream os;
+	    genNeuronGroupCode(os, model, i, names);
+	    code= tS(model.neuronType[i]) + tS(" ") + tS(neuronCPUNode(model, i)) + tS(" ") + tS(model.neuronHostID[i]) + ENDL + os.str();
+	}
+	unsigned int k;
+	for (k = 0; k < sets.size(); k++) {
+	    if ((code != tS("")) && (codes[k] == code)) break;
+	}
+	if (k < sets.size()) {
+	    sets[k].push_back(i);
+	}
+	else {
+	    sets.push_back(vector<unsigned int>(1, i));
+	    codes.push_back(code);
 	}
+    }
+    return sets;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that generates the file neuronFnct_<group name>.cc with the function that simulates the neurons of one neuron group, or of a set of merged neuron groups, on the CPU.
 
-	// store the defined parts of the neuron state into the global state variables V etc
-	for (int k = 0, l = nModels[nt].varNames.size(); k < l; k++) {
-	    if (model.neuronVarNeedQueue[i][k]) {
-		os << nModels[nt].varNames[k] << model.neuronName[i] << "[" << queueOffset << "n] = l" << nModels[nt].varNames[k] << ";" << ENDL;
+  The function of merged groups loops over the groups and binds the local names used by the code to the arrays, size and differing parameter values of each group, which are kept in tables.
+*/
+//--------------------------------------------------------------------------
+
+static void genNeuronGroupFunction(NNmodel &model, //!< Model description 
+				   string &path, //!< Path for code generation
+				   vector<unsigned int> &groups //!< Indices of the neuron groups simulated by the function
+    )
+{
+    string name;
+    unsigned int i= groups[0];
+    unsigned int nt= model.neuronType[i];
+    GeneratedFile os;
+
+    name = path + toString("/") + model.name + toString("_CODE/neuronFnct_") + model.neuronName[i] + toString(".cc");
+    os.open(name.c_str());
+    if (groups.size() > 1) {
+	string brief= tS("containing the CPU-only equivalent of the neuron kernel for the merged neuron groups");
+	for (int k= 0; k < groups.size(); k++) {
+	    brief+= tS(" ") + model.neuronName[groups[k]];
+	}
+	genCPUFileHeader(os, model, tS("neuronFnct_") + model.neuronName[i] + tS(".cc"), brief + tS("."));
+    }
+    else {
+	genCPUFileHeader(os, model, tS("neuronFnct_") + model.neuronName[i] + tS(".cc"), tS("containing the CPU-only equivalent of the neuron kernel for neuron group ") + model.neuronName[i] + tS("."));
+    }
+
+    // support code of the neuron model and of the incoming postsynaptic models
+    genSupportCodeNamespace(os, model.neuronName[i] + tS("_neuron"), nModels[nt].supportCode);
+    for (int j = 0; j < model.inSyn[i].size(); j++) {
+	unsigned int synPopID= model.inSyn[i][j];
+	genSupportCodeNamespace(os, model.synapseName[synPopID] + tS("_postsyn"), postSynModels[model.postSynapseType[synPopID]].supportCode);
+    }
+
+    // lookup tables of tabulated functions of the neuron model
+    os << neuron_tables_code(model, i, tS("static "), true);
+
+    if (groups.size() == 1) {
+	NeuronGroupNames names= singleGroupNames(model, i);
+	bool eventDriven= isEventDriven(model, i);
+	if (eventDriven) {
+	    os << "#include <vector>" << ENDL;
+	    os << ENDL;
+	    os << "// timing wheel of the event-driven Poisson neurons and the neurons that spiked in the last time step" << ENDL;
+	    os << "static vector<unsigned int> wheel" << model.neuronName[i] << "[" << poissonWheelSize << "];" << ENDL;
+	    os << "static vector<unsigned int> lastSpk" << model.neuronName[i] << ";" << ENDL;
+	    os << ENDL;
+	}
+	genCPUFunctionHead(os, model, tS("calcNeuronsCPU") + model.neuronName[i]);
+	os << OB(51);
+	if (eventDriven) {
+	    genPoissonEventCode(os, model, i, names);
+	}
+	else {
+	    genNeuronGroupCode(os, model, i, names);
+	}
+	os << CB(51) << ENDL;
+	genCPUFunctionVersions(os, model, tS("calcNeuronsCPU") + model.neuronName[i]);
+	os.close();
+	return;
+    }
+
+    // tables of the arrays, sizes and differing parameters of the merged groups
+    NeuronGroupNames names= mergedGroupNames(model, groups);
+    unsigned int n= groups.size();
+    vector<string> tableTypes, tableNames, localNames;
+    vector<vector<string> > tableEntries;
+    vector<string> entries;
+    tableTypes.push_back(tS("const unsigned int"));
+    localNames.push_back(names.size);
+    for (int k= 0; k < n; k++) entries.push_back(tS(model.neuronN[groups[k]]));
+    tableEntries.push_back(entries);
+    vector<string> ptrTypes, ptrNames;
+    ptrTypes.push_back(tS("unsigned int"));
+    ptrNames.push_back(tS("glbSpkCnt"));
+    ptrTypes.push_back(tS("unsigned int"));
+    ptrNames.push_back(tS("glbSpk"));
+    if (model.neuronNeedSpkEvnt[i]) {
+	ptrTypes.push_back(tS("unsigned int"));
+	ptrNames.push_back(tS("glbSpkCntEvnt"));
+	ptrTypes.push_back(tS("unsigned int"));
+	ptrNames.push_back(tS("glbSpkEvnt"));
+    }
+    if (model.neuronNeedSt[i]) {
+	ptrTypes.push_back(model.ftype);
+	ptrNames.push_back(tS("sT"));
+    }
+    for (int k = 0; k < nModels[nt].varNames.size(); k++) {
+	ptrTypes.push_back(nModels[nt].varTypes[k]);
+	ptrNames.push_back(nModels[nt].varNames[k]);
+    }
+    for (int p= 0; p < ptrNames.size(); p++) {
+	tableTypes.push_back(ptrTypes[p] + tS(" ** const"));
+	localNames.push_back(ptrNames[p] + names.suffix);
+	entries.clear();
+	for (int k= 0; k < n; k++) entries.push_back(tS("&") + ptrNames[p] + model.neuronName[groups[k]]);
+	tableEntries.push_back(entries);
+    }
+    for (int j = 0; j < model.inSyn[i].size(); j++) {
+	unsigned int synPopID= model.inSyn[i][j];
+	postSynModel &psm= postSynModels[model.postSynapseType[synPopID]];
+	ptrTypes.clear();
+	ptrNames.clear();
+	ptrTypes.push_back(model.ftype);
+	ptrNames.push_back(tS("inSyn"));
+	if (model.synapseGType[synPopID] == INDIVIDUALG) {
+	    for (int k = 0, l = psm.varNames.size(); k < l; k++) {
+		ptrTypes.push_back(psm.varTypes[k]);
+		ptrNames.push_back(psm.varNames[k]);
 	    }
-	    else {
-		os << nModels[nt].varNames[k] << model.neuronName[i] << "[n] = l" << nModels[nt].varNames[k] << ";" << ENDL;
-	    }
-	}
-
-	for (int j = 0; j < model.inSyn[i].size(); j++) {
-	    postSynModel psModel= postSynModels[model.postSynapseType[model.inSyn[i][j]]];
-	    string sName= model.synapseName[model.inSyn[i][j]];
-	    string pdCode = psModel.postSynDecay;
-	    substitute(pdCode, tS("$(id)"), tS("n"));
-	    substitute(pdCode, tS("$(t)"), tS("t"));
-	    substitute(pdCode, tS("$(inSyn)"), tS("inSyn") + sName + tS("[n]"));
-	    name_substitutions(pdCode, tS("lps"), psModel.varNames, sName);
-	    value_substitutions(pdCode, psModel.pNames, model.postSynapsePara[model.inSyn[i][j]]);
-	    value_substitutions(pdCode, psModel.dpNames, model.dpsp[model.inSyn[i][j]]);
-	    name_substitutions(pdCode, tS("l"), nModels[nt].varNames, tS(""));
-	    value_substitutions(pdCode, nModels[nt].pNames, model.neuronPara[i]);
-	    value_substitutions(pdCode, nModels[nt].dpNames, model.dnp[i]);
-	    os << "// the post-synaptic dynamics" << ENDL;
-	    pdCode= ensureFtype(pdCode, model.ftype);
-	    checkUnreplacedVariables(pdCode, tS("postSynDecay"));
-	    if (psModel.supportCode != tS("")) {
-		os << OB(29) << " using namespace " << sName << "_postsyn;" << ENDL;	
-	    }
-	    os << pdCode << ENDL;
-	    if (psModel.supportCode != tS("")) {
-		os << CB(29) << " // namespace bracket closed" << endl;
+	}
+	for (int p= 0; p < ptrNames.size(); p++) {
+	    tableTypes.push_back(ptrTypes[p] + tS(" ** const"));
+	    localNames.push_back(ptrNames[p] + names.inSynSuffix[j]);
+	    entries.clear();
+	    for (int k= 0; k < n; k++) entries.push_back(tS("&") + ptrNames[p] + model.synapseName[model.inSyn[groups[k]][j]]);
+	    tableEntries.push_back(entries);
+	}
+    }
+    vector<string> pNames= nModels[nt].pNames;
+    pNames.insert(pNames.end(), nModels[nt].dpNames.begin(), nModels[nt].dpNames.end());
+    for (int p= 0; p < pNames.size(); p++) {
+	if (!names.paraSymbolic[p]) continue;
+	tableTypes.push_back(tS("const ") + model.ftype);
+	localNames.push_back(pNames[p] + names.suffix);
+	entries.clear();
+	for (int k= 0; k < n; k++) {
+	    unsigned int g= groups[k];
+	    double value= (p < model.neuronPara[g].size() ? model.neuronPara[g][p] : model.dnp[g][p - model.neuronPara[g].size()]);
+	    entries.push_back(model.scalarExpr(value));
+	}
+	tableEntries.push_back(entries);
+    }
+    for (int j = 0; j < model.inSyn[i].size(); j++) {
+	postSynModel &psm= postSynModels[model.postSynapseType[model.inSyn[i][j]]];
+	pNames= psm.pNames;
+	pNames.insert(pNames.end(), psm.dpNames.begin(), psm.dpNames.end());
+	for (int p= 0; p < pNames.size(); p++) {
+	    if (!names.inSynParaSymbolic[j][p]) continue;
+	    tableTypes.push_back(tS("const ") + model.ftype);
+	    localNames.push_back(pNames[p] + names.inSynSuffix[j]);
+	    entries.clear();
+	    for (int k= 0; k < n; k++) {
+		unsigned int synPopID= model.inSyn[groups[k]][j];
+		double value= (p < model.postSynapsePara[synPopID].size() ? model.postSynapsePara[synPopID][p] : model.dpsp[synPopID][p - model.postSynapsePara[synPopID].size()]);
+		entries.push_back(model.scalarExpr(value));
 	    }
-	    for (int k = 0, l = psModel.varNames.size(); k < l; k++) {
-		os << psModel.varNames[k] << sName << "[n]" << " = lps" << psModel.varNames[k] << sName << ";" << ENDL;
+	    tableEntries.push_back(entries);
+	}
+    }
+    os << "namespace" << OB(13);
+    for (int p= 0; p < localNames.size(); p++) {
+	os << tableTypes[p] << " merged" << localNames[p] << "[" << n << "]= {";
+	for (int k= 0; k < n; k++) {
+	    os << (k > 0 ? ", " : "") << tableEntries[p][k];
+	}
+	os << "};" << ENDL;
+    }
+    os << CB(13) << ENDL;
+
+    // function header
+    genCPUFunctionHead(os, model, tS("calcNeuronsCPU") + model.neuronName[i]);
+    os << OB(51);
+    os << "for (unsigned int g = 0; g < " << n << "; g++)" << OB(52);
+    for (int p= 0; p < localNames.size(); p++) {
+	string type= tableTypes[p];
+	if (type.find(" ** const") != string::npos) {
+	    os << type.substr(0, type.find(" ** const")) << " *" << localNames[p] << " = *merged" << localNames[p] << "[g];" << ENDL;
+	}
+	else {
+	    os << type << " " << localNames[p] << " = merged" << localNames[p] << "[g];" << ENDL;
+	}
+    }
+    genNeuronGroupCode(os, model, i, names);
+    os << CB(52);
+    os << CB(51) << ENDL;
+    genCPUFunctionVersions(os, model, tS("calcNeuronsCPU") + model.neuronName[i]);
+    os.close();
+} 
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that generates the code of the function the will simulate all neurons on the CPU.
+
+  Each neuron group, or set of merged neuron groups, is simulated by a function in its own file neuronFnct_<group name>.cc, which is named after the first group of the set. The groups can therefore be compiled in parallel and only changed groups are recompiled. The file neuronFnct.cc calls these functions in the order of the neuron groups, on the thread of their NUMA node if the model runs on several nodes.
+*/
+//--------------------------------------------------------------------------
+
+void genNeuronFunction(NNmodel &model, //!< Model description 
+		       string &path //!< Path for code generation
+    )
+{
+    string name;
+    GeneratedFile os;
+
+    for (int i = 0; i < model.neuronGrpN; i++) {
+	if (nModels[model.neuronType[i]].thresholdConditionCode == tS("")) {
+	    cerr << "Warning: No thresholdConditionCode for neuron type " << model.neuronType[i] << " used for population \"" << model.neuronName[i] << "\" was provided. There will be no spikes detected in this population!" << endl;
+	}
+    }
+    vector<vector<unsigned int> > sets= mergeNeuronGroups(model);
+    for (int k = 0; k < sets.size(); k++) {
+	genNeuronGroupFunction(model, path, sets[k]);
+    }
+
+    name = path + toString("/") + model.name + toString("_CODE/neuronFnct.cc");
+    os.open(name.c_str());
+    genCPUFileHeader(os, model, tS("neuronFnct.cc"), tS("containing the the equivalent of neuron kernel function for the CPU-only version."));
+    if (cpuNodes(model).size() > 1) {
+	os << "#include \"numaUtils.h\"" << ENDL;
+	os << ENDL;
+    }
+
+    // functions of the individual neuron groups
+    for (int k = 0; k < sets.size(); k++) {
+	os << "void calcNeuronsCPU" << model.neuronName[sets[k][0]] << "(" << model.ftype << " t);" << ENDL;
+    }
+    os << ENDL;
+
+    // function calling them
+    vector<string> calls;
+    vector<unsigned int> callNodes;
+    vector<int> callHosts;
+    vector<string> remoteCode;
+    for (int k = 0; k < sets.size(); k++) {
+	calls.push_back(tS("calcNeuronsCPU") + model.neuronName[sets[k][0]]);
+	callNodes.push_back(neuronCPUNode(model, sets[k][0]));
+	callHosts.push_back(model.neuronHostID[sets[k][0]]);
+	// the spike queues of groups on other hosts move on with the time steps, so that exchanged spikes are put into the right slots
+	string remote;
+	for (int j = 0; j < sets[k].size(); j++) {
+	    unsigned int i= sets[k][j];
+	    if (model.neuronDelaySlots[i] > 1) {
+		remote+= "spkQuePtr" + model.neuronName[i] + " = (spkQuePtr" + model.neuronName[i] + " + 1) % " + tS(model.neuronDelaySlots[i]) + ";";
 	    }
 	}
-	os << CB(10);
-	os << CB(55);
-	os << ENDL;
+	remoteCode.push_back(remote);
     }
-    os << CB(51) << ENDL;
-    os << "#endif" << ENDL;
+    genCPUDispatch(os, model, tS("calcNeuronsCPU"), calls, callNodes, callHosts, remoteCode);
     os.close();
 } 
 
 
+//-------------------------------------------------------------------------
+/*!
+  \brief Function that returns the floating point names the presynaptic terms of the code of a synapse group can be made of, which are hoisted out of the loops over its synapses.
+*/
+//-------------------------------------------------------------------------
+
+static vector<string> presynapticFloatNames(NNmodel &model, //!< Model description
+					    int i //!< Index of the synapse group
+    )
+{
+    unsigned int src= model.synapseSource[i];
+    unsigned int nt_pre= model.neuronType[src];
+    vector<string> floatNames;
+    floatNames.push_back(tS("t"));
+    floatNames.push_back(tS("DT"));
+    floatNames.push_back(tS("sT") + model.neuronName[src]);
+    for (int k = 0, l = nModels[nt_pre].varNames.size(); k < l; k++) {
+	const string &type= nModels[nt_pre].varTypes[k];
+	if ((type == tS("scalar")) || (type == model.ftype)) {
+	    floatNames.push_back(nModels[nt_pre].varNames[k] + model.neuronName[src]);
+	}
+    }
+    vector<string> names= model.runtimeNeuronParaNames(src);
+    for (int k = 0; k < names.size(); k++) {
+	floatNames.push_back(names[k] + model.neuronName[src]);
+    }
+    names= model.runtimeSynapseParaNames(i);
+    for (int k = 0; k < names.size(); k++) {
+	floatNames.push_back(names[k] + model.synapseName[i]);
+    }
+    return floatNames;
+}
+
+
 //-------------------------------------------------------------------------
 /*!
   \brief Function for generating the CUDA synapse kernel code that handles presynaptic 
@@ -375,59 +1328,20 @@ void generate_process_presynaptic_events_code_CPU(
 	bool delayPost = model.neuronDelaySlots[trg] > 1;
 	string offsetPost = (delayPost ? "(spkQuePtr" + model.neuronName[trg] + " * " + tS(model.neuronN[trg]) + ") + " : "");
 
-	// Detect spike events or spikes and do the update
-	os << "// process presynaptic events: " << (evnt ? "Spike type events" : "True Spikes") << ENDL;
-	if (delayPre) {
-	    os << "for (int i = 0; i < glbSpkCnt" << postfix << model.neuronName[src] << "[delaySlot]; i++)" << OB(201);
-	}
-	else {
-	    os << "for (int i = 0; i < glbSpkCnt" << postfix << model.neuronName[src] << "[0]; i++)" << OB(201);
-	}
-
-	os << "ipre = glbSpk" << postfix << model.neuronName[src] << "[" << offsetPre << "i];" << ENDL;
-
-	if (sparse) { // SPARSE
-	    os << "npost = C" << model.synapseName[i] << ".indInG[ipre + 1] - C" << model.synapseName[i] << ".indInG[ipre];" << ENDL;
-	    os << "for (int j = 0; j < npost; j++)" << OB(202);
-	    os << "ipost = C" << model.synapseName[i] << ".ind[C" << model.synapseName[i] << ".indInG[ipre] + j];" << ENDL;
-	}
-	else { // DENSE
-	    os << "for (ipost = 0; ipost < " << model.neuronN[trg] << "; ipost++)" << OB(202);
-	}
-
-	if (model.synapseGType[i] == INDIVIDUALID) {
-	    os << "unsigned int gid = (ipre * " << model.neuronN[i] << " + ipost);" << ENDL;
-	}
-
-	if (weightUpdateModels[synt].simCode_supportCode != tS("")) {
-	    os << OB(29) << " using namespace " << model.synapseName[i] << "_weightupdate_simCode;" << ENDL;	
-	}
-	if (evnt) { 
-	    // code substitutions ----
-	    string eCode = weightUpdateModels[synt].evntThreshold;
+	// Code substitutions ----------------------------------------------------------------------------------
+	string eCode;
+	if (evnt) {
+	    eCode = weightUpdateModels[synt].evntThreshold;
 	    substitute(eCode, tS("$(id)"), tS("n"));
 	    substitute(eCode, tS("$(t)"), tS("t"));
-	    value_substitutions(eCode, weightUpdateModels[synt].pNames, model.synapsePara[i]);
-	    value_substitutions(eCode, weightUpdateModels[synt].dpNames, model.dsp_w[i]);
+	    synapse_para_substitutions(eCode, model, i);
 	    name_substitutions(eCode, tS(""), weightUpdateModels[synt].extraGlobalSynapseKernelParameters, model.synapseName[i]);
 	    neuron_substitutions_in_synaptic_code(eCode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("ipre"), tS("ipost"), tS(""));	
-	    eCode= ensureFtype(eCode, model.ftype);
+	    eCode= optimiseExpression(eCode);
+	    eCode= ensureFtype(eCode, model.ftype, model.mathPrecision);
 	    checkUnreplacedVariables(eCode, tS("evntThreshold"));
-	    // end code substitutions ----
-
-	    if (model.synapseGType[i] == INDIVIDUALID) {
-		os << "if ((B(gp" << model.synapseName[i] << "[gid >> " << logUIntSz << "], gid & " << UIntSz - 1;
-		os << ")) && (" << eCode << "))" << OB(2041);
-	    }
-	    else {
-		os << "if (" << eCode << ")" << OB(2041);
-	    }
-	}
-	else if (model.synapseGType[i] == INDIVIDUALID) {
-	    os << "if (B(gp" << model.synapseName[i] << "[gid >> " << logUIntSz << "], gid & " << UIntSz - 1 << "))" << OB(2041);
 	}
 
-	// Code substitutions ----------------------------------------------------------------------------------
 	string wCode = (evnt ? weightUpdateModels[synt].simCodeEvnt : weightUpdateModels[synt].simCode);
 	substitute(wCode, tS("$(updatelinsyn)"), tS("$(inSyn) += $(addtoinSyn)"));
 	substitute(wCode, tS("$(t)"), tS("t"));
@@ -448,313 +1362,641 @@ void generate_process_presynaptic_events_code_CPU(
 	    }      
 	}
 	substitute(wCode, tS("$(inSyn)"), tS("inSyn") + model.synapseName[i] + tS("[ipost]"));
-	value_substitutions(wCode, weightUpdateModels[synt].pNames, model.synapsePara[i]);
-	value_substitutions(wCode, weightUpdateModels[synt].dpNames, model.dsp_w[i]);
+	synapse_para_substitutions(wCode, model, i);
 	name_substitutions(wCode, tS(""), weightUpdateModels[synt].extraGlobalSynapseKernelParameters, model.synapseName[i]);
 	substitute(wCode, tS("$(addtoinSyn)"), tS("addtoinSyn"));
 	neuron_substitutions_in_synaptic_code(wCode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("ipre"), tS("ipost"), tS(""));	
-	wCode= ensureFtype(wCode, model.ftype);
+	wCode= optimiseStatements(wCode, model.ftype, synapseFloatNames(model, i));
+
+	// the code for pulling the spikes into the targets, which finds the synapses through the reverse connectivity
+	string synapseElement= model.synapseName[i] + tS("[C") + model.synapseName[i] + tS(".indInG[ipre] + j]");
+	string pullCode= wCode;
+	substitute(pullCode, synapseElement, model.synapseName[i] + tS("[C") + model.synapseName[i] + tS(".remap[l]]"));
+	bool pull= pullsSpikes(model, i) && (pullCode.find(tS(".indInG[ipre] + j")) == string::npos);
+	pullCode= ensureFtype(pullCode, model.ftype, model.mathPrecision);
+
+	// the terms that only depend on the presynaptic neuron are computed once per spike rather than per synapse
+	vector<string> variant, floatNames= presynapticFloatNames(model, i);
+	variant.push_back(tS("ipost"));
+	variant.push_back(tS("j"));
+	variant.push_back(tS("gid"));
+	bool retest= evnt && model.needEvntThresholdReTest[i];
+	bool eCodePre= retest && GENN_PREFERENCES::optimiseSnippets && isLoopInvariant(eCode, variant);
+	string preCode;
+	wCode= hoistLoopInvariant(wCode, variant, floatNames, model.ftype, preCode);
+	wCode= ensureFtype(wCode, model.ftype, model.mathPrecision);
 	checkUnreplacedVariables(wCode, tS("simCode")+postfix);
+	preCode= ensureFtype(preCode, model.ftype, model.mathPrecision);
 	// end Code substitutions ------------------------------------------------------------------------- 
-	os << wCode << ENDL;
 
-	if (evnt) {
-	    os << CB(2041); // end if (eCode)
+	// Detect spike events or spikes and do the update
+	string spkCnt= tS("glbSpkCnt") + postfix + model.neuronName[src] + (delayPre ? tS("[delaySlot]") : tS("[0]"));
+	string inSyn= tS("inSyn") + model.synapseName[i] + tS("[ipost]");
+	string body, value;
+	vector<string> locals(1, tS("addtoinSyn"));
+	bool additive= splitAccumulation(wCode, inSyn, locals, body, value);
+	bool eCodePost= retest && !eCodePre;
+	bool many= sparse && GENN_PREFERENCES::bucketSparseSynapses;
+	bool bucketed= many && additive;
+	bool tiled= !sparse && GENN_PREFERENCES::tileDenseSynapses && additive && !eCodePost && (model.synapseGType[i] != INDIVIDUALID);
+	unsigned int bucketShift= (theSize(model.ftype) > 4) ? 9 : 10; // buckets of at least 4 kB of postsynaptic input ...
+	while ((model.neuronN[trg] >> bucketShift) >= 512) bucketShift++; // ... but not so many that sorting into them thrashes the cache
+	unsigned int buckets= (model.neuronN[trg] >> bucketShift) + 1;
+	string targetSize= tS(model.neuronN[trg]) + tS(" * sizeof(") + model.ftype + tS(")");
+	os << "// process presynaptic events: " << (evnt ? "Spike type events" : "True Spikes") << ENDL;
+
+	// if many presynaptic neurons spike, the targets gather the inputs of their spiking presynaptic neurons
+	if (pull) {
+	    os << "if (" << spkCnt << " > pullThreshold" << model.synapseName[i] << ")" << OB(220);
+	    os << "pullSteps" << model.synapseName[i] << "++;" << ENDL;
+	    os << "static std::vector<uint32_t> spiking(" << (model.neuronN[src] + 31) / 32 << ");" << ENDL;
+	    os << "std::fill(spiking.begin(), spiking.end(), 0);" << ENDL;
+	    os << "for (int i = 0; i < " << spkCnt << "; i++)" << OB(221);
+	    os << "ipre = glbSpk" << postfix << model.neuronName[src] << "[" << offsetPre << "i];" << ENDL;
+	    os << "spiking[ipre >> 5] |= 1u << (ipre & 31);" << ENDL;
+	    os << CB(221);
+	    os << "for (ipost = 0; ipost < " << model.neuronN[trg] << "; ipost++)" << OB(222);
+	    os << "for (unsigned int l = C" << model.synapseName[i] << ".revIndInG[ipost]; l < C" << model.synapseName[i] << ".revIndInG[ipost + 1]; l++)" << OB(223);
+	    os << "ipre = C" << model.synapseName[i] << ".revInd[l];" << ENDL;
+	    os << "if (!(spiking[ipre >> 5] & (1u << (ipre & 31)))) continue;" << ENDL;
+	    if (weightUpdateModels[synt].simCode_supportCode != tS("")) {
+		os << OB(29) << " using namespace " << model.synapseName[i] << "_weightupdate_simCode;" << ENDL;	
+	    }
+	    if (retest) {
+		os << "if (" << eCode << ")" << OB(2041);
+	    }
+	    os << pullCode << ENDL;
+	    if (retest) {
+		os << CB(2041);
+	    }
+	    if (weightUpdateModels[synt].simCode_supportCode != tS("")) {
+		os << CB(29) << " // namespace bracket closed" << ENDL;
+	    }
+	    os << CB(223);
+	    os << CB(222);
+	    os << CB(220);
+	    os << "else" << OB(224);
+	    os << "pushSteps" << model.synapseName[i] << "++;" << ENDL;
 	}
-	else if (model.synapseGType[i] == INDIVIDUALID) {
-	    os << CB(2041); // end if (B(gp" << model.synapseName[i] << "[gid >> " << logUIntSz << "], gid 
+
+	// dense additive synapses: the rows of the weight matrix are added tile by tile of postsynaptic neurons
+	if (tiled) {
+	    unsigned int tile= 16384 / theSize(model.ftype); // 16 kB of postsynaptic input; smaller tiles cut the rows into pieces too short for the hardware prefetcher
+	    unsigned int tiles= model.neuronN[trg] / tile;
+	    unsigned int rest= model.neuronN[trg] % tile;
+	    os << "// the rows of the spiking neurons are added to tiles of the postsynaptic input, which stay in the L1 cache; the" << ENDL;
+	    os << "// loops over a tile have a fixed length, so that they vectorize" << ENDL;
+	    for (int r= 0; r < 2; r++) {
+		unsigned int length= (r == 0) ? tile : rest;
+		if ((length == 0) || ((r == 0) && (tiles == 0))) continue;
+		unsigned int start= (r == 0) ? 0 : tiles * tile;
+		os << "for (unsigned int tile = " << start << "; tile < " << start + ((r == 0) ? tiles * tile : rest) << "; tile += " << length << ")" << OB(210);
+		os << model.ftype << " acc[" << length << "];" << ENDL;
+		os << "for (int k = 0; k < " << length << "; k++) acc[k] = inSyn" << model.synapseName[i] << "[tile + k];" << ENDL;
+		os << "for (int i = 0; i < " << spkCnt << "; i++)" << OB(211);
+		os << "ipre = glbSpk" << postfix << model.neuronName[src] << "[" << offsetPre << "i];" << ENDL;
+		if (eCodePre) {
+		    os << "if (!(" << eCode << ")) continue;" << ENDL;
+		}
+		for (size_t p= 0, e; p < preCode.size(); p= e+1) {
+		    e= preCode.find('\n', p);
+		    os << preCode.substr(p, e-p) << ENDL;
+		}
+		os << "for (int k = 0; k < " << length << "; k++)" << OB(212);
+		os << "ipost = tile + k;" << ENDL;
+		for (size_t p= 0, e; p < body.size(); p= e+1) {
+		    e= body.find('\n', p);
+		    os << body.substr(p, e-p) << ENDL;
+		}
+		os << "acc[k] += " << value << ";" << ENDL;
+		os << CB(212);
+		os << CB(211);
+		os << "for (int k = 0; k < " << length << "; k++) inSyn" << model.synapseName[i] << "[tile + k] = acc[k];" << ENDL;
+		os << CB(210);
+	    }
 	}
-	if (weightUpdateModels[synt].simCode_supportCode != tS("")) {
-	    os << CB(29) << " // namespace bracket closed" << ENDL;
+
+	// otherwise the spike loop is generated in up to three variants: with the inputs sorted into buckets of targets
+	// (2), with prefetching (1) and plain (0)
+	for (int v= (tiled ? -1 : (bucketed ? 2 : (many ? 1 : 0))); v >= 0; v--) {
+	    if (many && (v == 0)) {
+		os << "else" << OB(206);
+	    }
+	    if (many && (v == (bucketed ? 2 : 1))) {
+		os << "// if the synapses of the spikes of this time step and their targets do not fit into the L2 cache, the rows of" << ENDL;
+		os << "// later spikes and the targets of later synapses are prefetched" << ENDL;
+		os << "if ((" << targetSize << " > genn_L2CacheSize) && ((size_t) " << spkCnt;
+		os << " * C" << model.synapseName[i] << ".connN / " << model.neuronN[src] << " * sizeof(" << model.ftype << ") > genn_L2CacheSize))" << OB(203);
+	    }
+	    if (v == 2) {
+		os << "// if the targets do not even fit into the last level cache, the inputs are sorted into buckets of targets" << ENDL;
+		os << "// instead, which are added one after the other" << ENDL;
+		os << "if (" << targetSize << " > genn_LLCacheSize)" << OB(204);
+		os << "static std::vector<unsigned int> bucketPost, bucketPostSorted, bucketStart(" << buckets + 1 << ");" << ENDL;
+		os << "static std::vector<" << model.ftype << "> bucketValue, bucketValueSorted;" << ENDL;
+		os << "if (bucketPost.size() < C" << model.synapseName[i] << ".connN)" << OB(205);
+		os << "bucketPost.resize(C" << model.synapseName[i] << ".connN);" << ENDL;
+		os << "bucketPostSorted.resize(C" << model.synapseName[i] << ".connN);" << ENDL;
+		os << "bucketValue.resize(C" << model.synapseName[i] << ".connN);" << ENDL;
+		os << "bucketValueSorted.resize(C" << model.synapseName[i] << ".connN);" << ENDL;
+		os << CB(205);
+		os << "size_t nBucketed= 0;" << ENDL;
+		os << "std::fill(bucketStart.begin(), bucketStart.end(), 0);" << ENDL;
+	    }
+	    if (bucketed && (v == 1)) {
+		os << "else" << OB(207);
+	    }
+
+	    os << "for (int i = 0; i < " << spkCnt << "; i++)" << OB(201);
+	    os << "ipre = glbSpk" << postfix << model.neuronName[src] << "[" << offsetPre << "i];" << ENDL;
+	    if (v > 0) {
+		os << "if (i + 8 < " << spkCnt << ") GENN_PREFETCH(&C" << model.synapseName[i] << ".ind[C" << model.synapseName[i];
+		os << ".indInG[glbSpk" << postfix << model.neuronName[src] << "[" << offsetPre << "i + 8]]]);" << ENDL;
+	    }
+	    if (eCodePre) {
+		os << "if (!(" << eCode << ")) continue;" << ENDL;
+	    }
+	    for (size_t p= 0, e; p < preCode.size(); p= e+1) {
+		e= preCode.find('\n', p);
+		os << preCode.substr(p, e-p) << ENDL;
+	    }
+
+	    if (sparse) { // SPARSE
+		os << "npost = C" << model.synapseName[i] << ".indInG[ipre + 1] - C" << model.synapseName[i] << ".indInG[ipre];" << ENDL;
+		os << "for (int j = 0; j < npost; j++)" << OB(202);
+		os << "ipost = C" << model.synapseName[i] << ".ind[C" << model.synapseName[i] << ".indInG[ipre] + j];" << ENDL;
+		if (v == 1) {
+		    os << "if (j + 16 < npost) GENN_PREFETCH(&inSyn" << model.synapseName[i] << "[C" << model.synapseName[i];
+		    os << ".ind[C" << model.synapseName[i] << ".indInG[ipre] + j + 16]]);" << ENDL;
+		}
+	    }
+	    else { // DENSE
+		os << "for (ipost = 0; ipost < " << model.neuronN[trg] << "; ipost++)" << OB(202);
+	    }
+
+	    if (model.synapseGType[i] == INDIVIDUALID) {
+		os << "unsigned int gid = (ipre * " << model.neuronN[i] << " + ipost);" << ENDL;
+	    }
+
+	    if (weightUpdateModels[synt].simCode_supportCode != tS("")) {
+		os << OB(29) << " using namespace " << model.synapseName[i] << "_weightupdate_simCode;" << ENDL;	
+	    }
+	    if (eCodePost) { 
+		if (model.synapseGType[i] == INDIVIDUALID) {
+		    os << "if ((B(gp" << model.synapseName[i] << "[gid >> " << logUIntSz << "], gid & " << UIntSz - 1;
+		    os << ")) && (" << eCode << "))" << OB(2041);
+		}
+		else {
+		    os << "if (" << eCode << ")" << OB(2041);
+		}
+	    }
+	    else if (model.synapseGType[i] == INDIVIDUALID) {
+		os << "if (B(gp" << model.synapseName[i] << "[gid >> " << logUIntSz << "], gid & " << UIntSz - 1 << "))" << OB(2041);
+	    }
+
+	    if (v == 2) {
+		for (size_t p= 0, e; p < body.size(); p= e+1) {
+		    e= body.find('\n', p);
+		    os << body.substr(p, e-p) << ENDL;
+		}
+		os << "bucketStart[(ipost >> " << bucketShift << ") + 1]++;" << ENDL;
+		os << "bucketPost[nBucketed]= ipost;" << ENDL;
+		os << "bucketValue[nBucketed++]= " << value << ";" << ENDL;
+	    }
+	    else {
+		os << wCode << ENDL;
+	    }
+
+	    if (eCodePost) {
+		os << CB(2041); // end if (eCode)
+	    }
+	    else if (model.synapseGType[i] == INDIVIDUALID) {
+		os << CB(2041); // end if (B(gp" << model.synapseName[i] << "[gid >> " << logUIntSz << "], gid 
+	    }
+	    if (weightUpdateModels[synt].simCode_supportCode != tS("")) {
+		os << CB(29) << " // namespace bracket closed" << ENDL;
+	    }
+	    os << CB(202);
+	    os << CB(201);
+
+	    if (v == 2) {
+		// a counting sort keeps the order of the inputs to each target, so that the sums are the same as without buckets
+		os << "// sort the inputs into buckets of targets, keeping the order of the inputs to each target, and add them" << ENDL;
+		os << "for (int b = 0; b < " << buckets << "; b++) bucketStart[b + 1]+= bucketStart[b];" << ENDL;
+		os << "for (size_t k = 0; k < nBucketed; k++)" << OB(208);
+		os << "size_t l = bucketStart[bucketPost[k] >> " << bucketShift << "]++;" << ENDL;
+		os << "bucketPostSorted[l]= bucketPost[k];" << ENDL;
+		os << "bucketValueSorted[l]= bucketValue[k];" << ENDL;
+		os << CB(208);
+		os << "for (size_t k = 0; k < nBucketed; k++)" << OB(209);
+		os << "ipost = bucketPostSorted[k];" << ENDL;
+		os << inSyn << " += bucketValueSorted[k];" << ENDL;
+		os << CB(209);
+		os << CB(204);
+	    }
+	    if (bucketed && (v == 1)) {
+		os << CB(207);
+	    }
+	    if (many && (v == 1)) {
+		os << CB(203);
+	    }
+	    if (many && (v == 0)) {
+		os << CB(206);
+	    }
+	}
+	if (pull) {
+	    os << CB(224);
 	}
-	os << CB(202);
-	os << CB(201);
     }
 }
 
 
 //--------------------------------------------------------------------------
 /*!
-  \brief Function that generates code that will simulate all synapses of the model on the CPU.
+  \brief Function that generates the file synapseFnct_<group name>.cc with the functions that simulate one synapse group on the CPU.
 */
 //--------------------------------------------------------------------------
 
-void genSynapseFunction(NNmodel &model, //!< Model description
-			string &path //!< Path for code generation
+static void genSynapseGroupFunction(NNmodel &model, //!< Model description
+				    string &path, //!< Path for code generation
+				    int k //!< Index of the synapse group
     )
 {
-    string name, s, localID, theLG, preSpike, preSpikeV, sTpost, sTpre;
-    unsigned int k, src, trg, synt, inSynNo;
-    ofstream os;
+    string name, localID;
+    unsigned int src, trg, synt, inSynNo;
+    GeneratedFile os;
 
-//    cout << "entering genSynapseFunction" << endl;
-    name = path + toString("/") + model.name + toString("_CODE/synapseFnct.cc");
+    name = path + toString("/") + model.name + toString("_CODE/synapseFnct_") + model.synapseName[k] + toString(".cc");
     os.open(name.c_str());
+    genCPUFileHeader(os, model, tS("synapseFnct_") + model.synapseName[k] + tS(".cc"), tS("containing the CPU-only equivalent of the synapse and learning kernels for synapse group ") + model.synapseName[k] + tS("."));
+    if ((model.synapseConnType[k] == SPARSE) && (GENN_PREFERENCES::bucketSparseSynapses || pullsSpikes(model, k))) {
+	os << "#include <vector>" << ENDL;
+	os << "#include <algorithm>" << ENDL;
+	os << ENDL;
+    }
 
-    // write header content
-    writeHeader(os);
-    os << ENDL;
-
-    // compiler/include control (include once)
-    os << "#ifndef _" << model.name << "_synapseFnct_cc" << ENDL;
-    os << "#define _" << model.name << "_synapseFnct_cc" << ENDL;
-    os << ENDL;
-
-    // write doxygen comment
-    os << "//-------------------------------------------------------------------------" << ENDL;
-    os << "/*! \\file synapseFnct.cc" << ENDL << ENDL;
-    os << "\\brief File generated from GeNN for the model " << model.name << " containing the equivalent of the synapse kernel and learning kernel functions for the CPU only version." << ENDL;
-    os << "*/" << ENDL;
-    os << "//-------------------------------------------------------------------------" << ENDL << ENDL;
+    src= model.synapseSource[k];
+    trg= model.synapseTarget[k];
+    synt= model.synapseType[k];
+    inSynNo= model.synapseInSynNo[k];
+    string synapseName= model.synapseName[k];
+    unsigned int srcno= model.neuronN[src]; 
+    unsigned int trgno= model.neuronN[trg];
+    int nt_pre= model.neuronType[src];
+    int nt_post= model.neuronType[trg];
+    bool delayPre = model.neuronDelaySlots[src] > 1;
+    bool delayPost = model.neuronDelaySlots[trg] > 1;
+    string offsetPre = (delayPre ? "(delaySlot * " + tS(model.neuronN[src]) + ") + " : "");
+    string offsetPost = (delayPost ? "(spkQuePtr" + model.neuronName[trg] +" * " + tS(model.neuronN[trg]) + ") + " : "");
+    bool synDyn= model.synapseUsesSynapseDynamics[k] && (weightUpdateModels[synt].synapseDynamics != tS(""));
+
+    // support code of the weight update model
+    genSupportCodeNamespace(os, synapseName + tS("_weightupdate_simCode"), weightUpdateModels[synt].simCode_supportCode);
+    if (model.synapseUsesPostLearning[k]) {
+	genSupportCodeNamespace(os, synapseName + tS("_weightupdate_simLearnPost"), weightUpdateModels[synt].simLearnPost_supportCode);
+    }
+    if (synDyn) {
+	genSupportCodeNamespace(os, synapseName + tS("_weightupdate_synapseDynamics"), weightUpdateModels[synt].synapseDynamics_supportCode);
+    }
 
     // synapse dynamics function
-    os << "void calcSynapseDynamicsCPU(" << model.ftype << " t)" << ENDL;
-    os << OB(1000);
-    os << "// execute internal synapse dynamics if any" << ENDL;
+    if (synDyn) {
+	genCPUFunctionHead(os, model, tS("calcSynapseDynamicsCPU") + synapseName);
+	os << OB(1000);
+	os << "// execute internal synapse dynamics" << ENDL;
 
-    for (int i = 0; i < model.synDynGroups; i++) {
-	k= model.synDynGrp[i];
-	src= model.synapseSource[k];
-	trg= model.synapseTarget[k];
-	synt= model.synapseType[k];
-	string synapseName= model.synapseName[k];
-	unsigned int srcno= model.neuronN[src]; 
-	unsigned int trgno= model.neuronN[trg];
-	int nt_pre= model.neuronType[src];
-	int nt_post= model.neuronType[trg];
-	bool delayPre = model.neuronDelaySlots[src] > 1;
-	bool delayPost = model.neuronDelaySlots[trg] > 1;
-	string offsetPre = (delayPre ? "(delaySlot * " + tS(model.neuronN[src]) + ") + " : "");
-	string offsetPost = (delayPost ? "(spkQuePtr" + model.neuronName[trg] +" * " + tS(model.neuronN[trg]) + ") + " : "");
-	
-	// there is some internal synapse dynamics
-	if (weightUpdateModels[synt].synapseDynamics != tS("")) {
-
-	    os << "// synapse group " << synapseName << ENDL;
-	    os << OB(1005);
-
-	    if (model.neuronDelaySlots[src] > 1) {
-		os << "unsigned int delaySlot = (spkQuePtr" << model.neuronName[src];
-		os << " + " << (model.neuronDelaySlots[src] - model.synapseDelay[k]);
-		os << ") % " << model.neuronDelaySlots[src] << ";" << ENDL;
-	    }
-
-	    weightUpdateModel wu= weightUpdateModels[synt];
-	    if (wu.synapseDynamics_supportCode != tS("")) {
-		os << OB(29) << " using namespace " << synapseName << "_weightupdate_synapseDynamics;" << ENDL;	
-	    }
-	    string SDcode= wu.synapseDynamics;
-	    substitute(SDcode, tS("$(t)"), tS("t"));
-	    if (model.synapseConnType[k] == SPARSE) { // SPARSE
-		os << "for (int n= 0; n < C" << synapseName << ".connN; n++)" << OB(24) << ENDL; 
-		if (model.synapseGType[k] == INDIVIDUALG) {
-		    // name substitute synapse var names in synapseDynamics code
-		    name_substitutions(SDcode, tS(""), wu.varNames, synapseName + tS("[n]"));
+	if (model.neuronDelaySlots[src] > 1) {
+	    os << "unsigned int delaySlot = (spkQuePtr" << model.neuronName[src];
+	    os << " + " << (model.neuronDelaySlots[src] - model.synapseDelay[k]);
+	    os << ") % " << model.neuronDelaySlots[src] << ";" << ENDL;
+	}
+
+	weightUpdateModel wu= weightUpdateModels[synt];
+	if (wu.synapseDynamics_supportCode != tS("")) {
+	    os << OB(29) << " using namespace " << synapseName << "_weightupdate_synapseDynamics;" << ENDL;	
+	}
+	string SDcode= wu.synapseDynamics;
+	substitute(SDcode, tS("$(t)"), tS("t"));
+	substitute(SDcode, tS("$(updatelinsyn)"), tS("$(inSyn) += $(addtoinSyn)"));
+	substitute(SDcode, tS("$(addtoinSyn)"), tS("addtoinSyn"));
+	bool sparse= (model.synapseConnType[k] == SPARSE);
+	string ipost= (sparse ? tS("C") + synapseName + tS(".ind[n]") : tS("j"));
+	if (model.synapseGType[k] == INDIVIDUALG) {
+	    // name substitute synapse var names in synapseDynamics code
+	    name_substitutions(SDcode, tS(""), wu.varNames, synapseName + (sparse ? tS("[n]") : tS("[i*") + tS(trgno) + tS("+j]")));
+	}
+	else {
+	    // substitute initial values as constants for synapse var names in synapseDynamics code
+	    value_substitutions(SDcode, wu.varNames, model.synapseIni[k]);
+	}
+	substitute(SDcode, tS("$(inSyn)"), tS("inSyn") + synapseName + tS("[") + ipost + tS("]"));
+	// substitute values for parameters and derived parameters in synapseDynamics code
+	synapse_para_substitutions(SDcode, model, k);
+	neuron_substitutions_in_synaptic_code(SDcode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("i"), ipost, tS(""));
+	SDcode= optimiseStatements(SDcode, model.ftype, synapseFloatNames(model, k));
+
+	// the synapses are visited row by row, so that the terms that only depend on the presynaptic neuron (e.g. the
+	// activation of a graded synapse) are computed once per presynaptic neuron
+	vector<string> variant(1, sparse ? tS("n") : tS("j"));
+	string preCode;
+	SDcode= hoistLoopInvariant(SDcode, variant, presynapticFloatNames(model, k), model.ftype, preCode);
+	SDcode= ensureFtype(SDcode, model.ftype, model.mathPrecision);
+	preCode= ensureFtype(preCode, model.ftype, model.mathPrecision);
+	checkUnreplacedVariables(SDcode, tS("synapseDynamics"));
+	string addtoinSyn= ((SDcode.find("addtoinSyn") != string::npos) ? model.ftype + tS(" addtoinSyn;") : tS(""));
+
+	// continuous coupling of dense groups, which only adds to the postsynaptic input, is a matrix-vector product;
+	// the presynaptic activations are computed first and the rows are then added tile by tile of postsynaptic
+	// neurons as for spikes
+	string body, value;
+	vector<string> locals(1, tS("addtoinSyn"));
+	bool tiled= !sparse && GENN_PREFERENCES::tileDenseSynapses && splitAccumulation(SDcode, tS("inSyn") + synapseName + tS("[j]"), locals, body, value);
+	if (tiled) {
+	    vector<string> preNames, preLines;
+	    for (size_t p= 0, e; p < preCode.size(); p= e+1) {
+		e= preCode.find('\n', p);
+		string line= preCode.substr(p, e-p);
+		size_t n= line.find(model.ftype + tS(" ")) + model.ftype.size() + 1;
+		preNames.push_back(line.substr(n, line.find('=') - n));
+		preLines.push_back(line);
+	    }
+	    if (preNames.size() > 0) {
+		os << "static " << model.ftype << " ";
+		for (int p= 0; p < preNames.size(); p++) {
+		    os << (p > 0 ? ", " : "") << preNames[p] << "Pre[" << srcno << "]";
 		}
-		else {
-		    // substitute initial values as constants for synapse var names in synapseDynamics code
-		    value_substitutions(SDcode, wu.varNames, model.synapseIni[k]);
+		os << ";" << ENDL;
+		os << "for (int i = 0; i < " << srcno << "; i++)" << OB(213);
+		for (int p= 0; p < preNames.size(); p++) {
+		    os << preLines[p] << ENDL;
+		    os << preNames[p] << "Pre[i]= " << preNames[p] << ";" << ENDL;
 		}
-		// substitute parameter values for parameters in synapseDynamics code
-		value_substitutions(SDcode, wu.pNames, model.synapsePara[k]);
-		// substitute values for derived parameters in synapseDynamics code
-		value_substitutions(SDcode, wu.dpNames, model.dsp_w[k]);
-		neuron_substitutions_in_synaptic_code(SDcode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("C")+ synapseName+ tS(".preInd[n]"), tS("C")+synapseName+tS(".ind[n]"), tS(""));
-		SDcode= ensureFtype(SDcode, model.ftype);
-		checkUnreplacedVariables(SDcode, tS("synapseDynamics"));
-		os << SDcode << ENDL;
-		os << CB(24);
+		os << CB(213);
 	    }
-	    else { // DENSE
-		os << "for (int i = 0; i < " <<  srcno << "; i++)" << OB(25);
-		os << "for (int j = 0; j < " <<  trgno << "; j++)" << OB(26);
-		os << "// loop through all synapses" << endl;
-		// substitute initial values as constants for synapse var names in synapseDynamics code
-		if (model.synapseGType[k] == INDIVIDUALG) {
-		    name_substitutions(SDcode, tS(""), wu.varNames, synapseName + tS("[i*") + tS(trgno) + tS("+j]"));
+	    unsigned int tile= 16384 / theSize(model.ftype);
+	    unsigned int tiles= trgno / tile;
+	    unsigned int rest= trgno % tile;
+	    for (int r= 0; r < 2; r++) {
+		unsigned int length= (r == 0) ? tile : rest;
+		if ((length == 0) || ((r == 0) && (tiles == 0))) continue;
+		unsigned int start= (r == 0) ? 0 : tiles * tile;
+		os << "for (unsigned int tile = " << start << "; tile < " << start + ((r == 0) ? tiles * tile : rest) << "; tile += " << length << ")" << OB(210);
+		os << model.ftype << " acc[" << length << "];" << ENDL;
+		os << "for (int k = 0; k < " << length << "; k++) acc[k] = inSyn" << synapseName << "[tile + k];" << ENDL;
+		os << "for (int i = 0; i < " << srcno << "; i++)" << OB(211);
+		for (int p= 0; p < preNames.size(); p++) {
+		    os << "const " << model.ftype << " " << preNames[p] << "= " << preNames[p] << "Pre[i];" << ENDL;
 		}
-		else {
-		    // substitute initial values as constants for synapse var names in synapseDynamics code
-		    value_substitutions(SDcode, wu.varNames, model.synapseIni[k]);
+		os << "for (int k = 0; k < " << length << "; k++)" << OB(212);
+		os << "const unsigned int j = tile + k;" << ENDL;
+		if (addtoinSyn != tS("")) {
+		    os << addtoinSyn << ENDL;
 		}
-                // substitute parameter values for parameters in synapseDynamics code
-		value_substitutions(SDcode, wu.pNames, model.synapsePara[k]);
-		// substitute values for derived parameters in synapseDynamics code
-		value_substitutions(SDcode, wu.dpNames, model.dsp_w[k]);
-		neuron_substitutions_in_synaptic_code(SDcode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("i"), tS("j"), tS(""));
-		SDcode= ensureFtype(SDcode, model.ftype);
-		checkUnreplacedVariables(SDcode, tS("synapseDynamics"));
-		os << SDcode << ENDL;
-		os << CB(26);
-		os << CB(25);
-	    }
-	    if (weightUpdateModels[synt].synapseDynamics_supportCode != tS("")) {
-		os << CB(29) << " // namespace bracket closed" << ENDL;
+		for (size_t p= 0, e; p < body.size(); p= e+1) {
+		    e= body.find('\n', p);
+		    os << body.substr(p, e-p) << ENDL;
+		}
+		os << "acc[k] += " << value << ";" << ENDL;
+		os << CB(212);
+		os << CB(211);
+		os << "for (int k = 0; k < " << length << "; k++) inSyn" << synapseName << "[tile + k] = acc[k];" << ENDL;
+		os << CB(210);
+	    }
+	}
+	else {
+	    os << "for (int i = 0; i < " << srcno << "; i++)" << OB(25);
+	    for (size_t p= 0, e; p < preCode.size(); p= e+1) {
+		e= preCode.find('\n', p);
+		os << preCode.substr(p, e-p) << ENDL;
+	    }
+	    if (sparse) { // SPARSE
+		os << "for (unsigned int n = C" << synapseName << ".indInG[i]; n < C" << synapseName << ".indInG[i + 1]; n++)" << OB(24);
+	    }
+	    else { // DENSE
+		os << "for (int j = 0; j < " << trgno << "; j++)" << OB(26);
+	    }
+	    if (addtoinSyn != tS("")) {
+		os << addtoinSyn << ENDL;
 	    }
-	    os << CB(1005);
+	    os << SDcode << ENDL;
+	    os << (sparse ? CB(24) : CB(26));
+	    os << CB(25);
 	}
+	if (weightUpdateModels[synt].synapseDynamics_supportCode != tS("")) {
+	    os << CB(29) << " // namespace bracket closed" << ENDL;
+	}
+	os << CB(1000);
+	os << ENDL;
+	genCPUFunctionVersions(os, model, tS("calcSynapseDynamicsCPU") + synapseName);
     }
-    os << CB(1000);
 
     // synapse function header
-    os << "void calcSynapsesCPU(" << model.ftype << " t)" << ENDL;
+    genCPUFunctionHead(os, model, tS("calcSynapsesCPU") + synapseName);
 
     // synapse function code
     os << OB(1001);
 
     os << "unsigned int ipost;" << ENDL;
     os << "unsigned int ipre;" << ENDL;
-    for (int i = 0; i < model.synapseGrpN; i++) {  
-	if (model.synapseConnType[i] == SPARSE) {
-	    os << "unsigned int npost;" << ENDL;
-	    break;
-	}
+    if (model.synapseConnType[k] == SPARSE) {
+	os << "unsigned int npost;" << ENDL;
     }
     os << model.ftype << " addtoinSyn;" << ENDL;  
     os << ENDL;
 
-    for (int i = 0; i < model.synapseGrpN; i++) {
-	src = model.synapseSource[i];
-	trg = model.synapseTarget[i];
-	synt = model.synapseType[i];
-	inSynNo = model.synapseInSynNo[i];
-
-	os << "// synapse group " << model.synapseName[i] << ENDL;
-	os << OB(1006);
-
-	if (model.neuronDelaySlots[src] > 1) {
-	    os << "unsigned int delaySlot = (spkQuePtr" << model.neuronName[src];
-	    os << " + " << (model.neuronDelaySlots[src] - model.synapseDelay[i]);
-	    os << ") % " << model.neuronDelaySlots[src] << ";" << ENDL;
-	}
-
-	// generate the code for processing spike-like events
-	if (model.synapseUsesSpikeEvents[i]) {
-	    generate_process_presynaptic_events_code_CPU(os, model, src, trg, i, localID, inSynNo, tS("Evnt"));
-	}
+    if (model.neuronDelaySlots[src] > 1) {
+	os << "unsigned int delaySlot = (spkQuePtr" << model.neuronName[src];
+	os << " + " << (model.neuronDelaySlots[src] - model.synapseDelay[k]);
+	os << ") % " << model.neuronDelaySlots[src] << ";" << ENDL;
+    }
 
-        // generate the code for processing true spike events
-	if (model.synapseUsesTrueSpikes[i]) {
-	    generate_process_presynaptic_events_code_CPU(os, model, src, trg, i, localID, inSynNo, tS(""));
-	}
+    // generate the code for processing spike-like events
+    if (model.synapseUsesSpikeEvents[k]) {
+	generate_process_presynaptic_events_code_CPU(os, model, src, trg, k, localID, inSynNo, tS("Evnt"));
+    }
 
-	os << CB(1006);
-	os << ENDL;
+    // generate the code for processing true spike events
+    if (model.synapseUsesTrueSpikes[k]) {
+	generate_process_presynaptic_events_code_CPU(os, model, src, trg, k, localID, inSynNo, tS(""));
     }
     os << CB(1001);
     os << ENDL;
+    genCPUFunctionVersions(os, model, tS("calcSynapsesCPU") + synapseName);
 
 
     //////////////////////////////////////////////////////////////
     // function for learning synapses, post-synaptic spikes
 
-    if (model.lrnGroups > 0) {
+    if (model.synapseUsesPostLearning[k]) {
+	bool sparse = model.synapseConnType[k] == SPARSE;
+	string offsetTrueSpkPre = (model.neuronNeedTrueSpk[src] ? offsetPre : "");
+	string offsetTrueSpkPost = (model.neuronNeedTrueSpk[trg] ? offsetPost : "");
 
-	os << "void learnSynapsesPostHost(" << model.ftype << " t)" << ENDL;
+	genCPUFunctionHead(os, model, tS("learnSynapsesPostHost") + synapseName);
 	os << OB(811);
 
 	os << "unsigned int ipost;" << ENDL;
 	os << "unsigned int ipre;" << ENDL;
 	os << "unsigned int lSpk;" << ENDL;
-	for (int i = 0; i < model.synapseGrpN; i++) {  
-	    if (model.synapseConnType[i] == SPARSE) {
-		os << "unsigned int npre;" << ENDL;
-		break;
-	    }
+	if (sparse) {
+	    os << "unsigned int npre;" << ENDL;
 	}
 	os << ENDL;
 
-	for (int i = 0; i < model.lrnGroups; i++) {
-	    k = model.lrnSynGrp[i];
-	    src = model.synapseSource[k];
-	    trg = model.synapseTarget[k];
-	    synt = model.synapseType[k];
-	    inSynNo = model.synapseInSynNo[k];
-	    unsigned int nN = model.neuronN[src];
-	    bool sparse = model.synapseConnType[k] == SPARSE;
-
-	    unsigned int nt_pre = model.neuronType[src];
-	    bool delayPre = model.neuronDelaySlots[src] > 1;
-	    string offsetPre = (delayPre ? "(delaySlot * " + tS(model.neuronN[src]) + ") + " : "");
-	    string offsetTrueSpkPre = (model.neuronNeedTrueSpk[src] ? offsetPre : "");
-
-	    unsigned int nt_post = model.neuronType[trg];
-	    bool delayPost = model.neuronDelaySlots[trg] > 1;
-	    string offsetPost = (delayPost ? "(spkQuePtr" + model.neuronName[trg] + " * " + tS(model.neuronN[trg]) + ") + " : "");
-	    string offsetTrueSpkPost = (model.neuronNeedTrueSpk[trg] ? offsetPost : "");
-
 // NOTE: WE DO NOT USE THE AXONAL DELAY FOR BACKWARDS PROPAGATION - WE CAN TALK ABOUT BACKWARDS DELAYS IF WE WANT THEM
 
-	    os << "// synapse group " << model.synapseName[k] << ENDL;
-	    os << OB(950);
-
-	    if (delayPre) {
-		os << "unsigned int delaySlot = (spkQuePtr" << model.neuronName[src];
-		os << " + " << (model.neuronDelaySlots[src] - model.synapseDelay[k]);
-		os << ") % " << model.neuronDelaySlots[src] << ";" << ENDL;
-	    }
+	if (delayPre) {
+	    os << "unsigned int delaySlot = (spkQuePtr" << model.neuronName[src];
+	    os << " + " << (model.neuronDelaySlots[src] - model.synapseDelay[k]);
+	    os << ") % " << model.neuronDelaySlots[src] << ";" << ENDL;
+	}
 
-	    if (weightUpdateModels[synt].simLearnPost_supportCode != tS("")) {
-		os << OB(29) << " using namespace " << model.synapseName[k] << "_weightupdate_simLearnPost;" << ENDL;
-	    }
+	if (weightUpdateModels[synt].simLearnPost_supportCode != tS("")) {
+	    os << OB(29) << " using namespace " << model.synapseName[k] << "_weightupdate_simLearnPost;" << ENDL;
+	}
 
-	    if (delayPost && model.neuronNeedTrueSpk[trg]) {
-		os << "for (ipost = 0; ipost < glbSpkCnt" << model.neuronName[trg] << "[spkQuePtr" << model.neuronName[trg] << "]; ipost++)" << OB(910);
-	    }
-	    else {
-		os << "for (ipost = 0; ipost < glbSpkCnt" << model.neuronName[trg] << "[0]; ipost++)" << OB(910);
-	    }
+	if (delayPost && model.neuronNeedTrueSpk[trg]) {
+	    os << "for (ipost = 0; ipost < glbSpkCnt" << model.neuronName[trg] << "[spkQuePtr" << model.neuronName[trg] << "]; ipost++)" << OB(910);
+	}
+	else {
+	    os << "for (ipost = 0; ipost < glbSpkCnt" << model.neuronName[trg] << "[0]; ipost++)" << OB(910);
+	}
 
-	    os << "lSpk = glbSpk" << model.neuronName[trg] << "[" << offsetTrueSpkPost << "ipost];" << ENDL;
+	os << "lSpk = glbSpk" << model.neuronName[trg] << "[" << offsetTrueSpkPost << "ipost];" << ENDL;
 
-	    if (sparse) { // SPARSE
-	        // TODO: THIS NEEDS CHECKING AND FUNCTIONAL C.POST* ARRAYS
-	        os << "npre = C" << model.synapseName[k] << ".revIndInG[lSpk + 1] - C" << model.synapseName[k] << ".revIndInG[lSpk];" << ENDL;
-		os << "for (int l = 0; l < npre; l++)" << OB(121);
-		os << "ipre = C" << model.synapseName[k] << ".revIndInG[lSpk] + l;" << ENDL;
-	    }
-	    else { // DENSE
-		os << "for (ipre = 0; ipre < " << model.neuronN[src] << "; ipre++)" << OB(121);
-	    }
+	if (sparse) { // SPARSE
+	    // TODO: THIS NEEDS CHECKING AND FUNCTIONAL C.POST* ARRAYS
+	    os << "npre = C" << model.synapseName[k] << ".revIndInG[lSpk + 1] - C" << model.synapseName[k] << ".revIndInG[lSpk];" << ENDL;
+	    os << "for (int l = 0; l < npre; l++)" << OB(121);
+	    os << "ipre = C" << model.synapseName[k] << ".revIndInG[lSpk] + l;" << ENDL;
+	}
+	else { // DENSE
+	    os << "for (ipre = 0; ipre < " << model.neuronN[src] << "; ipre++)" << OB(121);
+	}
 
-	    string code = weightUpdateModels[synt].simLearnPost;
-	    substitute(code, tS("$(t)"), tS("t"));
-	    // Code substitutions ----------------------------------------------------------------------------------
-	    if (sparse) { // SPARSE
-		name_substitutions(code, tS(""), weightUpdateModels[synt].varNames, model.synapseName[k] + tS("[C") + model.synapseName[k] + tS(".remap[ipre]]"));
-	    }
-	    else { // DENSE
-		name_substitutions(code, tS(""), weightUpdateModels[synt].varNames, model.synapseName[k] + tS("[lSpk + ") + tS(model.neuronN[trg]) + tS(" * ipre]"));
-	    }
-	    value_substitutions(code, weightUpdateModels[synt].pNames, model.synapsePara[k]);
-	    value_substitutions(code, weightUpdateModels[synt].dpNames, model.dsp_w[k]);
-	    name_substitutions(code, tS(""), weightUpdateModels[synt].extraGlobalSynapseKernelParameters, model.synapseName[k]);
+	string code = weightUpdateModels[synt].simLearnPost;
+	substitute(code, tS("$(t)"), tS("t"));
+	// Code substitutions ----------------------------------------------------------------------------------
+	if (sparse) { // SPARSE
+	    name_substitutions(code, tS(""), weightUpdateModels[synt].varNames, model.synapseName[k] + tS("[C") + model.synapseName[k] + tS(".remap[ipre]]"));
+	}
+	else { // DENSE
+	    name_substitutions(code, tS(""), weightUpdateModels[synt].varNames, model.synapseName[k] + tS("[lSpk + ") + tS(model.neuronN[trg]) + tS(" * ipre]"));
+	}
+	synapse_para_substitutions(code, model, k);
+	name_substitutions(code, tS(""), weightUpdateModels[synt].extraGlobalSynapseKernelParameters, model.synapseName[k]);
 
-	    // presynaptic neuron variables and parameters
-	    if (sparse) { // SPARSE
-		neuron_substitutions_in_synaptic_code(code, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("C") + model.synapseName[k] + tS(".revInd[ipre]"), tS("lSpk"), tS(""));	
-	    }
-	    else { // DENSE
-		neuron_substitutions_in_synaptic_code(code, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("ipre"), tS("lSpk"), tS(""));	
-	    }
-	    code= ensureFtype(code, model.ftype);
-	    checkUnreplacedVariables(code, tS("simLearnPost"));
-	    // end Code substitutions ------------------------------------------------------------------------- 
-	    os << code << ENDL;
+	// presynaptic neuron variables and parameters
+	if (sparse) { // SPARSE
+	    neuron_substitutions_in_synaptic_code(code, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("C") + model.synapseName[k] + tS(".revInd[ipre]"), tS("lSpk"), tS(""));	
+	}
+	else { // DENSE
+	    neuron_substitutions_in_synaptic_code(code, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("ipre"), tS("lSpk"), tS(""));	
+	}
+	code= optimiseStatements(code, model.ftype, synapseFloatNames(model, k));
+	code= ensureFtype(code, model.ftype, model.mathPrecision);
+	checkUnreplacedVariables(code, tS("simLearnPost"));
+	// end Code substitutions ------------------------------------------------------------------------- 
+	os << code << ENDL;
 
-	    os << CB(121);
-	    os << CB(910);
-	    if (weightUpdateModels[synt].simLearnPost_supportCode != tS("")) {
-		os << CB(29) << " // namespace bracket closed" << ENDL;
-	    }
-	    os << CB(950);
+	os << CB(121);
+	os << CB(910);
+	if (weightUpdateModels[synt].simLearnPost_supportCode != tS("")) {
+	    os << CB(29) << " // namespace bracket closed" << ENDL;
 	}
 	os << CB(811);
+	os << ENDL;
+	genCPUFunctionVersions(os, model, tS("learnSynapsesPostHost") + synapseName);
+    }
+    os.close();
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief Function that generates code that will simulate all synapses of the model on the CPU.
+
+  Each synapse group is simulated by functions in its own file synapseFnct_<group name>.cc, so that the groups can be compiled in parallel and only changed groups are recompiled. The file synapseFnct.cc calls these functions in the order of the synapse groups, on the thread of their NUMA node if the model runs on several nodes.
+*/
+//--------------------------------------------------------------------------
+
+void genSynapseFunction(NNmodel &model, //!< Model description
+			string &path //!< Path for code generation
+    )
+{
+    string name;
+    GeneratedFile os;
+
+//    cout << "entering genSynapseFunction" << endl;
+    for (int i = 0; i < model.synapseGrpN; i++) {
+	genSynapseGroupFunction(model, path, i);
+    }
+
+    name = path + toString("/") + model.name + toString("_CODE/synapseFnct.cc");
+    os.open(name.c_str());
+    genCPUFileHeader(os, model, tS("synapseFnct.cc"), tS("containing the equivalent of the synapse kernel and learning kernel functions for the CPU only version."));
+    if (cpuNodes(model).size() > 1) {
+	os << "#include \"numaUtils.h\"" << ENDL;
+	os << ENDL;
+    }
+
+    // functions of the individual synapse groups
+    for (int i = 0; i < model.synapseGrpN; i++) {
+	unsigned int synt= model.synapseType[i];
+	if (model.synapseUsesSynapseDynamics[i] && (weightUpdateModels[synt].synapseDynamics != tS(""))) {
+	    os << "void calcSynapseDynamicsCPU" << model.synapseName[i] << "(" << model.ftype << " t);" << ENDL;
+	}
+	os << "void calcSynapsesCPU" << model.synapseName[i] << "(" << model.ftype << " t);" << ENDL;
+	if (model.synapseUsesPostLearning[i]) {
+	    os << "void learnSynapsesPostHost" << model.synapseName[i] << "(" << model.ftype << " t);" << ENDL;
+	}
     }
     os << ENDL;
 
+    // synapse dynamics function
+    vector<string> calls;
+    vector<unsigned int> callNodes;
+    vector<int> callHosts;
+    vector<string> remoteCode;
+    for (int i = 0; i < model.synDynGroups; i++) {
+	unsigned int k= model.synDynGrp[i];
+	if (weightUpdateModels[model.synapseType[k]].synapseDynamics != tS("")) {
+	    calls.push_back(tS("calcSynapseDynamicsCPU") + model.synapseName[k]);
+	    callNodes.push_back(synapseCPUNode(model, k));
+	    callHosts.push_back(synapseHost(model, k));
+	    remoteCode.push_back(tS(""));
+	}
+    }
+    os << "// execute internal synapse dynamics if any" << ENDL;
+    genCPUDispatch(os, model, tS("calcSynapseDynamicsCPU"), calls, callNodes, callHosts, remoteCode);
 
-    os << "#endif" << ENDL;
+    // synapse function
+    calls.clear();
+    callNodes.clear();
+    callHosts.clear();
+    remoteCode.clear();
+    for (int i = 0; i < model.synapseGrpN; i++) {
+	calls.push_back(tS("calcSynapsesCPU") + model.synapseName[i]);
+	callNodes.push_back(synapseCPUNode(model, i));
+	callHosts.push_back(synapseHost(model, i));
+	remoteCode.push_back(tS(""));
+    }
+    genCPUDispatch(os, model, tS("calcSynapsesCPU"), calls, callNodes, callHosts, remoteCode);
+
+    // function for learning synapses, post-synaptic spikes
+    if (model.lrnGroups > 0) {
+	calls.clear();
+	callNodes.clear();
+	callHosts.clear();
+	remoteCode.clear();
+	for (int i = 0; i < model.lrnGroups; i++) {
+	    calls.push_back(tS("learnSynapsesPostHost") + model.synapseName[model.lrnSynGrp[i]]);
+	    callNodes.push_back(synapseCPUNode(model, model.lrnSynGrp[i]));
+	    callHosts.push_back(synapseHost(model, model.lrnSynGrp[i]));
+	    remoteCode.push_back(tS(""));
+	}
+	genCPUDispatch(os, model, tS("learnSynapsesPostHost"), calls, callNodes, callHosts, remoteCode);
+    }
     os.close();
 
 //  cout << "exiting genSynapseFunction" << endl;
@@ -23,6 +23,7 @@
 #include "global.h"
 #include "utils.h"
 #include "stringUtils.h"
+#include "codeOptimiser.h"
 #include "CodeHelper.h"
 
 #include <algorithm>
@@ -48,7 +49,7 @@ void genNeuronKernel(NNmodel &model, //!< Model description
 {
     string name, s, localID;
     unsigned int nt;
-    ofstream os;
+    GeneratedFile os;
 
     name = path + toString("/") + model.name + toString("_CODE/neuronKrnl.cc");
     os.open(name.c_str());
@@ -74,6 +75,11 @@ void genNeuronKernel(NNmodel &model, //!< Model description
     os << "// include the support codes provided by the user for neuron or synaptic models" << ENDL;
     os << "#include \"support_code.h\"" << ENDL << ENDL;
 
+    // lookup tables of tabulated functions of the neuron models
+    for (int i = 0; i < model.neuronGrpN; i++) {
+	os << neuron_tables_code(model, i, tS("__device__ "), false);
+    }
+
     isGrpVarNeeded = new short[model.neuronGrpN];
     for (int i = 0; i < model.synapseGrpN; i++) {
 	if (model.synapseConnType[i] == SPARSE){
@@ -211,6 +217,9 @@ void genNeuronKernel(NNmodel &model, //!< Model description
 	    }
 	    os << localID << "];" << ENDL;
 	}
+	if (nModels[nt].needsGennrand()) {
+	    os << "unsigned int rndN= 0; // number of random numbers drawn by this neuron" << ENDL;
+	}
 	os << ENDL;
 		
 	if ((model.inSyn[i].size() > 0) || (nModels[nt].simCode.find(tS("Isyn")) != string::npos)) {
@@ -238,18 +247,17 @@ void genNeuronKernel(NNmodel &model, //!< Model description
 	    substitute(psCode, tS("$(t)"), tS("t"));
 	    substitute(psCode, tS("$(inSyn)"), tS("linSyn") + sName);
 	    name_substitutions(psCode, tS("l"), nModels[nt].varNames, tS(""));
-	    value_substitutions(psCode, nModels[nt].pNames, model.neuronPara[i]);
-	    value_substitutions(psCode, nModels[nt].dpNames, model.dnp[i]);
+	    neuron_para_substitutions(psCode, model, i);
 	    if (model.synapseGType[synPopID] == INDIVIDUALG) {
 		name_substitutions(psCode, tS("lps"), psm.varNames, sName);
 	    }
 	    else {
 		value_substitutions(psCode, psm.varNames, model.postSynIni[synPopID]);
 	    }
-	    value_substitutions(psCode, psm.pNames, model.postSynapsePara[synPopID]);
-	    value_substitutions(psCode, psm.dpNames, model.dpsp[synPopID]);
+	    postsynapse_para_substitutions(psCode, model, synPopID);
 	    name_substitutions(psCode, tS(""), nModels[nt].extraGlobalNeuronKernelParameters, model.neuronName[i]);
-	    psCode= ensureFtype(psCode, model.ftype);
+	    psCode= optimiseExpression(psCode);
+	    psCode= ensureFtype(psCode, model.ftype, model.mathPrecision);
 	    checkUnreplacedVariables(psCode,tS("postSyntoCurrent"));
 	    os << psCode << ";" << ENDL;	    
 	    if (psm.supportCode != tS("")) {
@@ -263,17 +271,18 @@ void genNeuronKernel(NNmodel &model, //!< Model description
 	    cerr << "Warning: No thresholdConditionCode for neuron type " << model.neuronType[i] << " used for population \"" << model.neuronName[i] << "\" was provided. There will be no spikes detected in this population!" << endl;
 	} 
 	else {
+	    neuron_table_substitutions(thCode, model, i);
 	    substitute(thCode, tS("$(id)"), localID);
 	    substitute(thCode, tS("$(t)"), tS("t"));
 	    name_substitutions(thCode, tS("l"), nModels[nt].varNames, tS(""));
 	    substitute(thCode, tS("$(Isyn)"), tS("Isyn"));
 	    substitute(thCode, tS("$(sT)"), tS("lsT"));
-	    value_substitutions(thCode, nModels[nt].pNames, model.neuronPara[i]);
-	    value_substitutions(thCode, nModels[nt].dpNames, model.dnp[i]);
+	    neuron_para_substitutions(thCode, model, i);
 	    name_substitutions(thCode, tS(""), nModels[nt].extraGlobalNeuronKernelParameters, model.neuronName[i]);
-	    thCode= ensureFtype(thCode, model.ftype);
+	    thCode= optimiseExpression(thCode);
+	    thCode= ensureFtype(thCode, model.ftype, model.mathPrecision);
 	    checkUnreplacedVariables(thCode,tS("thresholdConditionCode"));
-	    if (GENN_PREFERENCES::autoRefractory) {
+	    if (GENN_PREFERENCES::autoRefractory && nModels[nt].needAutoRefractory) {
 		if (nModels[nt].supportCode != tS("")) {
 		    os << OB(29) << " using namespace " << model.neuronName[i] << "_neuron;" << ENDL;
 		}
@@ -286,15 +295,17 @@ void genNeuronKernel(NNmodel &model, //!< Model description
 
 	os << "// calculate membrane potential" << ENDL;
 	string sCode = nModels[nt].simCode;
+	neuron_table_substitutions(sCode, model, i);
+	gennrand_substitutions(sCode, i, localID);
 	substitute(sCode, tS("$(id)"), localID);
 	substitute(sCode, tS("$(t)"), tS("t"));
 	name_substitutions(sCode, tS("l"), nModels[nt].varNames, tS(""));
-	value_substitutions(sCode, nModels[nt].pNames, model.neuronPara[i]);
-	value_substitutions(sCode, nModels[nt].dpNames, model.dnp[i]);
+	neuron_para_substitutions(sCode, model, i);
 	name_substitutions(sCode, tS(""), nModels[nt].extraGlobalNeuronKernelParameters, model.neuronName[i]);
 	substitute(sCode, tS("$(Isyn)"), tS("Isyn"));
 	substitute(sCode, tS("$(sT)"), tS("lsT"));
-	sCode= ensureFtype(sCode, model.ftype);
+	sCode= optimiseStatements(sCode, model.ftype, neuronFloatNames(model, i));
+	sCode= ensureFtype(sCode, model.ftype, model.mathPrecision);
 	checkUnreplacedVariables(sCode,tS("neuron simCode"));
 	
 	if (nModels[nt].supportCode != tS("")) {
@@ -313,7 +324,8 @@ void genNeuronKernel(NNmodel &model, //!< Model description
 	    substitute(eCode, tS("$(t)"), tS("t"));
 	    extended_name_substitutions(eCode, tS("l"), nModels[model.neuronType[i]].varNames, tS("_pre"), tS(""));
 	    name_substitutions(eCode, tS(""), nModels[model.neuronType[i]].extraGlobalNeuronKernelParameters, model.neuronName[i]);
-	    eCode= ensureFtype(eCode, model.ftype);
+	    eCode= optimiseExpression(eCode);
+	    eCode= ensureFtype(eCode, model.ftype, model.mathPrecision);
 	    checkUnreplacedVariables(eCode, tS("neuronSpkEvntCondition"));
 	    // end code substitutions ----
 	    os << "// test for and register a spike-like event" << ENDL;
@@ -335,7 +347,7 @@ void genNeuronKernel(NNmodel &model, //!< Model description
 	    if (nModels[nt].supportCode != tS("")) {
 		os << OB(29) << " using namespace " << model.neuronName[i] << "_neuron;" << ENDL;	
 	    }
-	    if (GENN_PREFERENCES::autoRefractory) {
+	    if (GENN_PREFERENCES::autoRefractory && nModels[nt].needAutoRefractory) {
 	      os << "if ((" << thCode << ") && !(oldSpike)) " << OB(40);
 	    }
 	    else {
@@ -347,15 +359,17 @@ void genNeuronKernel(NNmodel &model, //!< Model description
 	    // add after-spike reset if provided
 	    if (nModels[nt].resetCode != tS("")) {
 		string rCode = nModels[nt].resetCode;
+		neuron_table_substitutions(rCode, model, i);
+		gennrand_substitutions(rCode, i, localID);
 		substitute(rCode, tS("$(id)"), localID);
 		substitute(rCode, tS("$(t)"), tS("t"));
 		name_substitutions(rCode, tS("l"), nModels[nt].varNames, tS(""));
-		value_substitutions(rCode, nModels[nt].pNames, model.neuronPara[i]);
-		value_substitutions(rCode, nModels[nt].dpNames, model.dnp[i]);
+		neuron_para_substitutions(rCode, model, i);
 		substitute(rCode, tS("$(Isyn)"), tS("Isyn"));
 		substitute(rCode, tS("$(sT)"), tS("lsT"));
 		name_substitutions(rCode, tS(""), nModels[nt].extraGlobalNeuronKernelParameters, model.neuronName[i]);
-		rCode= ensureFtype(rCode, model.ftype);
+		rCode= optimiseStatements(rCode, model.ftype, neuronFloatNames(model, i));
+		rCode= ensureFtype(rCode, model.ftype, model.mathPrecision);
 		checkUnreplacedVariables(rCode, tS("resetCode"));
 		os << "// spike reset code" << ENDL;
 		os << rCode << ENDL;
@@ -387,12 +401,11 @@ void genNeuronKernel(NNmodel &model, //!< Model description
 	    substitute(pdCode, tS("$(t)"), tS("t"));
 	    substitute(pdCode, tS("$(inSyn)"), tS("linSyn") + sName);
 	    name_substitutions(pdCode, tS("lps"), psModel.varNames, sName);
-	    value_substitutions(pdCode, psModel.pNames, model.postSynapsePara[model.inSyn[i][j]]);
-	    value_substitutions(pdCode, psModel.dpNames, model.dpsp[model.inSyn[i][j]]);
+	    postsynapse_para_substitutions(pdCode, model, model.inSyn[i][j]);
 	    name_substitutions(pdCode, tS("l"), nModels[nt].varNames, tS(""));
-	    value_substitutions(pdCode, nModels[nt].pNames, model.neuronPara[i]);
-	    value_substitutions(pdCode, nModels[nt].dpNames, model.dnp[i]);
-	    pdCode= ensureFtype(pdCode, model.ftype);
+	    neuron_para_substitutions(pdCode, model, i);
+	    pdCode= optimiseStatements(pdCode, model.ftype, neuronFloatNames(model, i));
+	    pdCode= ensureFtype(pdCode, model.ftype, model.mathPrecision);
 	    checkUnreplacedVariables(pdCode, tS("postSynDecay"));
 	    if (psModel.supportCode != tS("")) {
 		os << OB(29) << " using namespace " << sName << "_postsyn;" << ENDL;	
@@ -557,14 +570,14 @@ void generate_process_presynaptic_events_code(
 		
 		// code substitutions ----
 		string eCode = weightUpdateModels[synt].evntThreshold;
-		value_substitutions(eCode, weightUpdateModels[synt].pNames, model.synapsePara[i]);
-		value_substitutions(eCode, weightUpdateModels[synt].dpNames, model.dsp_w[i]);
+		synapse_para_substitutions(eCode, model, i);
 		name_substitutions(eCode, tS(""), weightUpdateModels[synt].extraGlobalSynapseKernelParameters, model.synapseName[i]);
 
 //		neuron_substitutions_in_synaptic_code(eCode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("shSpkEvnt") + tS("[j]"), tS("ipost"), tS("dd_"));
 		neuron_substitutions_in_synaptic_code(eCode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("preInd"), tS("i"), tS("dd_"));
 	  //  os << "shSpk" << postfix << "[threadIdx.x] = dd_glbSpk" << postfix << model.neuronName[src] << "[" << offsetPre << "(r * BLOCKSZ_SYN) + threadIdx.x];" << ENDL;
-		eCode= ensureFtype(eCode, model.ftype);
+		eCode= optimiseExpression(eCode);
+		eCode= ensureFtype(eCode, model.ftype, model.mathPrecision);
 		checkUnreplacedVariables(eCode, tS("evntThreshold"));
 		// end code substitutions ----
 		os << "(" << eCode << ")"; 
@@ -599,12 +612,12 @@ void generate_process_presynaptic_events_code(
 		    value_substitutions(wCode, weightUpdateModels[synt].varNames, model.synapseIni[i]);
 		}
 	    
-	    value_substitutions(wCode, weightUpdateModels[synt].pNames, model.synapsePara[i]);
-	    value_substitutions(wCode, weightUpdateModels[synt].dpNames, model.dsp_w[i]);
+	    synapse_para_substitutions(wCode, model, i);
 	    name_substitutions(wCode, tS("dd_"), weightUpdateModels[synt].extraGlobalSynapseKernelParameters, model.synapseName[i]);
 	    substitute(wCode, tS("$(addtoinSyn)"), tS("addtoinSyn"));
 	    neuron_substitutions_in_synaptic_code(wCode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("preInd"), tS("ipost"), tS("dd_"));
-	    wCode= ensureFtype(wCode, model.ftype);
+	    wCode= optimiseStatements(wCode, model.ftype, synapseFloatNames(model, i));
+	    wCode= ensureFtype(wCode, model.ftype, model.mathPrecision);
 	    checkUnreplacedVariables(wCode, tS("simCode")+postfix);
 	    // end code substitutions ------------------------------------------------------------------------- 
 	    
@@ -674,11 +687,11 @@ void generate_process_presynaptic_events_code(
 		
 		// code substitutions ----
 		string eCode = weightUpdateModels[synt].evntThreshold;
-		value_substitutions(eCode, weightUpdateModels[synt].pNames, model.synapsePara[i]);
-		value_substitutions(eCode, weightUpdateModels[synt].dpNames, model.dsp_w[i]);
+		synapse_para_substitutions(eCode, model, i);
 		name_substitutions(eCode, tS(""), weightUpdateModels[synt].extraGlobalSynapseKernelParameters, model.synapseName[i]);
 		neuron_substitutions_in_synaptic_code(eCode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("shSpkEvnt") + tS("[j]"), tS("ipost"), tS("dd_"));
-		eCode= ensureFtype(eCode, model.ftype);
+		eCode= optimiseExpression(eCode);
+		eCode= ensureFtype(eCode, model.ftype, model.mathPrecision);
 		checkUnreplacedVariables(eCode, tS("evntThreshold"));
 		// end code substitutions ----
 		os << "(" << eCode << ")"; 
@@ -733,12 +746,12 @@ void generate_process_presynaptic_events_code(
 		    value_substitutions(wCode, weightUpdateModels[synt].varNames, model.synapseIni[i]);
 		}
 	    }
-	    value_substitutions(wCode, weightUpdateModels[synt].pNames, model.synapsePara[i]);
-	    value_substitutions(wCode, weightUpdateModels[synt].dpNames, model.dsp_w[i]);
+	    synapse_para_substitutions(wCode, model, i);
 	    name_substitutions(wCode, tS(""), weightUpdateModels[synt].extraGlobalSynapseKernelParameters, model.synapseName[i]);
 	    substitute(wCode, tS("$(addtoinSyn)"), tS("addtoinSyn"));
 	    neuron_substitutions_in_synaptic_code(wCode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("shSpk") + postfix + tS("[j]"), tS("ipost"), tS("dd_"));
-	    wCode= ensureFtype(wCode, model.ftype);
+	    wCode= optimiseStatements(wCode, model.ftype, synapseFloatNames(model, i));
+	    wCode= ensureFtype(wCode, model.ftype, model.mathPrecision);
 	    checkUnreplacedVariables(wCode, tS("simCode")+postfix);
 	    // end Code substitutions ------------------------------------------------------------------------- 
 	    os << wCode << ENDL;
@@ -791,7 +804,14 @@ void genSynapseKernel(NNmodel &model, //!< Model description
     string name, s;
     string localID; //!< "id" if first synapse group, else "lid". lid =(thread index- last thread of the last synapse group)
     unsigned int k, src, trg, synt, inSynNo;
-    ofstream os;
+    GeneratedFile os;
+    string theAtomicAdd;
+    if ((deviceProp[theDevice].major < 2) && (model.ftype == "float")) {
+	theAtomicAdd= tS("atomicAddoldGPU");
+    }
+    else {
+	theAtomicAdd= tS("atomicAdd");
+    }
 
     // count how many neuron blocks to use: one thread for each synapse target
     // targets of several input groups are counted multiply
@@ -835,6 +855,7 @@ void genSynapseKernel(NNmodel &model, //!< Model description
 	
 	// common variables for all cases
 	os << "unsigned int id = BLOCKSZ_SYNDYN * blockIdx.x + threadIdx.x;" << ENDL;
+	os << model.ftype << " addtoinSyn;" << ENDL;
 	
 	os << "// execute internal synapse dynamics if any" << ENDL;
 	os << ENDL;
@@ -880,6 +901,9 @@ void genSynapseKernel(NNmodel &model, //!< Model description
 		}
 		string SDcode= wu.synapseDynamics;
 		substitute(SDcode, tS("$(t)"), tS("t"));
+		// continuous coupling: all presynaptic threads of a target add to its input
+		substitute(SDcode, tS("$(updatelinsyn)"), theAtomicAdd + tS("(&$(inSyn), $(addtoinSyn))"));
+		substitute(SDcode, tS("$(addtoinSyn)"), tS("addtoinSyn"));
 
 		if (model.synapseConnType[k] == SPARSE) { // SPARSE
 		    os << "if (" << localID << " < dd_indInG" << synapseName << "[" << srcno << "])" << OB(25);
@@ -892,12 +916,12 @@ void genSynapseKernel(NNmodel &model, //!< Model description
 			// substitute initial values as constants for synapse var names in synapseDynamics code
 			value_substitutions(SDcode, wu.varNames, model.synapseIni[k]);
 		    }
-		    // substitute parameter values for parameters in synapseDynamics code
-		    value_substitutions(SDcode, wu.pNames, model.synapsePara[k]);
-		    // substitute values for derived parameters in synapseDynamics code
-		    value_substitutions(SDcode, wu.dpNames, model.dsp_w[k]);
+		    // substitute values for parameters and derived parameters in synapseDynamics code
+		    synapse_para_substitutions(SDcode, model, k);
+		    substitute(SDcode, tS("$(inSyn)"), tS("dd_inSyn") + synapseName + tS("[dd_ind") + synapseName + tS("[") + localID + tS("]]"));
 		    neuron_substitutions_in_synaptic_code(SDcode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, tS("dd_preInd")+synapseName+tS("[") + localID + tS("]"), tS("dd_ind")+synapseName+tS("[") + localID + tS("]"), tS("dd_"));
-		    SDcode= ensureFtype(SDcode, model.ftype);
+		    SDcode= optimiseStatements(SDcode, model.ftype, synapseFloatNames(model, k));
+		    SDcode= ensureFtype(SDcode, model.ftype, model.mathPrecision);
 		    checkUnreplacedVariables(SDcode, tS("synapseDynamics"));
 		    os << SDcode << ENDL;
 		}
@@ -912,12 +936,12 @@ void genSynapseKernel(NNmodel &model, //!< Model description
 			// substitute initial values as constants for synapse var names in synapseDynamics code
 			value_substitutions(SDcode, wu.varNames, model.synapseIni[k]);
 		    }
-		    // substitute parameter values for parameters in synapseDynamics code
-		    value_substitutions(SDcode, wu.pNames, model.synapsePara[k]);
-		    // substitute values for derived parameters in synapseDynamics code
-		    value_substitutions(SDcode, wu.dpNames, model.dsp_w[k]);
+		    // substitute values for parameters and derived parameters in synapseDynamics code
+		    synapse_para_substitutions(SDcode, model, k);
+		    substitute(SDcode, tS("$(inSyn)"), tS("dd_inSyn") + synapseName + tS("[") + localID + tS("%") + tS(model.neuronN[trg]) + tS("]"));
 		    neuron_substitutions_in_synaptic_code(SDcode, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, localID +"/" + tS(model.neuronN[trg]), localID +"%" + tS(model.neuronN[trg]), tS("dd_"));
-		    SDcode= ensureFtype(SDcode, model.ftype);
+		    SDcode= optimiseStatements(SDcode, model.ftype, synapseFloatNames(model, k));
+		    SDcode= ensureFtype(SDcode, model.ftype, model.mathPrecision);
 		    checkUnreplacedVariables(SDcode, tS("synapseDynamics"));
 		    os << SDcode << ENDL;
 		}
@@ -1194,8 +1218,7 @@ void genSynapseKernel(NNmodel &model, //!< Model description
 	    else { // DENSE
 		name_substitutions(code, tS("dd_"), weightUpdateModels[synt].varNames, model.synapseName[k] + tS("[") + localID + tS(" * ") + tS(model.neuronN[trg]) + tS(" + shSpk[j]]"));
 	    }
-	    value_substitutions(code, weightUpdateModels[synt].pNames, model.synapsePara[k]);
-	    value_substitutions(code, weightUpdateModels[synt].dpNames, model.dsp_w[k]);
+	    synapse_para_substitutions(code, model, k);
 	    name_substitutions(code, tS(""), weightUpdateModels[synt].extraGlobalSynapseKernelParameters, model.synapseName[k]);
 
 	    // presynaptic neuron variables and parameters
@@ -1205,7 +1228,8 @@ void genSynapseKernel(NNmodel &model, //!< Model description
 	    else { // DENSE
 		neuron_substitutions_in_synaptic_code(code, model, src, trg, nt_pre, nt_post, offsetPre, offsetPost, localID, tS("shSpk[j]"), tS("dd_"));
 	    }
-	    code= ensureFtype(code, model.ftype);
+	    code= optimiseStatements(code, model.ftype, synapseFloatNames(model, k));
+	    code= ensureFtype(code, model.ftype, model.mathPrecision);
 	    checkUnreplacedVariables(code, tS("simLearnPost"));
 	    // end Code substitutions ------------------------------------------------------------------------- 
 	    os << code << ENDL;
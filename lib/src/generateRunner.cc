@@ -21,6 +21,7 @@
 //--------------------------------------------------------------------------
 
 #include "generateRunner.h"
+#include "generateCPU.h"
 #include "global.h"
 #include "utils.h"
 #include "stringUtils.h"
@@ -28,13 +29,15 @@
 
 #include <stdint.h>
 #include <cfloat>
+#include <cstdio>
+#include <algorithm>
 
 
 //--------------------------------------------------------------------------
 //! \brief This function generates host and device variable definitions, of the given type and name.
 //--------------------------------------------------------------------------
 
-void variable_def(ofstream &os, string type, string name)
+void variable_def(ostream &os, string type, string name)
 {
     os << type << " " << name << ";" << ENDL;
 #ifndef CPU_ONLY
@@ -48,7 +51,7 @@ void variable_def(ofstream &os, string type, string name)
 //! \brief This function generates host extern variable definitions, of the given type and name.
 //--------------------------------------------------------------------------
 
-void extern_variable_def(ofstream &os, string type, string name)
+void extern_variable_def(ostream &os, string type, string name)
 {
     os << "extern " << type << " " << name << ";" << ENDL;
 #ifndef CPU_ONLY
@@ -57,6 +60,668 @@ void extern_variable_def(ofstream &os, string type, string name)
 }
 
 
+#ifdef CPU_ONLY
+//--------------------------------------------------------------------------
+//! \brief Array that is allocated from an arena of the model.
+//--------------------------------------------------------------------------
+
+struct ArenaArray
+{
+    string type; //!< Type of the elements
+    string name; //!< Name of the pointer to the array
+    string size; //!< Expression for the size of the array in bytes
+};
+
+
+//--------------------------------------------------------------------------
+//! \brief This function notes an array that is allocated from the arena of the model, in the part of the NUMA node that simulates its group.
+//--------------------------------------------------------------------------
+
+static void arena_array(vector<vector<ArenaArray> > &arena, unsigned int node, string type, string name, string size)
+{
+    ArenaArray array;
+    array.type= type;
+    array.name= name;
+    array.size= size + " * sizeof(" + type + ")";
+    arena[node].push_back(array);
+}
+
+
+//--------------------------------------------------------------------------
+//! \brief This function generates the code that allocates an arena and points the arrays in it to their places.
+//--------------------------------------------------------------------------
+
+static void arena_alloc(ostream &os, string arenaName, vector<vector<ArenaArray> > &arena)
+{
+    os << "    size_t arenaSize= 0;" << ENDL;
+    for (int n = 0; n < arena.size(); n++) {
+	for (int k = 0; k < arena[n].size(); k++) {
+	    string offset= arena[n][k].name;
+	    replace(offset.begin(), offset.end(), '.', '_');
+	    os << "    size_t " << offset << "Offset= gennArenaReserve(arenaSize, " << arena[n][k].size;
+	    // the arrays of different NUMA nodes do not share pages
+	    if ((n > 0) && (k == 0)) os << ", GENN_HUGE_PAGE_SIZE";
+	    os << ");" << ENDL;
+	}
+    }
+    os << "    " << arenaName << "= gennArenaAlloc(arenaSize, " << GENN_PREFERENCES::hugePages << ");" << ENDL;
+    for (int n = 0; n < arena.size(); n++) {
+	for (int k = 0; k < arena[n].size(); k++) {
+	    string offset= arena[n][k].name;
+	    replace(offset.begin(), offset.end(), '.', '_');
+	    os << "    " << arena[n][k].name << "= (" << arena[n][k].type << " *) (" << arenaName << " + " << offset << "Offset);" << ENDL;
+	}
+    }
+}
+#endif
+
+
+//--------------------------------------------------------------------------
+/*! \brief A function that generates the declarations (declare= true) or the definitions of the global variables and setter functions of the runtime parameters of one group.
+
+  The derived parameters of a group with runtime parameters are global variables as well. The setters have C linkage, so that they can be looked up in models loaded with buildModelJIT(). The setter of a runtime parameter recomputes them with the dpclass of the model type registered in the running program, so the model types must be registered there in the same order as in the model definition (initGeNN() followed by the definition of any custom types).
+*/
+//--------------------------------------------------------------------------
+
+static void genRuntimeParas(ostream &os, //!< output stream for code
+			    NNmodel &model, //!< Model description
+			    bool declare, //!< Whether to generate declarations rather than definitions
+			    const string groupName, //!< Name of the group
+			    const string registry, //!< Name of the vector of model types the type of the group is registered in
+			    unsigned int type, //!< Model type of the group
+			    vector<string> &pNames, //!< Names of the parameters of the model type
+			    vector<string> &dpNames, //!< Names of the derived parameters of the model type
+			    vector<double> &paras, //!< Parameter values of the group
+			    vector<double> &dparas, //!< Derived parameter values of the group
+			    vector<bool> &runtime //!< Which parameters of the group are runtime parameters
+    )
+{
+    if (find(runtime.begin(), runtime.end(), true) == runtime.end()) return;
+    for (int j= 0, l= pNames.size(); j < l; j++) {
+	if (runtime[j]) {
+	    if (declare) {
+		os << "extern " << model.ftype << " " << pNames[j] << groupName << ";" << ENDL;
+	    }
+	    else {
+		os << model.ftype << " " << pNames[j] << groupName << "= " << model.scalarExpr(paras[j]) << ";" << ENDL;
+	    }
+	}
+    }
+    for (int j= 0, l= dpNames.size(); j < l; j++) {
+	if (declare) {
+	    os << "extern " << model.ftype << " " << dpNames[j] << groupName << ";" << ENDL;
+	}
+	else {
+	    os << model.ftype << " " << dpNames[j] << groupName << "= " << model.scalarExpr(dparas[j]) << ";" << ENDL;
+	}
+    }
+    for (int j= 0, l= pNames.size(); j < l; j++) {
+	if (!runtime[j]) continue;
+	if (declare) os << "extern \"C\" ";
+	os << "void set" << pNames[j] << groupName << "(" << model.ftype << " value)";
+	if (declare) {
+	    os << ";" << ENDL;
+	    continue;
+	}
+	os << ENDL;
+	os << "{" << ENDL;
+	os << "    " << pNames[j] << groupName << "= value;" << ENDL;
+	if (dpNames.size() > 0) {
+	    os << "    if (" << registry << ".size() <= " << type << ") {" << ENDL;
+	    os << "        gennError(\"The model type of group " << groupName << " is not registered in this program. Please call initGeNN() and define the custom model types before setting runtime parameters.\");" << ENDL;
+	    os << "    }" << ENDL;
+	    os << "    vector<double> p(" << pNames.size() << ");" << ENDL;
+	    for (int k= 0, n= pNames.size(); k < n; k++) {
+		os << "    p[" << k << "]= " << (runtime[k] ? pNames[k] + groupName : tS(paras[k])) << ";" << ENDL;
+	    }
+	    for (int k= 0, n= dpNames.size(); k < n; k++) {
+		os << "    " << dpNames[k] << groupName << "= " << registry << "[" << type << "].dps->calculateDerivedParameter(" << k << ", p, " << tS(model.dt) << ");" << ENDL;
+	    }
+	}
+	os << "}" << ENDL;
+	os << ENDL;
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief A function that generates the declarations (declare= true) or the definitions of the runtime parameters of all groups of the model.
+*/
+//--------------------------------------------------------------------------
+
+static void genRuntimeParas(ostream &os, //!< output stream for code
+			    NNmodel &model, //!< Model description
+			    bool declare //!< Whether to generate declarations rather than definitions
+    )
+{
+    os << "// ------------------------------------------------------------------------" << ENDL;
+    os << "// runtime parameters" << ENDL;
+    os << ENDL;
+    for (int i = 0; i < model.neuronGrpN; i++) {
+	unsigned int nt= model.neuronType[i];
+	genRuntimeParas(os, model, declare, model.neuronName[i], "nModels", nt, nModels[nt].pNames, nModels[nt].dpNames, model.neuronPara[i], model.dnp[i], model.neuronParaRuntime[i]);
+    }
+    for (int i = 0; i < model.synapseGrpN; i++) {
+	unsigned int st= model.synapseType[i];
+	unsigned int pst= model.postSynapseType[i];
+	genRuntimeParas(os, model, declare, model.synapseName[i], "weightUpdateModels", st, weightUpdateModels[st].pNames, weightUpdateModels[st].dpNames, model.synapsePara[i], model.dsp_w[i], model.synapseParaRuntime[i]);
+	genRuntimeParas(os, model, declare, model.synapseName[i], "postSynModels", pst, postSynModels[pst].pNames, postSynModels[pst].dpNames, model.postSynapsePara[i], model.dpsp[i], model.postSynapseParaRuntime[i]);
+    }
+    os << ENDL;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief A function that determines whether any group of the model has runtime parameters.
+*/
+//--------------------------------------------------------------------------
+
+static bool hasRuntimeParas(NNmodel &model)
+{
+    for (int i = 0; i < model.neuronGrpN; i++) {
+	if (model.runtimeNeuronParaNames(i).size() > 0) return true;
+    }
+    for (int i = 0; i < model.synapseGrpN; i++) {
+	if ((model.runtimeSynapseParaNames(i).size() > 0) || (model.runtimePostSynapseParaNames(i).size() > 0)) return true;
+    }
+    return false;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief A function that determines whether the CPU code of the model chooses how to propagate the spikes of SPARSE synapse groups by the size of the L2 cache (see GENN_PREFERENCES::bucketSparseSynapses).
+*/
+//--------------------------------------------------------------------------
+
+static bool needL2CacheSize(NNmodel &model)
+{
+    if (!GENN_PREFERENCES::bucketSparseSynapses) return false;
+    for (int i = 0; i < model.synapseGrpN; i++) {
+	if (model.synapseConnType[i] == SPARSE) return true;
+    }
+    return false;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief This function generates the statements that evaluate the polynomial c[0] + c[1] x + ... + c[n-1] x^(n-1) with the Horner scheme into a new variable p.
+*/
+//--------------------------------------------------------------------------
+
+static void genHorner(ostream &os, const double *c, int n, string x, string ftype)
+{
+    os << "    " << ftype << " p= " << ftypeConstant(c[n-1], ftype) << ";" << ENDL;
+    for (int k= n-2; k >= 0; k--) {
+	os << "    p= p*" << x << ((c[k] < 0.0) ? " - " : " + ") << ftypeConstant(fabs(c[k]), ftype) << ";" << ENDL;
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief This function generates the inline functions gennExp, gennLog, gennTanh and gennPow (with suffix f for float models) that replace the math functions of the same names in the code snippets of models with the GENN_MATH_FAST or GENN_MATH_APPROX math precision.
+
+  The functions consist of range reductions by bit manipulation and polynomials without branches, so that compilers can vectorize loops that call them (gcc does so for the float-to-integer conversions only when it may assume that they do not trap, i.e. with -ffast-math as used for GENN_PREFERENCES::optimizeCode). exp(x)= 2^n exp(r) with |r| <= ln(2)/2 uses the Taylor polynomial of exp(r); log(x)= e ln(2) + log(m) with m in [sqrt(1/2), sqrt(2)) uses the series log(m)= 2 atanh((m-1)/(m+1)); tanh(x) uses its Taylor polynomial for |x| < 0.4 and 1 - 2/(exp(2|x|)+1) otherwise; pow(x,y)= exp(y log|x|) with the sign for negative x and odd integer y. The degrees of the polynomials are chosen for an error of a few ulp in the fast tier and a relative error below 1e-4 (float) or 1e-8 (double) in the approximate tier.
+*/
+//--------------------------------------------------------------------------
+
+static void genFastMath(ostream &os, NNmodel &model)
+{
+    bool fast= (model.mathPrecision == GENN_MATH_FAST);
+    bool sp= (model.ftype == "float");
+    string T= model.ftype;
+    string F= (sp ? "f" : "");
+    string I= (sp ? "int32_t" : "int64_t");
+    int expN, logN, tanhN;
+    if (sp) {
+	expN= (fast ? 7 : 5);
+	logN= (fast ? 5 : 3);
+	tanhN= (fast ? 6 : 4);
+    }
+    else {
+	expN= (fast ? 13 : 8);
+	logN= (fast ? 11 : 5);
+	tanhN= (fast ? 14 : 7);
+    }
+    double expC[13], logC[11];
+    expC[0]= 1.0;
+    for (int k= 1; k < 13; k++) expC[k]= expC[k-1]/k;
+    for (int k= 0; k < 11; k++) logC[k]= 2.0/(2*k+1);
+    // Taylor coefficients of tanh(x)/x in x^2, 2^(2k)(2^(2k)-1)B_(2k)/(2k)!
+    const double tanhC[14]= { 1.0, -0.33333333333333331, 0.13333333333333333, -0.053968253968253971,
+			      0.021869488536155203, -0.0088632355299021973, 0.0035921280365724811,
+			      -0.0014558343870513183, 0.00059002744094558595, -0.00023912911424355248,
+			      9.6915379569294509e-05, -3.9278323883316833e-05, 1.5918905069328964e-05,
+			      -6.4516892156554306e-06 };
+
+    os << "// math functions of the " << (fast ? "fast" : "approximate") << " math precision tier, which replace exp, log, tanh and pow in the" << ENDL;
+    os << "// code snippets (see NNmodel::setMathPrecision()); they are free of branches so that loops calling them vectorize" << ENDL;
+    os << "#ifdef __CUDACC__" << ENDL;
+    os << "#define GENN_MATH_INLINE __host__ __device__ inline" << ENDL;
+    os << "#else" << ENDL;
+    os << "#define GENN_MATH_INLINE inline" << ENDL;
+    os << "#endif" << ENDL;
+    os << ENDL;
+
+    // exp(x)= 2^n exp(r) with the reduction r= x - n ln(2) split into two parts (Cody and Waite)
+    os << "GENN_MATH_INLINE " << T << " gennExp" << F << "(" << T << " x)" << ENDL;
+    os << "{" << ENDL;
+    os << "    union { " << T << " f; " << I << " i; } s;" << ENDL;
+    double lo= (sp ? -87.3 : -708.3), hi= (sp ? 88.3 : 709.0);
+    os << "    x= (x < " << ftypeConstant(lo, T) << ") ? " << ftypeConstant(lo, T) << " : ((x > " << ftypeConstant(hi, T) << ") ? " << ftypeConstant(hi, T) << " : x);" << ENDL;
+    // the argument of the conversion is positive, so that it rounds x/ln(2) to the nearest integer
+    string bias= (sp ? "127" : "1023");
+    os << "    int32_t k= (int32_t) (x*" << ftypeConstant(1.4426950408889634, T) << " + " << ftypeConstant((sp ? 127.5 : 1023.5), T) << ");" << ENDL;
+    os << "    " << T << " n= (" << T << ") (k - " << bias << ");" << ENDL;
+    if (sp) {
+	os << "    " << T << " r= (x - n*" << ftypeConstant(0.693145752, T) << ") - n*" << ftypeConstant(1.42860677e-06, T) << ";" << ENDL;
+    }
+    else {
+	os << "    " << T << " r= (x - n*" << ftypeConstant(6.93147180369123816490e-01, T) << ") - n*" << ftypeConstant(1.90821492927058770002e-10, T) << ";" << ENDL;
+    }
+    genHorner(os, expC, expN, "r", T);
+    os << "    s.i= (" << I << ") k << " << (sp ? 23 : 52) << ";" << ENDL;
+    os << "    return p*s.f;" << ENDL;
+    os << "}" << ENDL;
+    os << ENDL;
+
+    // log(x)= e ln(2) + log(m) with m in [sqrt(1/2), sqrt(2)) and log(m)= 2 atanh(z), z= (m-1)/(m+1)
+    os << "GENN_MATH_INLINE " << T << " gennLog" << F << "(" << T << " x)" << ENDL;
+    os << "{" << ENDL;
+    os << "    union { " << T << " f; " << I << " i; } s;" << ENDL;
+    os << "    s.f= x;" << ENDL;
+    if (sp) {
+	os << "    int32_t e= (s.i - 0x3f3504f3) >> 23;" << ENDL;
+	os << "    s.i-= (int32_t) ((uint32_t) e << 23);" << ENDL;
+    }
+    else {
+	// the exponent is kept as a 32 bit integer, whose conversion to double is available in vector instructions
+	os << "    int32_t e= (int32_t) ((s.i - 0x3fe6a09e667f3bcdLL) >> 52);" << ENDL;
+	os << "    s.i-= (int64_t) ((uint64_t) (int64_t) e << 52);" << ENDL;
+    }
+    os << "    " << T << " z= (s.f - " << ftypeConstant(1.0, T) << ")/(s.f + " << ftypeConstant(1.0, T) << ");" << ENDL;
+    os << "    " << T << " z2= z*z;" << ENDL;
+    genHorner(os, logC, logN, "z2", T);
+    if (sp) {
+	os << "    return e*" << ftypeConstant(0.693145752, T) << " + (z*p + e*" << ftypeConstant(1.42860677e-06, T) << ");" << ENDL;
+    }
+    else {
+	os << "    return e*" << ftypeConstant(6.93147180369123816490e-01, T) << " + (z*p + e*" << ftypeConstant(1.90821492927058770002e-10, T) << ");" << ENDL;
+    }
+    os << "}" << ENDL;
+    os << ENDL;
+
+    // tanh(x) from its Taylor polynomial for small |x| and from exp(2|x|) otherwise
+    os << "GENN_MATH_INLINE " << T << " gennTanh" << F << "(" << T << " x)" << ENDL;
+    os << "{" << ENDL;
+    os << "    " << T << " a= fabs" << F << "(x);" << ENDL;
+    os << "    " << T << " t= " << ftypeConstant(1.0, T) << " - " << ftypeConstant(2.0, T) << "/(gennExp" << F << "(" << ftypeConstant(2.0, T) << "*a) + " << ftypeConstant(1.0, T) << ");" << ENDL;
+    os << "    " << T << " x2= x*x;" << ENDL;
+    genHorner(os, tanhC, tanhN, "x2", T);
+    os << "    return (a < " << ftypeConstant(0.4, T) << ") ? x*p : ((x < " << ftypeConstant(0.0, T) << ") ? -t : t);" << ENDL;
+    os << "}" << ENDL;
+    os << ENDL;
+
+    // pow(x,y)= exp(y log|x|), negative for negative x and odd integer y
+    os << "GENN_MATH_INLINE " << T << " gennPow" << F << "(" << T << " x, " << T << " y)" << ENDL;
+    os << "{" << ENDL;
+    os << "    " << T << " r= gennExp" << F << "(y*gennLog" << F << "(fabs" << F << "(x)));" << ENDL;
+    os << "    int32_t k= (int32_t) y;" << ENDL;
+    os << "    r= ((x < " << ftypeConstant(0.0, T) << ") && ((" << T << ") k == y) && (k & 1)) ? -r : r;" << ENDL;
+    os << "    return ((x == " << ftypeConstant(0.0, T) << ") && (y > " << ftypeConstant(0.0, T) << ")) ? " << ftypeConstant(0.0, T) << " : r;" << ENDL;
+    os << "}" << ENDL;
+    os << ENDL;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief This function generates the counter-based random number generator Philox4x32-10 (Salmon et al., Parallel random numbers: as easy as 1, 2, 3, SC 2011) and the functions gennrandUniform and gennrandNormal that replace $(gennrand_uniform) and $(gennrand_normal) in the code snippets of neurons.
+
+  The random numbers are a function of the key (seed of the model, neuron group) and the counter (neuron, time step, number of the draw of the neuron in this time step) only. They therefore need no state per neuron, can be drawn in any order and are identical in the CPU and GPU simulations.
+*/
+//--------------------------------------------------------------------------
+
+static void genGennrand(ostream &os, NNmodel &model)
+{
+    bool sp= (model.ftype == "float");
+    string F= (sp ? "f" : "");
+
+    os << "// counter-based random number generator Philox4x32-10, keyed by the seed of the model and the" << ENDL;
+    os << "// neuron group and counting neurons, time steps and draws, which replaces $(gennrand_uniform) and" << ENDL;
+    os << "// $(gennrand_normal) in the code snippets of neurons" << ENDL;
+    os << "#ifdef __CUDACC__" << ENDL;
+    os << "#define GENN_RAND_INLINE __host__ __device__ inline" << ENDL;
+    os << "#else" << ENDL;
+    os << "#define GENN_RAND_INLINE inline" << ENDL;
+    os << "#endif" << ENDL;
+    os << ENDL;
+    os << "GENN_RAND_INLINE uint32_t gennMulhilo(uint32_t a, uint32_t b, uint32_t *hi)" << ENDL;
+    os << "{" << ENDL;
+    os << "#ifdef __CUDA_ARCH__" << ENDL;
+    os << "    *hi= __umulhi(a, b);" << ENDL;
+    os << "    return a*b;" << ENDL;
+    os << "#else" << ENDL;
+    os << "    uint64_t p= (uint64_t) a*b;" << ENDL;
+    os << "    *hi= (uint32_t) (p >> 32);" << ENDL;
+    os << "    return (uint32_t) p;" << ENDL;
+    os << "#endif" << ENDL;
+    os << "}" << ENDL;
+    os << ENDL;
+    os << "GENN_RAND_INLINE void gennPhilox(uint32_t c[4], uint32_t k0, uint32_t k1)" << ENDL;
+    os << "{" << ENDL;
+    os << "    for (int r= 0; r < 10; r++) {" << ENDL;
+    os << "        uint32_t hi0, hi1;" << ENDL;
+    os << "        uint32_t lo0= gennMulhilo(0xD2511F53, c[0], &hi0);" << ENDL;
+    os << "        uint32_t lo1= gennMulhilo(0xCD9E8D57, c[2], &hi1);" << ENDL;
+    os << "        c[0]= hi1 ^ c[1] ^ k0;" << ENDL;
+    os << "        c[1]= lo1;" << ENDL;
+    os << "        c[2]= hi0 ^ c[3] ^ k1;" << ENDL;
+    os << "        c[3]= lo0;" << ENDL;
+    os << "        k0+= 0x9E3779B9;" << ENDL;
+    os << "        k1+= 0xBB67AE85;" << ENDL;
+    os << "    }" << ENDL;
+    os << "}" << ENDL;
+    os << ENDL;
+
+    // uniform numbers in (0,1) from the upper 23 (float) or 52 (double) bits; with one bit less than the
+    // mantissa, the centre k + 1/2 of every interval is exact and the largest one is 1 - 2^-24 (2^-53)
+    os << "GENN_RAND_INLINE " << model.ftype << " gennrandUniformBits(uint32_t a, uint32_t b)" << ENDL;
+    os << "{" << ENDL;
+    if (sp) {
+	os << "    return ((a >> 9) + 0.5f)*1.19209290e-07f;" << ENDL;
+    }
+    else {
+	os << "    return ((((uint64_t) a << 20) | (b >> 12)) + 0.5)*2.2204460492503131e-16;" << ENDL;
+    }
+    os << "}" << ENDL;
+    os << ENDL;
+    os << "GENN_RAND_INLINE " << model.ftype << " gennrandUniform(uint32_t seed, uint32_t group, uint32_t id, unsigned long long step, uint32_t n)" << ENDL;
+    os << "{" << ENDL;
+    os << "    uint32_t c[4]= {id, n, (uint32_t) step, (uint32_t) (step >> 32)};" << ENDL;
+    os << "    gennPhilox(c, seed, group);" << ENDL;
+    os << "    return gennrandUniformBits(c[0], c[1]);" << ENDL;
+    os << "}" << ENDL;
+    os << ENDL;
+    // Box-Muller transform of the two uniform numbers of one draw
+    os << "GENN_RAND_INLINE " << model.ftype << " gennrandNormal(uint32_t seed, uint32_t group, uint32_t id, unsigned long long step, uint32_t n)" << ENDL;
+    os << "{" << ENDL;
+    os << "    uint32_t c[4]= {id, n, (uint32_t) step, (uint32_t) (step >> 32)};" << ENDL;
+    os << "    gennPhilox(c, seed, group);" << ENDL;
+    os << "    " << model.ftype << " u= gennrandUniformBits(c[0], c[1]);" << ENDL;
+    os << "    " << model.ftype << " v= gennrandUniformBits(c[2], c[3]);" << ENDL;
+    os << "    return sqrt" << F << "(" << ftypeConstant(-2.0, model.ftype) << "*log" << F << "(u))*cos" << F << "(" << ftypeConstant(6.2831853071795865, model.ftype) << "*v);" << ENDL;
+    os << "}" << ENDL;
+    os << ENDL;
+    // inversion of the geometric distribution of the number of failed trials
+    os << "// time step of the first event of a Bernoulli process with probability p per time step that starts in" << ENDL;
+    os << "// time step from, for u uniform in (0,1); ~0ULL if there is no event" << ENDL;
+    os << "GENN_RAND_INLINE unsigned long long gennrandNextEvent(unsigned long long from, " << model.ftype << " u, " << model.ftype << " p)" << ENDL;
+    os << "{" << ENDL;
+    os << "    if (!(p > " << ftypeConstant(0.0, model.ftype) << ")) return ~0ULL;" << ENDL;
+    os << "    if (p >= " << ftypeConstant(1.0, model.ftype) << ") return from;" << ENDL;
+    os << "    " << model.ftype << " k= floor" << F << "(log" << F << "(u)/log1p" << F << "(-p));" << ENDL;
+    os << "    return (k < " << ftypeConstant(1.0e18, model.ftype) << ") ? from + (unsigned long long) k : ~0ULL;" << ENDL;
+    os << "}" << ENDL;
+    os << ENDL;
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief This function generates the code that clears the reschedule flags of the event-driven Poisson neuron groups after the neurons have been updated.
+*/
+//--------------------------------------------------------------------------
+
+static void genRescheduleDone(ostream &os, NNmodel &model)
+{
+    for (int i = 0; i < model.neuronGrpN; i++) {
+	if (model.neuronType[i] == POISSONNEURON_EVENT) {
+	    os << "    reschedule" << model.neuronName[i] << " = false;" << ENDL;
+	}
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief This function returns the type of the extra global parameter that the c-th channel of a model is bound to, or "" for spike output channels.
+*/
+//--------------------------------------------------------------------------
+
+static string channelParaType(NNmodel &model, unsigned int c)
+{
+    if (model.channelParameter[c] == tS("")) return tS("");
+    neuronModel &nm= nModels[model.neuronType[model.channelNeuronGrp[c]]];
+    unsigned int k= find(nm.extraGlobalNeuronKernelParameters.begin(), nm.extraGlobalNeuronKernelParameters.end(), model.channelParameter[c]) - nm.extraGlobalNeuronKernelParameters.begin();
+    return nm.extraGlobalNeuronKernelParameterTypes[k];
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief This function returns the size of a message of the c-th channel of a model as an expression of the generated code.
+*/
+//--------------------------------------------------------------------------
+
+static string channelMessageSize(NNmodel &model, unsigned int c)
+{
+    string type= channelParaType(model, c);
+    if (type == tS("")) return "GENN_CHANNEL_SPIKE_SLOT_SIZE(" + tS(model.channelSize[c]) + ")";
+    size_t star= type.rfind('*');
+    if (star == string::npos) return "sizeof(" + type + ")";
+    type= type.substr(0, star);
+    type.erase(type.find_last_not_of(' ') + 1);
+    return tS(model.channelSize[c]) + " * sizeof(" + type + ")";
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief This function generates the code that opens the shared-memory channels of a model (see gennChannel.h); channels of groups on other MPI ranks stay closed.
+*/
+//--------------------------------------------------------------------------
+
+static void genChannelOpen(ostream &os, NNmodel &model)
+{
+    for (int c = 0; c < model.channelFile.size(); c++) {
+	unsigned int i= model.channelNeuronGrp[c];
+#ifdef CPU_ONLY
+	if (cpuHosts(model).size() > 1) {
+	    os << "    if (genn_rank == " << model.neuronHostID[i] << ")" << OB(1150);
+	}
+#endif
+	os << "    gennChannels[" << c << "]= gennChannelOpen(\"" << model.channelFile[c] << "\", " << channelMessageSize(model, c) << ", " << model.channelSlots[c] << ");" << ENDL;
+	os << "    if (gennChannels[" << c << "] == NULL) gennError(\"Could not open the channel " << model.channelFile[c] << " of group " << model.neuronName[i] << "; the file may hold a channel with different sizes.\");" << ENDL;
+#ifndef CPU_ONLY
+	if (channelParaType(model, c).find("*") != string::npos) {
+	    os << "    gennChannelBuffer" << c << "= new char[" << channelMessageSize(model, c) << "];" << ENDL;
+	}
+#endif
+#ifdef CPU_ONLY
+	if (cpuHosts(model).size() > 1) {
+	    os << CB(1150);
+	}
+#endif
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief This function generates the code that closes the shared-memory channels of a model.
+*/
+//--------------------------------------------------------------------------
+
+static void genChannelClose(ostream &os, NNmodel &model)
+{
+    for (int c = 0; c < model.channelFile.size(); c++) {
+	os << "    gennChannelClose(gennChannels[" << c << "]);" << ENDL;
+	os << "    gennChannels[" << c << "]= NULL;" << ENDL;
+#ifndef CPU_ONLY
+	if (channelParaType(model, c).find("*") != string::npos) {
+	    os << "    delete[] gennChannelBuffer" << c << ";" << ENDL;
+	    os << "    gennChannelBuffer" << c << "= NULL;" << ENDL;
+	}
+#endif
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief This function generates the code that copies the newest messages of the input channels of a model into their parameters at the start of a time step.
+
+  Pointer parameters point to device memory in stepTimeGPU(), into which the messages are copied from a host buffer. A new message for an event-driven Poisson group requests the rescheduling of its spikes.
+*/
+//--------------------------------------------------------------------------
+
+static void genChannelInput(ostream &os, NNmodel &model, bool gpu)
+{
+    for (int c = 0; c < model.channelFile.size(); c++) {
+	if (model.channelParameter[c] == tS("")) continue;
+	unsigned int i= model.channelNeuronGrp[c];
+	string para= model.channelParameter[c] + model.neuronName[i];
+	os << "    if (";
+#ifdef CPU_ONLY
+	if (cpuHosts(model).size() > 1) {
+	    os << "(gennChannels[" << c << "] != NULL) && ";
+	}
+#endif
+	if (channelParaType(model, c).find("*") == string::npos) {
+	    os << "gennChannelPopLatest(gennChannels[" << c << "], &" << para << ", " << channelMessageSize(model, c) << "))" << OB(1151);
+	}
+	else if (gpu) {
+	    os << "gennChannelPopLatest(gennChannels[" << c << "], gennChannelBuffer" << c << ", " << channelMessageSize(model, c) << "))" << OB(1151);
+	    os << "CHECK_CUDA_ERRORS(cudaMemcpy(" << para << ", gennChannelBuffer" << c << ", " << channelMessageSize(model, c) << ", cudaMemcpyHostToDevice));" << ENDL;
+	}
+	else {
+	    os << "gennChannelPopLatest(gennChannels[" << c << "], " << para << ", " << channelMessageSize(model, c) << "))" << OB(1151);
+	}
+	if ((model.neuronType[i] == POISSONNEURON_EVENT) && (model.channelParameter[c] != tS("reschedule"))) {
+	    os << "reschedule" << model.neuronName[i] << "= true;" << ENDL;
+	}
+	os << CB(1151);
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief This function generates the code that sends the spikes of the current time step to the spike output channels of a model.
+
+  The spikes are only copied from the GPU if the channel has room for the message.
+*/
+//--------------------------------------------------------------------------
+
+static void genChannelOutput(ostream &os, NNmodel &model, bool gpu)
+{
+    for (int c = 0; c < model.channelFile.size(); c++) {
+	if (model.channelParameter[c] != tS("")) continue;
+	unsigned int i= model.channelNeuronGrp[c];
+	string cnt= "glbSpkCnt" + model.neuronName[i] + "[0]";
+	string spk= "glbSpk" + model.neuronName[i];
+	if (model.neuronNeedTrueSpk[i] && (model.neuronDelaySlots[i] > 1)) {
+	    cnt= "glbSpkCnt" + model.neuronName[i] + "[spkQuePtr" + model.neuronName[i] + "]";
+	    spk= "glbSpk" + model.neuronName[i] + " + spkQuePtr" + model.neuronName[i] + " * " + tS(model.neuronN[i]);
+	}
+	os << OB(1152);
+	os << "char *msg= ";
+#ifdef CPU_ONLY
+	if (cpuHosts(model).size() > 1) {
+	    os << "(gennChannels[" << c << "] == NULL) ? NULL : ";
+	}
+#endif
+	os << "(char *) gennChannelReserve(gennChannels[" << c << "]);" << ENDL;
+	os << "if (msg != NULL)" << OB(1153);
+	if (gpu) {
+	    os << "pull" << model.neuronName[i] << "CurrentSpikesFromDevice();" << ENDL;
+	}
+	os << "memcpy(msg, &iT, sizeof(unsigned long long));" << ENDL;
+	os << "memcpy(msg + 8, &" << cnt << ", sizeof(unsigned int));" << ENDL;
+	os << "memcpy(msg + 12, " << spk << ", " << cnt << " * sizeof(unsigned int));" << ENDL;
+	os << "gennChannelCommit(gennChannels[" << c << "]);" << ENDL;
+	os << CB(1153);
+	os << CB(1152);
+    }
+}
+
+
+#ifdef CPU_ONLY
+//--------------------------------------------------------------------------
+//! \brief This function generates the code of the slot of the spike queue of a neuron group that holds the spikes of the j-th of the last window time steps.
+//--------------------------------------------------------------------------
+
+static string spike_slot(NNmodel &model, int i, unsigned int window)
+{
+    if (!model.neuronNeedTrueSpk[i] || (model.neuronDelaySlots[i] == 1)) return tS("0");
+    unsigned int slots= model.neuronDelaySlots[i];
+    return "(spkQuePtr" + model.neuronName[i] + " + " + tS(slots - window + 1) + " + j) % " + tS(slots);
+}
+
+
+//--------------------------------------------------------------------------
+/*!
+  \brief This function generates exchangeSpikes(), which sends the spikes of the last window time steps of the neuron groups of this process that are presynaptic to groups of other processes to all processes, and puts the spikes received from other processes into the spike queues of their groups.
+
+  The spikes are exchanged with two collective operations, MPI_Allgather for their numbers and MPI_Allgatherv for the spikes.
+*/
+//--------------------------------------------------------------------------
+
+static void genSpikeExchange(ostream &os, NNmodel &model, unsigned int window)
+{
+    os << "// ------------------------------------------------------------------------" << ENDL;
+    os << "// exchange of the spikes of the last " << window << " time step(s) between the processes" << ENDL;
+    os << "static void exchangeSpikes()" << ENDL;
+    os << "{" << ENDL;
+    os << "    static std::vector<unsigned int> sendBuf, recvBuf;" << ENDL;
+    os << "    static std::vector<int> recvN, displs;" << ENDL;
+    os << "    sendBuf.clear();" << ENDL;
+    for (int i = 0; i < model.neuronGrpN; i++) {
+	if (!exportsSpikes(model, i)) continue;
+	os << "    if (genn_rank == " << model.neuronHostID[i] << ") {" << ENDL;
+	os << "        for (unsigned int j= 0; j < " << window << "; j++) {" << ENDL;
+	os << "            unsigned int slot= " << spike_slot(model, i, window) << ";" << ENDL;
+	os << "            unsigned int *spikes= glbSpk" << model.neuronName[i] << " + slot * " << model.neuronN[i] << ";" << ENDL;
+	os << "            sendBuf.push_back(glbSpkCnt" << model.neuronName[i] << "[slot]);" << ENDL;
+	os << "            sendBuf.insert(sendBuf.end(), spikes, spikes + glbSpkCnt" << model.neuronName[i] << "[slot]);" << ENDL;
+	os << "        }" << ENDL;
+	os << "    }" << ENDL;
+    }
+    os << "    int sendN= sendBuf.size();" << ENDL;
+    os << "    sendBuf.push_back(0);" << ENDL;
+    os << "    recvN.resize(genn_ranks);" << ENDL;
+    os << "    displs.resize(genn_ranks);" << ENDL;
+    os << "    MPI_Allgather(&sendN, 1, MPI_INT, &recvN[0], 1, MPI_INT, MPI_COMM_WORLD);" << ENDL;
+    os << "    int recvSize= 0;" << ENDL;
+    os << "    for (int r= 0; r < genn_ranks; r++) {" << ENDL;
+    os << "        displs[r]= recvSize;" << ENDL;
+    os << "        recvSize+= recvN[r];" << ENDL;
+    os << "    }" << ENDL;
+    os << "    recvBuf.resize(recvSize + 1);" << ENDL;
+    os << "    MPI_Allgatherv(&sendBuf[0], sendN, MPI_UNSIGNED, &recvBuf[0], &recvN[0], &displs[0], MPI_UNSIGNED, MPI_COMM_WORLD);" << ENDL;
+    os << "    for (int r= 0; r < genn_ranks; r++) {" << ENDL;
+    os << "        if (r == genn_rank) continue;" << ENDL;
+    os << "        unsigned int *spikes= &recvBuf[displs[r]];" << ENDL;
+    for (int i = 0; i < model.neuronGrpN; i++) {
+	if (!exportsSpikes(model, i)) continue;
+	os << "        if (r == " << model.neuronHostID[i] << ") {" << ENDL;
+	os << "            for (unsigned int j= 0; j < " << window << "; j++) {" << ENDL;
+	os << "                unsigned int slot= " << spike_slot(model, i, window) << ";" << ENDL;
+	os << "                glbSpkCnt" << model.neuronName[i] << "[slot]= *(spikes++);" << ENDL;
+	os << "                memcpy(glbSpk" << model.neuronName[i] << " + slot * " << model.neuronN[i] << ", spikes, glbSpkCnt" << model.neuronName[i] << "[slot] * sizeof(unsigned int));" << ENDL;
+	os << "                spikes+= glbSpkCnt" << model.neuronName[i] << "[slot];" << ENDL;
+	os << "            }" << ENDL;
+	os << "        }" << ENDL;
+    }
+    os << "    }" << ENDL;
+    os << "}" << ENDL;
+    os << ENDL;
+}
+#endif
+
+
 //--------------------------------------------------------------------------
 /*!
   \brief A function that generates predominantly host-side code.
@@ -79,7 +744,7 @@ void genRunner(NNmodel &model, //!< Model description
     unsigned int nt, st, pst;
     unsigned int mem = 0;
     float memremsparse= 0;
-    ofstream os;
+    GeneratedFile os;
         
     string SCLR_MIN;
     string SCLR_MAX;
@@ -97,6 +762,7 @@ void genRunner(NNmodel &model, //!< Model description
 	for (int k= 0; k < nModels[i].varTypes.size(); k++) {
 	    substitute(nModels[i].varTypes[k], "scalar", model.ftype);
 	}
+	substitute(nModels[i].simCode, "$(updateGates)", nModels[i].gateUpdateCode());
 	substitute(nModels[i].simCode, "SCALAR_MIN", SCLR_MIN);
 	substitute(nModels[i].resetCode, "SCALAR_MIN", SCLR_MIN);
 	substitute(nModels[i].simCode, "SCALAR_MAX", SCLR_MAX);
@@ -207,6 +873,65 @@ void genRunner(NNmodel &model, //!< Model description
     os << "#endif" << ENDL;
     os << ENDL;
 
+    // inline math functions of the fast and approximate math precision tiers
+    if ((model.mathPrecision != GENN_MATH_EXACT) && ((model.ftype == "float") || (model.ftype == "double"))) {
+	os << "#include <cmath>" << ENDL;
+	os << ENDL;
+	genFastMath(os, model);
+    }
+
+    // counter-based random numbers of the code snippets of neurons
+    if (model.needGennrand) {
+	os << "#include <cmath>" << ENDL;
+	os << ENDL;
+	genGennrand(os, model);
+    }
+
+#ifdef CPU_ONLY
+    // hosts of a distributed model
+    if (cpuHosts(model).size() > 1) {
+	os << "// the groups of the model are simulated by several processes (MPI ranks), which exchange spikes; genn_rank is" << ENDL;
+	os << "// the rank of this process, which simulates the groups with this host ID" << ENDL;
+	os << "extern int genn_rank;" << ENDL;
+	os << "extern int genn_ranks;" << ENDL;
+	os << ENDL;
+    }
+#endif
+
+    // instruction set levels of the multiversioned CPU functions
+    if (GENN_PREFERENCES::multiversionCPUCode) {
+	os << "// the CPU simulation functions are compiled for several x86 instruction set levels; allocateMem() sets" << ENDL;
+	os << "// genn_isa to the best level the CPU supports, at most GENN_PREFERENCES::maxCPUISA or the level named by the" << ENDL;
+	os << "// environment variable GENN_ISA; the generated Makefile compiles them with -ffp-contract=off, so that all" << ENDL;
+	os << "// levels give the same results" << ENDL;
+	os << "#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(__CUDACC__) && !defined(GENN_NO_ISA_DISPATCH)" << ENDL;
+	os << "#define GENN_ISA_DISPATCH" << ENDL;
+	os << "#define GENN_ISA_INLINE inline __attribute__((always_inline))" << ENDL;
+	os << "#define GENN_TARGET_SSE42 __attribute__((target(\"sse4.2,popcnt\")))" << ENDL;
+	os << "#define GENN_TARGET_AVX2 __attribute__((target(\"avx2,fma\")))" << ENDL;
+	os << "#define GENN_TARGET_AVX512 __attribute__((target(\"avx512f,avx512vl,avx512bw,avx512dq,avx2,fma\")))" << ENDL;
+	os << "enum { GENN_ISA_DEFAULT, GENN_ISA_SSE42, GENN_ISA_AVX2, GENN_ISA_AVX512 };" << ENDL;
+	os << "extern int genn_isa;" << ENDL;
+	os << "#else" << ENDL;
+	os << "#define GENN_ISA_INLINE inline" << ENDL;
+	os << "#endif" << ENDL;
+	os << ENDL;
+    }
+
+    // size of the L2 cache and prefetching for the propagation of the spikes of SPARSE synapse groups
+    if (needL2CacheSize(model)) {
+	os << "// sizes of the L2 cache and of the last level cache in bytes, which allocateMem() takes from the system or the" << ENDL;
+	os << "// environment variables GENN_L2_CACHE_SIZE and GENN_LL_CACHE_SIZE" << ENDL;
+	os << "extern size_t genn_L2CacheSize;" << ENDL;
+	os << "extern size_t genn_LLCacheSize;" << ENDL;
+	os << "#if defined(__GNUC__) && !defined(__CUDACC__)" << ENDL;
+	os << "#define GENN_PREFETCH(addr) __builtin_prefetch(addr)" << ENDL;
+	os << "#else" << ENDL;
+	os << "#define GENN_PREFETCH(addr)" << ENDL;
+	os << "#endif" << ENDL;
+	os << ENDL;
+    }
+
 
     //-----------------
     // GLOBAL VARIABLES
@@ -217,6 +942,9 @@ void genRunner(NNmodel &model, //!< Model description
 
     os << "extern unsigned long long iT;" << ENDL;
     os << "extern " << model.ftype << " t;" << ENDL;
+    if (model.needGennrand) {
+	os << "extern unsigned int gennrandSeed;" << ENDL;
+    }
     if (model.timing) {
 #ifndef CPU_ONLY
 	os << "extern cudaEvent_t neuronStart, neuronStop;" << ENDL;
@@ -346,6 +1074,10 @@ void genRunner(NNmodel &model, //!< Model description
 	if (model.synapseConnType[i] == SPARSE) {
 	    os << "extern SparseProjection C" << model.synapseName[i] << ";" << ENDL;
 	}
+	if (pullsSpikes(model, i)) {
+	    os << "extern unsigned int pullThreshold" << model.synapseName[i] << "; // the spikes are pulled into the targets if more neurons spike" << ENDL;
+	    os << "extern unsigned long long pushSteps" << model.synapseName[i] << ", pullSteps" << model.synapseName[i] << "; // number of times each way was taken" << ENDL;
+	}
 	if (model.synapseGType[i] == INDIVIDUALG) { // not needed for GLOBALG, INDIVIDUALID
 	    for (int k = 0, l = weightUpdateModels[st].varNames.size(); k < l; k++) {
 		extern_variable_def(os, weightUpdateModels[st].varTypes[k]+" *", weightUpdateModels[st].varNames[k]+model.synapseName[i]);
@@ -360,6 +1092,10 @@ void genRunner(NNmodel &model, //!< Model description
     }
     os << ENDL;
 
+    if (hasRuntimeParas(model)) {
+	genRuntimeParas(os, model, true);
+    }
+
     os << "#define Conductance SparseProjection" << ENDL;
     os << "/*struct Conductance is deprecated. \n\
   By GeNN 2.0, Conductance is renamed as SparseProjection and contains only indexing values. \n\
@@ -662,7 +1398,29 @@ void genRunner(NNmodel &model, //!< Model description
     os << "#define RUNNER_CC_COMPILE" << ENDL;
     os << ENDL;
     os << "#include \"definitions.h\"" << ENDL;
+    if (hasRuntimeParas(model)) {
+	os << "#include \"modelSpec.h\"" << ENDL;
+    }
+#ifdef CPU_ONLY
+    os << "#include \"arenaUtils.h\"" << ENDL;
+    if (cpuNodes(model).size() > 1) {
+	os << "#include \"numaUtils.h\"" << ENDL;
+    }
+    if (cpuHosts(model).size() > 1) {
+	os << "#include <mpi.h>" << ENDL;
+	os << "#include <vector>" << ENDL;
+    }
+#endif
+    if (model.channelFile.size() > 0) {
+	os << "#include \"gennChannel.h\"" << ENDL;
+    }
+    if (needL2CacheSize(model)) {
+	os << "#ifndef _WIN32" << ENDL;
+	os << "#include <unistd.h>" << ENDL;
+	os << "#endif" << ENDL;
+    }
     os << "#include <cstdlib>" << ENDL;
+    os << "#include <cstring>" << ENDL;
     os << "#include <cstdio>" << ENDL;
     os << "#include <cmath>" << ENDL;
     os << "#include <ctime>" << ENDL;
@@ -680,6 +1438,30 @@ void genRunner(NNmodel &model, //!< Model description
 
     os << "unsigned long long iT= 0;" << ENDL;
     os << model.ftype << " t;" << ENDL;
+    if (model.needGennrand) {
+	os << "unsigned int gennrandSeed;" << ENDL;
+    }
+    if (GENN_PREFERENCES::multiversionCPUCode) {
+	os << "#ifdef GENN_ISA_DISPATCH" << ENDL;
+	os << "int genn_isa= GENN_ISA_DEFAULT;" << ENDL;
+	os << "#endif" << ENDL;
+    }
+    if (needL2CacheSize(model)) {
+	os << "size_t genn_L2CacheSize= 262144;" << ENDL;
+	os << "size_t genn_LLCacheSize= 8388608;" << ENDL;
+    }
+#ifdef CPU_ONLY
+    if (cpuHosts(model).size() > 1) {
+	os << "int genn_rank= 0;" << ENDL;
+	os << "int genn_ranks= 1;" << ENDL;
+	os << "static bool genn_mpiStarted= false; // whether allocateMem() started MPI, so that exitGeNN() finishes it" << ENDL;
+    }
+#endif
+    os << "#ifdef GENN_PGO_STEPS" << ENDL;
+    os << "// number of time steps after which the profiling run of a profile-guided build ends (0: never); volatile, so that" << ENDL;
+    os << "// the code of stepTime is the same in the instrumented and the optimised build" << ENDL;
+    os << "volatile unsigned long long genn_pgoSteps= GENN_PGO_STEPS;" << ENDL;
+    os << "#endif" << ENDL;
     if (model.timing) {
 #ifndef CPU_ONLY
 	os << "cudaEvent_t neuronStart, neuronStop;" << ENDL;
@@ -764,6 +1546,10 @@ void genRunner(NNmodel &model, //!< Model description
 	if (model.synapseGType[i] == INDIVIDUALID) {
 	    variable_def(os, tS("uint32_t *"), "gp"+model.synapseName[i]);
 	}
+	if (pullsSpikes(model, i)) {
+	    os << "unsigned int pullThreshold" << model.synapseName[i] << "= " << (unsigned int) (GENN_PREFERENCES::pullSpikeFraction * model.neuronN[model.synapseSource[i]]) << ";" << ENDL;
+	    os << "unsigned long long pushSteps" << model.synapseName[i] << "= 0, pullSteps" << model.synapseName[i] << "= 0;" << ENDL;
+	}
 	if (model.synapseConnType[i] == SPARSE) {
 	    os << "SparseProjection C" << model.synapseName[i] << ";" << ENDL;
 #ifndef CPU_ONLY
@@ -800,6 +1586,10 @@ void genRunner(NNmodel &model, //!< Model description
     }
     os << ENDL;
 
+    if (hasRuntimeParas(model)) {
+	genRuntimeParas(os, model, false);
+    }
+
 
     //--------------------------
     // HOST AND DEVICE FUNCTIONS
@@ -836,25 +1626,108 @@ void genRunner(NNmodel &model, //!< Model description
     os << "    }" << ENDL;
     os << "}" << ENDL << ENDL;
 
+    // shared-memory channels, which stepTimeCPU() and stepTimeGPU() read and write
+    if (model.channelFile.size() > 0) {
+	os << "static gennChannel *gennChannels[" << model.channelFile.size() << "];" << ENDL;
+#ifndef CPU_ONLY
+	for (int c = 0; c < model.channelFile.size(); c++) {
+	    if (channelParaType(model, c).find("*") != string::npos) {
+		os << "static char *gennChannelBuffer" << c << "= NULL;" << ENDL;
+	    }
+	}
+#endif
+	os << ENDL;
+    }
+
     // include simulation kernels
 #ifndef CPU_ONLY
     os << "#include \"runnerGPU.cc\"" << ENDL << ENDL;
 #endif
-    os << "#include \"neuronFnct.cc\"" << ENDL;
+
+    // CPU simulation functions, which are compiled separately from neuronFnct.cc and synapseFnct.cc
+    os << "void calcNeuronsCPU(" << model.ftype << " t);" << ENDL;
     if (model.synapseGrpN > 0) {
-	os << "#include \"synapseFnct.cc\"" << ENDL;
+	os << "void calcSynapseDynamicsCPU(" << model.ftype << " t);" << ENDL;
+	os << "void calcSynapsesCPU(" << model.ftype << " t);" << ENDL;
+	if (model.lrnGroups > 0) {
+	    os << "void learnSynapsesPostHost(" << model.ftype << " t);" << ENDL;
+	}
     }
+    os << ENDL;
 
 
     // ---------------------------------------------------------------------
     // Function for setting the CUDA device and the host's global variables.
     // Also estimates memory usage on device ...
   
+#ifdef CPU_ONLY
+    // the arrays are allocated from arenas; if the model runs on several NUMA nodes, the arrays of each node
+    // are first touched by its thread
+    vector<int> nodes= cpuNodes(model);
+    vector<vector<ArenaArray> > arena(nodes.size());
+    os << "static char *gennArena= NULL;" << ENDL;
+    for (int i = 0; i < model.synapseGrpN; i++) {
+	if (model.synapseConnType[i] == SPARSE) {
+	    os << "static char *gennArena" << model.synapseName[i] << "= NULL;" << ENDL;
+	}
+    }
+    os << ENDL;
+    if (nodes.size() > 1) {
+	os << "static void numaFirstTouch(int node, void *);" << ENDL << ENDL;
+    }
+#endif
     os << "void allocateMem()" << ENDL;
     os << "{" << ENDL;
+#ifdef CPU_ONLY
+    vector<int> hosts= cpuHosts(model);
+    if (hosts.size() > 1) {
+	os << "    // start MPI, unless the simulation did so already" << ENDL;
+	os << "    int mpiStarted;" << ENDL;
+	os << "    MPI_Initialized(&mpiStarted);" << ENDL;
+	os << "    if (!mpiStarted) {" << ENDL;
+	os << "        MPI_Init(NULL, NULL);" << ENDL;
+	os << "        genn_mpiStarted= true;" << ENDL;
+	os << "    }" << ENDL;
+	os << "    MPI_Comm_rank(MPI_COMM_WORLD, &genn_rank);" << ENDL;
+	os << "    MPI_Comm_size(MPI_COMM_WORLD, &genn_ranks);" << ENDL;
+	os << "    if (genn_ranks <= " << hosts.back() << ") {" << ENDL;
+	os << "        gennError(\"The model " << model.name << " needs at least " << hosts.back() + 1 << " MPI processes.\");" << ENDL;
+	os << "    }" << ENDL;
+    }
+#endif
 #ifndef CPU_ONLY
     os << "    CHECK_CUDA_ERRORS(cudaSetDevice(" << theDevice << "));" << ENDL;
 #endif
+    if (GENN_PREFERENCES::multiversionCPUCode) {
+	os << "#ifdef GENN_ISA_DISPATCH" << ENDL;
+	os << "    // choose the instruction set level of the CPU simulation functions" << ENDL;
+	os << "    const char *maxISA= getenv(\"GENN_ISA\");" << ENDL;
+	const char *levels[]= {"GENN_ISA_DEFAULT", "GENN_ISA_SSE42", "GENN_ISA_AVX2", "GENN_ISA_AVX512"};
+	os << "    int maxLevel= " << levels[min(GENN_PREFERENCES::maxCPUISA, 3u)] << ";" << ENDL;
+	os << "    if (maxISA != NULL) {" << ENDL;
+	os << "        if (strcmp(maxISA, \"default\") == 0) maxLevel= GENN_ISA_DEFAULT;" << ENDL;
+	os << "        else if (strcmp(maxISA, \"sse4.2\") == 0) maxLevel= GENN_ISA_SSE42;" << ENDL;
+	os << "        else if (strcmp(maxISA, \"avx2\") == 0) maxLevel= GENN_ISA_AVX2;" << ENDL;
+	os << "        else if (strcmp(maxISA, \"avx512\") == 0) maxLevel= GENN_ISA_AVX512;" << ENDL;
+	os << "    }" << ENDL;
+	os << "    __builtin_cpu_init();" << ENDL;
+	os << "    genn_isa= GENN_ISA_DEFAULT;" << ENDL;
+	os << "    if (__builtin_cpu_supports(\"avx512f\") && __builtin_cpu_supports(\"avx512vl\") && __builtin_cpu_supports(\"avx512bw\") && __builtin_cpu_supports(\"avx512dq\")) genn_isa= GENN_ISA_AVX512;" << ENDL;
+	os << "    else if (__builtin_cpu_supports(\"avx2\") && __builtin_cpu_supports(\"fma\")) genn_isa= GENN_ISA_AVX2;" << ENDL;
+	os << "    else if (__builtin_cpu_supports(\"sse4.2\") && __builtin_cpu_supports(\"popcnt\")) genn_isa= GENN_ISA_SSE42;" << ENDL;
+	os << "    if (genn_isa > maxLevel) genn_isa= maxLevel;" << ENDL;
+	os << "#endif" << ENDL;
+    }
+    if (needL2CacheSize(model)) {
+	os << "    // cache sizes, which decide how the spikes of SPARSE synapse groups are propagated" << ENDL;
+	os << "#ifdef _SC_LEVEL2_CACHE_SIZE" << ENDL;
+	os << "    if (sysconf(_SC_LEVEL2_CACHE_SIZE) > 0) genn_L2CacheSize= sysconf(_SC_LEVEL2_CACHE_SIZE);" << ENDL;
+	os << "    if (sysconf(_SC_LEVEL3_CACHE_SIZE) > 0) genn_LLCacheSize= sysconf(_SC_LEVEL3_CACHE_SIZE);" << ENDL;
+	os << "    else if (sysconf(_SC_LEVEL2_CACHE_SIZE) > 0) genn_LLCacheSize= sysconf(_SC_LEVEL2_CACHE_SIZE);" << ENDL;
+	os << "#endif" << ENDL;
+	os << "    if (getenv(\"GENN_L2_CACHE_SIZE\") != NULL) genn_L2CacheSize= strtoul(getenv(\"GENN_L2_CACHE_SIZE\"), NULL, 10);" << ENDL;
+	os << "    if (getenv(\"GENN_LL_CACHE_SIZE\") != NULL) genn_LLCacheSize= strtoul(getenv(\"GENN_LL_CACHE_SIZE\"), NULL, 10);" << ENDL;
+    }
     //cout << "model.neuronGroupN " << model.neuronGrpN << ENDL;
     //os << "    " << model.ftype << " free_m, total_m;" << ENDL;
     //os << "    cudaMemGetInfo((size_t*) &free_m, (size_t*) &total_m);" << ENDL;
@@ -907,7 +1780,7 @@ void genRunner(NNmodel &model, //!< Model description
 	os << size << " * sizeof(unsigned int));" << ENDL;
 	mem += size * sizeof(unsigned int);
 #else
-	os << "glbSpkCnt" << model.neuronName[i] << " = new unsigned int[" << size << "];" << ENDL;
+	arena_array(arena, neuronCPUNode(model, i), "unsigned int", "glbSpkCnt" + model.neuronName[i], tS(size));
 #endif
 
 	if (model.neuronNeedTrueSpk[i]) {
@@ -925,7 +1798,7 @@ void genRunner(NNmodel &model, //!< Model description
 	os << size << " * sizeof(unsigned int));" << ENDL;
 	mem += size * sizeof(unsigned int);
 #else
-	os << "glbSpk" << model.neuronName[i] << " = new unsigned int[" << size << "];" << ENDL;
+	arena_array(arena, neuronCPUNode(model, i), "unsigned int", "glbSpk" + model.neuronName[i], tS(size));
 #endif
 
 	if (model.neuronNeedSpkEvnt[i]) {
@@ -939,7 +1812,7 @@ void genRunner(NNmodel &model, //!< Model description
 	    os << size << " * sizeof(unsigned int));" << ENDL;
 	    mem += size * sizeof(unsigned int);
 #else
-	    os << "glbSpkCntEvnt" << model.neuronName[i] << " = new unsigned int[" << size << "];" << ENDL;
+	    arena_array(arena, neuronCPUNode(model, i), "unsigned int", "glbSpkCntEvnt" + model.neuronName[i], tS(size));
 #endif
 
 	    size = model.neuronN[i] * model.neuronDelaySlots[i];
@@ -952,7 +1825,7 @@ void genRunner(NNmodel &model, //!< Model description
 	    os << size << " * sizeof(unsigned int));" << ENDL;
 	    mem += size * sizeof(unsigned int);
 #else
-	    os << "glbSpkEvnt" << model.neuronName[i] << " = new unsigned int[" << size << "];" << ENDL;
+	    arena_array(arena, neuronCPUNode(model, i), "unsigned int", "glbSpkEvnt" + model.neuronName[i], tS(size));
 #endif
 
 	}
@@ -968,7 +1841,7 @@ void genRunner(NNmodel &model, //!< Model description
 	    os << size << " * sizeof(" << model.ftype << "));" << ENDL;
 	    mem += size * theSize(model.ftype);
 #else
-	    os << "sT" << model.neuronName[i] << " = new " << model.ftype << "[" << size << "];" << ENDL;
+	    arena_array(arena, neuronCPUNode(model, i), model.ftype, "sT" + model.neuronName[i], tS(size));
 #endif
 
 	}
@@ -990,12 +1863,13 @@ void genRunner(NNmodel &model, //!< Model description
 	    os << size << " * sizeof(" << nModels[nt].varTypes[j] << "));" << ENDL;
 	    mem += size * theSize(nModels[nt].varTypes[j]);
 #else
-	    os << nModels[nt].varNames[j] + model.neuronName[i];
-	    os << " = new " << nModels[nt].varTypes[j] << "[" << size << "];" << ENDL;
+	    arena_array(arena, neuronCPUNode(model, i), nModels[nt].varTypes[j], nModels[nt].varNames[j] + model.neuronName[i], tS(size));
 #endif
 
 	}
+#ifndef CPU_ONLY
 	os << ENDL; 
+#endif
     }
 
     // ALLOCATE SYNAPSE VARIABLES
@@ -1012,7 +1886,9 @@ void genRunner(NNmodel &model, //!< Model description
 	os << ", " << size << " * sizeof(" << model.ftype << "));" << ENDL; 
 	mem += size * theSize(model.ftype);
 #else
-	os << "inSyn" << model.synapseName[i] << " = new " << model.ftype << "[" << size << "];" << ENDL;
+	if (inSynGroup(model, i) == i) {
+	    arena_array(arena, synapseCPUNode(model, i), model.ftype, "inSyn" + model.synapseName[i], tS(size));
+	}
 #endif
 
 	// note, if GLOBALG we put the value at compile time
@@ -1027,7 +1903,7 @@ void genRunner(NNmodel &model, //!< Model description
 	    os << ", " << size << " * sizeof(uint32_t));" << ENDL;
 	    mem += size * sizeof(uint32_t);
 #else
-	    os << "gp" << model.synapseName[i] << " = new uint32_t[" << size << "];" << ENDL;
+	    arena_array(arena, synapseCPUNode(model, i), "uint32_t", "gp" + model.synapseName[i], tS(size));
 #endif
 
 	}
@@ -1046,8 +1922,7 @@ void genRunner(NNmodel &model, //!< Model description
 		os << ", " << size << " * sizeof(" << weightUpdateModels[st].varTypes[k] << "));" << ENDL; 
 		mem += size * theSize(weightUpdateModels[st].varTypes[k]);
 #else
-		os << weightUpdateModels[st].varNames[k] << model.synapseName[i];
-		os << " = new " << weightUpdateModels[st].varTypes[k] << "[" << size << "];" << ENDL;
+		arena_array(arena, synapseCPUNode(model, i), weightUpdateModels[st].varTypes[k], weightUpdateModels[st].varNames[k] + model.synapseName[i], tS(size));
 #endif
 
 	    } 
@@ -1065,16 +1940,54 @@ void genRunner(NNmodel &model, //!< Model description
 		os << ", " << size << " * sizeof(" << postSynModels[pst].varTypes[k] << "));" << ENDL;      
 		mem += size * theSize(postSynModels[pst].varTypes[k]);
 #else
-		os << postSynModels[pst].varNames[k] + model.synapseName[i];
-		os << " = new " << postSynModels[pst].varTypes[k] << "[" << size << "];" << ENDL;
+		arena_array(arena, synapseCPUNode(model, i), postSynModels[pst].varTypes[k], postSynModels[pst].varNames[k] + model.synapseName[i], tS(size));
 #endif
 
 	    }
 	}
+#ifndef CPU_ONLY
 	os << ENDL;
+#endif
     }
+#ifdef CPU_ONLY
+    os << "    // allocate the arrays from one arena" << ENDL;
+    arena_alloc(os, "gennArena", arena);
+    for (int i = 0; i < model.synapseGrpN; i++) {
+	if (inSynGroup(model, i) != i) {
+	    os << "    inSyn" << model.synapseName[i] << "= inSyn" << model.synapseName[inSynGroup(model, i)] << "; // shared postsynaptic input" << ENDL;
+	}
+    }
+    if (nodes.size() > 1) {
+	os << "    // place the arrays on the NUMA nodes that simulate their groups" << ENDL;
+	os << "    const int nodes[]= {";
+	for (int n = 0; n < nodes.size(); n++) {
+	    os << (n > 0 ? ", " : "") << nodes[n];
+	}
+	os << "};" << ENDL;
+	os << "    numaStartWorkers(nodes, " << nodes.size() << ");" << ENDL;
+	os << "    numaRun(numaFirstTouch, NULL);" << ENDL;
+    }
+#endif
+    genChannelOpen(os, model);
     os << "}" << ENDL << ENDL;
 
+#ifdef CPU_ONLY
+    if (nodes.size() > 1) {
+	os << "static void numaFirstTouch(int node, void *)" << ENDL;
+	os << "{" << ENDL;
+	os << "    switch (node) {" << ENDL;
+	for (int n = 0; n < nodes.size(); n++) {
+	    os << "    case " << n << ":" << ENDL;
+	    for (int k = 0; k < arena[n].size(); k++) {
+		os << "        numaTouch(" << arena[n][k].name << ", " << arena[n][k].size << ");" << ENDL;
+	    }
+	    os << "        break;" << ENDL;
+	}
+	os << "    }" << ENDL;
+	os << "}" << ENDL << ENDL;
+    }
+#endif
+
 
     // ------------------------------------------------------------------------
     // initializing variables
@@ -1090,9 +2003,15 @@ void genRunner(NNmodel &model, //!< Model description
 
     if (model.seed == 0) {
 	os << "    srand((unsigned int) time(NULL));" << ENDL;
+	if (model.needGennrand) {
+	    os << "    gennrandSeed= (unsigned int) time(NULL);" << ENDL;
+	}
     }
     else {
 	os << "    srand((unsigned int) " << model.seed << ");" << ENDL;
+	if (model.needGennrand) {
+	    os << "    gennrandSeed= " << model.seed << ";" << ENDL;
+	}
     }
     os << ENDL;
 
@@ -1166,6 +2085,10 @@ void genRunner(NNmodel &model, //!< Model description
 	    os << "    }" << ENDL;
 	}
 
+	if (model.neuronType[i] == POISSONNEURON_EVENT) {
+	    os << "    reschedule" << model.neuronName[i] << " = true;" << ENDL;
+	}
+
 	if ((model.neuronType[i] == IZHIKEVICH) && (model.dt != 1.0)) {
 	    os << "    fprintf(stderr,\"WARNING: You use a time step different than 1 ms. Izhikevich model behaviour may not be robust.\\n\"); " << ENDL;
 	}
@@ -1178,9 +2101,11 @@ void genRunner(NNmodel &model, //!< Model description
 	st = model.synapseType[i];
 	pst = model.postSynapseType[i];
 
-	os << "    for (int i = 0; i < " << model.neuronN[model.synapseTarget[i]] << "; i++) {" << ENDL;
-	os << "        inSyn" << model.synapseName[i] << "[i] = " << model.scalarExpr(0.0) << ";" << ENDL;
-	os << "    }" << ENDL;
+	if (inSynGroup(model, i) == i) {
+	    os << "    for (int i = 0; i < " << model.neuronN[model.synapseTarget[i]] << "; i++) {" << ENDL;
+	    os << "        inSyn" << model.synapseName[i] << "[i] = " << model.scalarExpr(0.0) << ";" << ENDL;
+	    os << "    }" << ENDL;
+	}
 
 	if ((model.synapseConnType[i] != SPARSE) && (model.synapseGType[i] == INDIVIDUALG)) {
 	    for (int k= 0, l= weightUpdateModels[st].varNames.size(); k < l; k++) {
@@ -1221,20 +2146,23 @@ void genRunner(NNmodel &model, //!< Model description
 	    os << "void allocate" << model.synapseName[i] << "(unsigned int connN)" << "{" << ENDL;
 	    os << "// Allocate host side variables" << ENDL;
 	    os << "  C" << model.synapseName[i] << ".connN= connN;" << ENDL;
+#ifdef CPU_ONLY
+	    vector<vector<ArenaArray> > arena(1);
+#endif
  	    size = model.neuronN[model.synapseSource[i]] + 1;
 
 #ifndef CPU_ONLY
 	    os << "cudaHostAlloc(&C" << model.synapseName[i];
 	    os << ".indInG, " << size << " * sizeof(unsigned int), cudaHostAllocPortable);" << ENDL;
 #else
-	    os << "C" << model.synapseName[i] << ".indInG = new unsigned int[" << size << "];" << ENDL;
+	    arena_array(arena, 0, "unsigned int", "C" + model.synapseName[i] + ".indInG", tS(size));
 #endif
 
 #ifndef CPU_ONLY
 	    os << "cudaHostAlloc(&C" << model.synapseName[i];
 	    os << ".ind, connN * sizeof(unsigned int), cudaHostAllocPortable);" << ENDL;
 #else
-	    os << "C" << model.synapseName[i] << ".ind = new unsigned int[connN];" << ENDL;
+	    arena_array(arena, 0, "unsigned int", "C" + model.synapseName[i] + ".ind", "connN");
 #endif
 
 	    if (model.synapseUsesSynapseDynamics[i]) {
@@ -1243,7 +2171,7 @@ void genRunner(NNmodel &model, //!< Model description
 		os << "cudaHostAlloc(&C" << model.synapseName[i];
 		os << ".preInd, connN * sizeof(unsigned int), cudaHostAllocPortable);" << ENDL;
 #else
-		os << "C" << model.synapseName[i] << ".preInd = new unsigned int[connN];" << ENDL;
+		arena_array(arena, 0, "unsigned int", "C" + model.synapseName[i] + ".preInd", "connN");
 #endif
 
 	    } else {
@@ -1256,21 +2184,21 @@ void genRunner(NNmodel &model, //!< Model description
 		os << "cudaHostAlloc(&C" << model.synapseName[i];
 		os << ".revIndInG, " << size << " * sizeof(unsigned int), cudaHostAllocPortable);" << ENDL;
 #else
-		os << "C" << model.synapseName[i] << ".revIndInG = new unsigned int[" << size << "];" << ENDL;
+		arena_array(arena, 0, "unsigned int", "C" + model.synapseName[i] + ".revIndInG", tS(size));
 #endif
 
 #ifndef CPU_ONLY
 		os << "cudaHostAlloc(&C" << model.synapseName[i];
 		os << ".revInd, connN * sizeof(unsigned int), cudaHostAllocPortable);" << ENDL;
 #else
-		os << "  C" << model.synapseName[i] << ".revInd= new unsigned int[connN];" << ENDL;       
+		arena_array(arena, 0, "unsigned int", "C" + model.synapseName[i] + ".revInd", "connN");
 #endif
 
 #ifndef CPU_ONLY
 		os << "cudaHostAlloc(&C" << model.synapseName[i];
 		os << ".remap, connN * sizeof(unsigned int), cudaHostAllocPortable);" << ENDL;
 #else
-		os << "  C" << model.synapseName[i] << ".remap= new unsigned int[connN];" << ENDL;       
+		arena_array(arena, 0, "unsigned int", "C" + model.synapseName[i] + ".remap", "connN");
 #endif
 
 	    } else {
@@ -1286,12 +2214,15 @@ void genRunner(NNmodel &model, //!< Model description
 		os << "cudaHostAlloc(&" << weightUpdateModels[st].varNames[k] << model.synapseName[i] << ", ";
 		os << size << " * sizeof(" << weightUpdateModels[st].varTypes[k] << "), cudaHostAllocPortable);" << ENDL;
 #else
-		os << weightUpdateModels[st].varNames[k] << model.synapseName[i];
-		os << " = new " << weightUpdateModels[st].varTypes[k] << "[" << size << "];" << ENDL;
+		arena_array(arena, 0, weightUpdateModels[st].varTypes[k], weightUpdateModels[st].varNames[k] + model.synapseName[i], size);
 #endif
 
 	    }
-#ifndef CPU_ONLY
+#ifdef CPU_ONLY
+	    os << "// the arrays are allocated from an arena of their own" << ENDL;
+	    os << "    gennArenaFree(gennArena" << model.synapseName[i] << ");" << ENDL;
+	    arena_alloc(os, "gennArena" + model.synapseName[i], arena);
+#else
 	    os << "// Allocate device side variables" << ENDL;
 	    os << "  deviceMemAllocate( &d_indInG" << model.synapseName[i] << ", dd_indInG" << model.synapseName[i];
 	    os << ", sizeof(unsigned int) * ("<< model.neuronN[model.synapseSource[i]] + 1 <<"));" << ENDL;
@@ -1394,6 +2325,20 @@ void genRunner(NNmodel &model, //!< Model description
 
     os << "void freeMem()" << ENDL;
     os << "{" << ENDL;
+    genChannelClose(os, model);
+#ifdef CPU_ONLY
+    if (nodes.size() > 1) {
+	os << "    numaStopWorkers();" << ENDL;
+    }
+    os << "    gennArenaFree(gennArena);" << ENDL;
+    os << "    gennArena= NULL;" << ENDL;
+    for (int i = 0; i < model.synapseGrpN; i++) {
+	if (model.synapseConnType[i] == SPARSE) {
+	    os << "    gennArenaFree(gennArena" << model.synapseName[i] << ");" << ENDL;
+	    os << "    gennArena" << model.synapseName[i] << "= NULL;" << ENDL;
+	}
+    }
+#endif
 
     // FREE NEURON VARIABLES
     for (int i = 0; i < model.neuronGrpN; i++) {
@@ -1402,15 +2347,11 @@ void genRunner(NNmodel &model, //!< Model description
 #ifndef CPU_ONLY
 	os << "cudaFreeHost(glbSpkCnt" << model.neuronName[i] << ");" << ENDL;
 	os << "    CHECK_CUDA_ERRORS(cudaFree(d_glbSpkCnt" << model.neuronName[i] << "));" << ENDL;
-#else
-	os << "    delete[] glbSpkCnt" << model.neuronName[i] << ";" << ENDL;
 #endif
 
 #ifndef CPU_ONLY
 	os << "cudaFreeHost(glbSpk" << model.neuronName[i] << ");" << ENDL;	
 	os << "    CHECK_CUDA_ERRORS(cudaFree(d_glbSpk" << model.neuronName[i] << "));" << ENDL;
-#else
-	os << "    delete[] glbSpk" << model.neuronName[i] << ";" << ENDL;
 #endif
 
 	if (model.neuronNeedSpkEvnt[i]) {
@@ -1418,15 +2359,11 @@ void genRunner(NNmodel &model, //!< Model description
 #ifndef CPU_ONLY
 	    os << "cudaFreeHost(glbSpkCntEvnt" << model.neuronName[i] << ");" << ENDL;
 	    os << "    CHECK_CUDA_ERRORS(cudaFree(d_glbSpkCntEvnt" << model.neuronName[i] << "));" << ENDL;
-#else
-	    os << "    delete[] glbSpkCntEvnt" << model.neuronName[i] << ";" << ENDL;
 #endif
 
 #ifndef CPU_ONLY
 	    os << "cudaFreeHost(glbSpkEvnt" << model.neuronName[i] << ");" << ENDL;
 	    os << "    CHECK_CUDA_ERRORS(cudaFree(d_glbSpkEvnt" << model.neuronName[i] << "));" << ENDL;
-#else
-	    os << "    delete[] glbSpkEvnt" << model.neuronName[i] << ";" << ENDL;
 #endif
 
 	}
@@ -1435,8 +2372,6 @@ void genRunner(NNmodel &model, //!< Model description
 #ifndef CPU_ONLY
 	    os << "cudaFreeHost(sT" << model.neuronName[i] << ");" << ENDL;
 	    os << "    CHECK_CUDA_ERRORS(cudaFree(d_sT" << model.neuronName[i] << "));" << ENDL;
-#else
-	    os << "    delete[] sT" << model.neuronName[i] << ";" << ENDL;
 #endif
 
 	}
@@ -1445,8 +2380,6 @@ void genRunner(NNmodel &model, //!< Model description
 #ifndef CPU_ONLY
 	    os << "cudaFreeHost(" << nModels[nt].varNames[k] << model.neuronName[i] << ");" << ENDL;
 	    os << "    CHECK_CUDA_ERRORS(cudaFree(d_" << nModels[nt].varNames[k] << model.neuronName[i] << "));" << ENDL;
-#else
-	    os << "    delete[] " << nModels[nt].varNames[k] << model.neuronName[i] << ";" << ENDL;
 #endif
 
 	}
@@ -1460,8 +2393,6 @@ void genRunner(NNmodel &model, //!< Model description
 #ifndef CPU_ONLY
 	os << "cudaFreeHost(inSyn" << model.synapseName[i] << ");" << ENDL;
 	os << "    CHECK_CUDA_ERRORS(cudaFree(d_inSyn" << model.synapseName[i] << "));" << ENDL;
-#else
-	os << "    delete[] inSyn" << model.synapseName[i] << ";" << ENDL;
 #endif
 
 	if (model.synapseConnType[i] == SPARSE) {
@@ -1469,34 +2400,24 @@ void genRunner(NNmodel &model, //!< Model description
 
 #ifndef CPU_ONLY
 	    os << "cudaFreeHost(C" << model.synapseName[i] << ".indInG);" << ENDL;
-#else
-	    os << "    delete[] C" << model.synapseName[i] << ".indInG;" << ENDL;
 #endif
 
 #ifndef CPU_ONLY
 	    os << "cudaFreeHost(C" << model.synapseName[i] << ".ind);" << ENDL;
-#else
-	    os << "    delete[] C" << model.synapseName[i] << ".ind;" << ENDL;  
 #endif
 
 	    if (model.synapseUsesPostLearning[i]) {
 
 #ifndef CPU_ONLY
 		os << "cudaFreeHost(C" << model.synapseName[i] << ".revIndInG);" << ENDL;
-#else
-		os << "    delete[] C" << model.synapseName[i] << ".revIndInG;" << ENDL;
 #endif
 
 #ifndef CPU_ONLY
 		os << "cudaFreeHost(C" << model.synapseName[i] << ".revInd);" << ENDL;
-#else
-		os << "    delete[] C" << model.synapseName[i] << ".revInd;" << ENDL;  
 #endif
 
 #ifndef CPU_ONLY
 		os << "cudaFreeHost(C" << model.synapseName[i] << ".remap);" << ENDL;
-#else
-		os << "    delete[] C" << model.synapseName[i] << ".remap;" << ENDL;
 #endif
 
 	    }
@@ -1506,8 +2427,6 @@ void genRunner(NNmodel &model, //!< Model description
 #ifndef CPU_ONLY
 	    os << "cudaFreeHost(gp" << model.synapseName[i] << ");" << ENDL;
 	    os << "    CHECK_CUDA_ERRORS(cudaFree(d_gp" << model.synapseName[i] << "));" <<ENDL;  	
-#else
-	    os << "    delete[] gp" << model.synapseName[i] << ";" << ENDL;
 #endif
 
 	}
@@ -1517,8 +2436,6 @@ void genRunner(NNmodel &model, //!< Model description
 #ifndef CPU_ONLY
 		os << "cudaFreeHost(" << weightUpdateModels[st].varNames[k] << model.synapseName[i] << ");" << ENDL;
 		os << "    CHECK_CUDA_ERRORS(cudaFree(d_" << weightUpdateModels[st].varNames[k] << model.synapseName[i] << "));" << ENDL;
-#else
-		os << "    delete[] " << weightUpdateModels[st].varNames[k] << model.synapseName[i] << ";" << ENDL;
 #endif
 
 	    }
@@ -1527,8 +2444,6 @@ void genRunner(NNmodel &model, //!< Model description
 #ifndef CPU_ONLY
 		os << "cudaFreeHost(" << postSynModels[pst].varNames[k] << model.synapseName[i] << ");" << ENDL;
 		os << "    CHECK_CUDA_ERRORS(cudaFree(d_" << postSynModels[pst].varNames[k] << model.synapseName[i] << "));" << ENDL;
-#else
-		os << "    delete[] " << postSynModels[pst].varNames[k] << model.synapseName[i] << ";" << ENDL;
 #endif
 
 	    }
@@ -1542,16 +2457,30 @@ void genRunner(NNmodel &model, //!< Model description
 
     os << "void exitGeNN(){" << ENDL;  
     os << "  freeMem();" << ENDL;
+#ifdef CPU_ONLY
+    if (hosts.size() > 1) {
+	os << "  if (genn_mpiStarted) MPI_Finalize();" << ENDL;
+    }
+#endif
 #ifndef CPU_ONLY
     os << "  cudaDeviceReset();" << ENDL;
 #endif
     os << "}" << ENDL;
     os << ENDL;
 
+#ifdef CPU_ONLY
+    unsigned int window= 1;
+    if (hosts.size() > 1) {
+	window= spikeExchangeWindow(model);
+	genSpikeExchange(os, model, window);
+    }
+#endif
+
     os << "// ------------------------------------------------------------------------" << ENDL;
     os << "// the actual time stepping procedure (using CPU)" << ENDL;
     os << "void stepTimeCPU()" << ENDL;
     os << "{" << ENDL;
+    genChannelInput(os, model, false);
     if (model.synapseGrpN > 0) {
 	if (model.synDynGroups > 0) {
 	    if (model.timing) os << "        synDyn_timer.startTimer();" << ENDL;
@@ -1578,13 +2507,46 @@ void genRunner(NNmodel &model, //!< Model description
     }
     if (model.timing) os << "    neuron_timer.startTimer();" << ENDL;
     os << "    calcNeuronsCPU(t);" << ENDL;
+    genRescheduleDone(os, model);
+    genChannelOutput(os, model, false);
     if (model.timing) {
 	os << "    neuron_timer.stopTimer();" << ENDL;
 	os << "    neuron_tme+= neuron_timer.getElapsedTime();" << ENDL;
     }
+#ifdef CPU_ONLY
+    if (hosts.size() > 1) {
+	if (window > 1) {
+	    os << "    if ((iT + 1) % " << window << " == 0) exchangeSpikes();" << ENDL;
+	}
+	else {
+	    os << "    exchangeSpikes();" << ENDL;
+	}
+    }
+#endif
     os << "iT++;" << ENDL;
     os << "t= iT*DT;" << ENDL;
+    os << "#ifdef GENN_PGO_STEPS" << ENDL;
+    os << "if (iT == genn_pgoSteps) exit(0); // end of the profiling run of a profile-guided build" << ENDL;
+    os << "#endif" << ENDL;
     os << "}" << ENDL;
+    os << ENDL;
+
+    // ------------------------------------------------------------------------
+    // entry points with C linkage, so that the model can be loaded as a shared library (see jitModel.h)
+
+    const char *entryPoints[]= {"allocateMem", "initialize", "stepTimeCPU", "freeMem", "exitGeNN",
+#ifndef CPU_ONLY
+				"stepTimeGPU", "copyStateToDevice", "copyStateFromDevice",
+#endif
+				NULL};
+    os << "// ------------------------------------------------------------------------" << ENDL;
+    os << "// entry points for loading the model as a shared library" << ENDL;
+    os << "extern \"C\"" << OB(102);
+    for (int i= 0; entryPoints[i] != NULL; i++) {
+	os << "void genn_" << entryPoints[i] << "() { " << entryPoints[i] << "(); }" << ENDL;
+    }
+    os << "void genn_init() { init" << model.name << "(); }" << ENDL;
+    os << CB(102);
     os.close();
 
 
@@ -1631,7 +2593,7 @@ void genRunnerGPU(NNmodel &model, //!< Model description
     string name;
     size_t size;
     unsigned int nt, st, pst;
-    ofstream os;
+    GeneratedFile os;
 
 //    cout << "entering GenRunnerGPU" << ENDL;
     name= path + toString("/") + model.name + toString("_CODE/runnerGPU.cc");
@@ -2252,6 +3214,7 @@ void genRunnerGPU(NNmodel &model, //!< Model description
     os << "// the time stepping procedure (using GPU)" << ENDL;
     os << "void stepTimeGPU()" << ENDL;
     os << OB(1130) << ENDL;
+    genChannelInput(os, model, true);
     if (model.synapseGrpN > 0) { 
 	unsigned int synapseGridSz = model.padSumSynapseKrnl[model.synapseGrpN - 1];   
 	os << "//model.padSumSynapseTrgN[model.synapseGrpN - 1] is " << model.padSumSynapseKrnl[model.synapseGrpN - 1] << ENDL; 
@@ -2325,6 +3288,8 @@ void genRunnerGPU(NNmodel &model, //!< Model description
 	os << model.neuronKernelParameters[i] << ", ";
     }
     os << "t);" << ENDL;
+    genRescheduleDone(os, model);
+    genChannelOutput(os, model, true);
     if (model.timing) {
 	os << "cudaEventRecord(neuronStop);" << ENDL;
 	os << "cudaEventSynchronize(neuronStop);" << ENDL;
@@ -2346,6 +3311,9 @@ void genRunnerGPU(NNmodel &model, //!< Model description
     }
     os << "iT++;" << ENDL;
     os << "t= iT*DT;" << ENDL;
+    os << "#ifdef GENN_PGO_STEPS" << ENDL;
+    os << "if (iT == genn_pgoSteps) exit(0); // end of the profiling run of a profile-guided build" << ENDL;
+    os << "#endif" << ENDL;
     os << CB(1130) << ENDL;
     os.close();
     //cout << "done with generating GPU runner" << ENDL;
@@ -2353,9 +3321,81 @@ void genRunnerGPU(NNmodel &model, //!< Model description
 #endif // CPU_ONLY
 
 
+//----------------------------------------------------------------------------
+/*!
+  \brief A function that calculates a hash of a generated translation unit, of the GeNN headers and of the compiler flags. The hash identifies compiled objects in the object cache.
+
+  All headers in lib/include are hashed, as the generated code includes several of them and they include each other. The version of the compiler is added by the generated Makefile, which knows the compiler.
+*/
+//----------------------------------------------------------------------------
+
+string genCodeHash(NNmodel &model, //!< Model description
+		   string &path, //!< Path for code generation
+		   string flags, //!< Compiler flags used for the generated code
+		   vector<string> &codeFiles //!< Generated files that make up the translation unit
+		   )
+{
+    uint64_t hash= hashString(flags);
+    hash= hashFile(path + "/" + model.name + "_CODE/definitions.h", hash);
+    for (int i= 0; i < codeFiles.size(); i++) {
+	hash= hashFile(path + "/" + model.name + "_CODE/" + codeFiles[i], hash);
+    }
+    const char *gennPath= getenv("GENN_PATH");
+    if (gennPath != NULL) {
+	string includePath= string(gennPath) + "/lib/include/";
+	vector<string> headers= listDirectory(includePath);
+	for (int i= 0; i < headers.size(); i++) {
+	    if ((headers[i].size() < 2) || (headers[i].substr(headers[i].size() - 2) != ".h")) continue;
+	    hash= hashString(headers[i], hash);
+	    hash= hashFile(includePath + headers[i], hash);
+	}
+    }
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long) hash);
+    return string(buf);
+}
+
+
+//----------------------------------------------------------------------------
+/*!
+  \brief A function that lists the generated files of each translation unit of the model. The first file of each unit is the one that is compiled, the others are included by it.
+*/
+//----------------------------------------------------------------------------
+
+static vector<vector<string> > genTranslationUnits(NNmodel &model //!< Model description
+    )
+{
+    vector<vector<string> > units;
+    vector<string> unit;
+
+    unit.push_back("runner.cc");
+#ifndef CPU_ONLY
+    unit.push_back("runnerGPU.cc");
+    unit.push_back("neuronKrnl.cc");
+    if (model.synapseGrpN > 0) unit.push_back("synapseKrnl.cc");
+    unit.push_back("support_code.h");
+#endif
+    units.push_back(unit);
+    units.push_back(vector<string>(1, "neuronFnct.cc"));
+    vector<vector<unsigned int> > neuronSets= mergeNeuronGroups(model);
+    for (int k= 0; k < neuronSets.size(); k++) {
+	units.push_back(vector<string>(1, "neuronFnct_" + model.neuronName[neuronSets[k][0]] + ".cc"));
+    }
+    if (model.synapseGrpN > 0) {
+	units.push_back(vector<string>(1, "synapseFnct.cc"));
+	for (int i= 0; i < model.synapseGrpN; i++) {
+	    units.push_back(vector<string>(1, "synapseFnct_" + model.synapseName[i] + ".cc"));
+	}
+    }
+    return units;
+}
+
+
 //----------------------------------------------------------------------------
 /*!
   \brief A function that generates the Makefile for all generated GeNN code.
+
+  Every neuron and synapse group has its own translation unit, so that "make -j" compiles them in parallel and only changed units are recompiled. On UNIX the objects are combined into runner.o by a relocatable link, on Windows they are collected into runner.lib.
 */
 //----------------------------------------------------------------------------
 
@@ -2364,8 +3404,28 @@ void genMakefile(NNmodel &model, //!< Model description
 		 )
 {
     string name = path + "/" + model.name + "_CODE/Makefile";
-    ofstream os;
+    GeneratedFile os;
     os.open(name.c_str());
+    vector<vector<string> > units= genTranslationUnits(model);
+
+    // remove the units and objects of groups that were renamed, merged or deleted since an earlier build
+    string codePath= path + "/" + model.name + "_CODE/";
+    vector<string> files= listDirectory(codePath);
+    for (int k= 0; k < files.size(); k++) {
+	if ((files[k].find("neuronFnct_") != 0) && (files[k].find("synapseFnct_") != 0)) continue;
+	if ((files[k].size() < 3) || (files[k].substr(files[k].size() - 3) != ".cc")) continue;
+	bool live= false;
+	for (int i= 0; i < units.size(); i++) {
+	    if (units[i][0] == files[k]) live= true;
+	}
+	if (live) continue;
+	string base= files[k].substr(0, files[k].size() - 3);
+	remove((codePath + files[k]).c_str());
+	remove((codePath + base + ".obj").c_str());
+	remove((codePath + "obj/" + base + ".o").c_str());
+	remove((codePath + "obj_pgo/" + base + ".o").c_str());
+	remove((codePath + "obj_pic/" + base + ".o").c_str());
+    }
 
 #ifdef _WIN32
 
@@ -2373,40 +3433,49 @@ void genMakefile(NNmodel &model, //!< Model description
     string cxxFlags = "/c /DCPU_ONLY";
     if (GENN_PREFERENCES::optimizeCode) cxxFlags += " /O2";
     if (GENN_PREFERENCES::debugCode) cxxFlags += " /debug /Zi /Od";
+    string compile = "$(CXX) $(CXXFLAGS) $(INCLUDEFLAGS) ";
 
     os << endl;
     os << "CXXFLAGS       =/nologo /EHsc " << cxxFlags << endl;
     os << endl;
     os << "INCLUDEFLAGS   =/I\"$(GENN_PATH)\\lib\\include\"" << endl;
-    os << endl;
-    os << "all: runner.obj" << endl;
-    os << endl;
-    os << "runner.obj: runner.cc" << endl;
-    os << "\t$(CXX) $(CXXFLAGS) $(INCLUDEFLAGS) runner.cc" << endl;
-    os << endl;
-    os << "clean:" << endl;
-    os << "\t-del runner.obj 2>nul" << endl;
 #else
     string nvccFlags = "-c -x cu -arch sm_";
     nvccFlags += tS(deviceProp[theDevice].major) + tS(deviceProp[theDevice].minor);
     if (GENN_PREFERENCES::optimizeCode) nvccFlags += " -O3 -use_fast_math";
     if (GENN_PREFERENCES::debugCode) nvccFlags += " -O0 -g -G";
     if (GENN_PREFERENCES::showPtxInfo) nvccFlags += " -Xptxas \"-v\"";
+    string compile = "$(NVCC) $(NVCCFLAGS) $(INCLUDEFLAGS) ";
 
     os << endl;
     os << "NVCC           =\"" << NVCC << "\"" << endl;
     os << "NVCCFLAGS      =" << nvccFlags << endl;
     os << endl;
     os << "INCLUDEFLAGS   =-I\"$(GENN_PATH)\\lib\\include\"" << endl;
+#endif
+    os << endl;
+    os << "OBJECTS        =";
+    for (int i= 0; i < units.size(); i++) {
+	os << " " << units[i][0].substr(0, units[i][0].size() - 3) << ".obj";
+    }
+    os << endl;
     os << endl;
-    os << "all: runner.obj" << endl;
+    os << "all: runner.lib" << endl;
     os << endl;
-    os << "runner.obj: runner.cc" << endl;
-    os << "\t$(NVCC) $(NVCCFLAGS) $(INCLUDEFLAGS) runner.cc" << endl;
+    os << "runner.lib: $(OBJECTS)" << endl;
+    os << "\tlib /nologo /OUT:runner.lib $(OBJECTS)" << endl;
+    for (int i= 0; i < units.size(); i++) {
+	os << endl;
+	os << units[i][0].substr(0, units[i][0].size() - 3) << ".obj:";
+	for (int j= 0; j < units[i].size(); j++) {
+	    os << " " << units[i][j];
+	}
+	os << " definitions.h Makefile" << endl;
+	os << "\t" << compile << units[i][0] << endl;
+    }
     os << endl;
     os << "clean:" << endl;
-    os << "\t-del runner.obj 2>nul" << endl;
-#endif
+    os << "\t-del runner.lib $(OBJECTS) 2>nul" << endl;
 
 #else // UNIX
 
@@ -2414,41 +3483,141 @@ void genMakefile(NNmodel &model, //!< Model description
     string cxxFlags = "-c -DCPU_ONLY";
     if (GENN_PREFERENCES::optimizeCode) cxxFlags += " -O3 -ffast-math";
     if (GENN_PREFERENCES::debugCode) cxxFlags += " -O0 -g";
+    // the versions for AVX2 and AVX-512 may use fused multiply-adds, which would make the results depend on the CPU
+    if (GENN_PREFERENCES::multiversionCPUCode) cxxFlags += " -ffp-contract=off";
+    string compile = "$(CXX) $(CXXFLAGS) $(PGO_FLAGS) $(INCLUDEFLAGS) -o $@ $<";
+    string compilePIC = "$(CXX) $(CXXFLAGS) -fPIC $(INCLUDEFLAGS) -o $@ $<";
+    string linkShared = "$(CXX) -shared -o $@ $(PIC_OBJECTS) -L\"$(GENN_PATH)/lib/lib\" -lgenn_CPU_ONLY -lpthread";
+    string compilerVersion = "$(CXX) --version";
+    string flags = cxxFlags;
+    string pgoGenerate = "-fprofile-generate=\"$(GENN_PGO_DIR)\"";
+    string pgoUse = "-fprofile-use=\"$(GENN_PGO_DIR)\" -fprofile-correction -Wno-missing-profile -march=native -flto";
 
     os << endl;
     os << "CXXFLAGS       :=" << cxxFlags << endl;
+    if (cpuHosts(model).size() > 1) {
+	os << "# the model is distributed over several processes and is compiled with the MPI compiler wrapper" << endl;
+	os << "MPICXX         ?=mpicxx" << endl;
+	os << "CXX            :=$(MPICXX)" << endl;
+    }
     os << endl;
     os << "INCLUDEFLAGS   =-I\"$(GENN_PATH)/lib/include\"" << endl;
-    os << endl;
-    os << "all: runner.o" << endl;
-    os << endl;
-    os << "runner.o: runner.cc" << endl;
-    os << "\t$(CXX) $(CXXFLAGS) $(INCLUDEFLAGS) runner.cc" << endl;
-    os << endl;
-    os << "clean:" << endl;
-    os << "\trm -f runner.o" << endl;
 #else
     string nvccFlags = "-c -x cu -arch sm_";
     nvccFlags += tS(deviceProp[theDevice].major) + tS(deviceProp[theDevice].minor);
     if (GENN_PREFERENCES::optimizeCode) nvccFlags += " -O3 -use_fast_math -Xcompiler \"-ffast-math\"";
     if (GENN_PREFERENCES::debugCode) nvccFlags += " -O0 -g -G";
     if (GENN_PREFERENCES::showPtxInfo) nvccFlags += " -Xptxas \"-v\"";
+    string compile = "$(NVCC) $(NVCCFLAGS) $(PGO_FLAGS) $(INCLUDEFLAGS) -o $@ $<";
+    string compilePIC = "$(NVCC) $(NVCCFLAGS) -Xcompiler -fPIC $(INCLUDEFLAGS) -o $@ $<";
+    string linkShared = "$(NVCC) -shared -o $@ $(PIC_OBJECTS) -L\"$(GENN_PATH)/lib/lib\" -lgenn -lcuda -lcudart";
+    string compilerVersion = "($(NVCC) --version; $(CXX) --version)";
+    string flags = nvccFlags;
+    // only the host code is optimised; nvcc objects do not take part in link time optimisation
+    string pgoGenerate = "-Xcompiler \"-fprofile-generate=$(GENN_PGO_DIR)\"";
+    string pgoUse = "-Xcompiler \"-fprofile-use=$(GENN_PGO_DIR) -fprofile-correction -Wno-missing-profile -march=native\"";
 
     os << endl;
     os << "NVCC           :=\"" << NVCC << "\"" << endl;
     os << "NVCCFLAGS      :=" << nvccFlags << endl;
     os << endl;
     os << "INCLUDEFLAGS   =-I\"$(GENN_PATH)/lib/include\"" << endl;
+#endif
+    os << endl;
+    os << "# set GENN_CACHE_DIR to a directory in which compiled objects are kept for reuse" << endl;
+    os << "GENN_CACHE_DIR ?=" << endl;
+    os << endl;
+    os << "# profile-guided optimisation (GCC): GENN_PGO=generate builds instrumented objects, which write their profiles" << endl;
+    os << "# to GENN_PGO_DIR when the simulation exits, optionally after GENN_PGO_STEPS time steps; GENN_PGO=use rebuilds" << endl;
+    os << "# the same objects with these profiles. Both modes share obj_pgo, because profiles are matched by object path." << endl;
+    os << "GENN_PGO       ?=" << endl;
+    os << "GENN_PGO_DIR   ?=$(CURDIR)/pgo" << endl;
+    os << "GENN_PGO_STEPS ?=" << endl;
+    os << "ifeq ($(GENN_PGO),)" << endl;
+    os << "OBJ_DIR        :=obj" << endl;
+    os << "PGO_MODE       :=" << endl;
+    os << "else" << endl;
+    os << "OBJ_DIR        :=obj_pgo" << endl;
+    os << "PGO_MODE       :=pgo_mode" << endl;
+    os << "endif" << endl;
+    os << "ifeq ($(GENN_PGO),generate)" << endl;
+    os << "PGO_FLAGS      :=" << pgoGenerate << " -DGENN_PGO_STEPS=$(if $(GENN_PGO_STEPS),$(GENN_PGO_STEPS),0)" << endl;
+    os << "endif" << endl;
+    os << "ifeq ($(GENN_PGO),use)" << endl;
+    os << "PGO_FLAGS      :=" << pgoUse << " -DGENN_PGO_STEPS=0" << endl;
+    os << "endif" << endl;
+    os << endl;
+    os << "# pgo_mode records the mode of the last build, so that objects and runner.o are rebuilt when it changes" << endl;
+    os << "$(shell echo \"$(GENN_PGO) $(GENN_PGO_STEPS)\" | cmp -s - pgo_mode 2>/dev/null || echo \"$(GENN_PGO) $(GENN_PGO_STEPS)\" > pgo_mode)" << endl;
+    os << endl;
+    os << "# every translation unit is compiled separately, so that make -j builds them in parallel" << endl;
+    os << "OBJECTS        :=";
+    for (int i= 0; i < units.size(); i++) {
+	os << " $(OBJ_DIR)/" << units[i][0].substr(0, units[i][0].size() - 3) << ".o";
+    }
+    os << endl;
+    os << endl;
+    os << "# CODE_HASH is set per object to the hash of its code, the GeNN headers and the compiler flags, COMPILER_ID" << endl;
+    os << "# is a checksum of the version of the compiler; objects built with profiles are not cached" << endl;
+    os << "ifeq ($(if $(GENN_PGO),,$(GENN_CACHE_DIR)),)" << endl;
+    os << "COMPILE        =" << compile << endl;
+    os << "else" << endl;
+    os << "COMPILER_ID    :=$(shell " << compilerVersion << " 2>&1 | cksum | cut -d ' ' -f 1)" << endl;
+    os << "COMPILE        =@if [ -f \"$(GENN_CACHE_DIR)/$(basename $(@F))_$(CODE_HASH)_$(COMPILER_ID).o\" ]; then \\" << endl;
+    os << "\t    echo \"reusing cached $(GENN_CACHE_DIR)/$(basename $(@F))_$(CODE_HASH)_$(COMPILER_ID).o\"; cp \"$(GENN_CACHE_DIR)/$(basename $(@F))_$(CODE_HASH)_$(COMPILER_ID).o\" $@; \\" << endl;
+    os << "\telse \\" << endl;
+    os << "\t    echo \"compiling $<\"; " << compile << " && \\" << endl;
+    os << "\t    mkdir -p \"$(GENN_CACHE_DIR)\" && cp $@ \"$(GENN_CACHE_DIR)/$(basename $(@F))_$(CODE_HASH)_$(COMPILER_ID).o\"; \\" << endl;
+    os << "\tfi" << endl;
+    os << "endif" << endl;
     os << endl;
     os << "all: runner.o" << endl;
     os << endl;
-    os << "runner.o: runner.cc" << endl;
-    os << "\t$(NVCC) $(NVCCFLAGS) $(INCLUDEFLAGS) runner.cc" << endl;
+    os << "runner.o: $(OBJECTS) pgo_mode" << endl;
+    os << "\t$(LD) -r -o $@ $(OBJECTS)" << endl;
+    os << endl;
+    os << "# position independent objects for loading the model as a shared library (see jitModel.h), always built without profiles" << endl;
+    os << "PIC_OBJECTS    :=$(patsubst $(OBJ_DIR)/%,obj_pic/%,$(OBJECTS))" << endl;
+    os << endl;
+    os << "runner.so: $(PIC_OBJECTS)" << endl;
+    os << "\t" << linkShared << endl;
+    os << endl;
+    os << "obj_pic/%.o: %.cc definitions.h compile_flags | obj_pic" << endl;
+    os << "\t" << compilePIC << endl;
+    os << endl;
+    os << "obj obj_pgo obj_pic:" << endl;
+    os << "\tmkdir -p $@" << endl;
+    for (int i= 0; i < units.size(); i++) {
+	string object= "$(OBJ_DIR)/" + units[i][0].substr(0, units[i][0].size() - 3) + ".o";
+	os << endl;
+	os << object << ": CODE_HASH :=" << genCodeHash(model, path, flags, units[i]) << endl;
+	os << object << ":";
+	for (int j= 0; j < units[i].size(); j++) {
+	    os << " " << units[i][j];
+	}
+	os << " definitions.h compile_flags $(PGO_MODE) | $(OBJ_DIR)" << endl;
+	os << "\t$(COMPILE)" << endl;
+	if (units[i].size() > 1) {
+	    os << "obj_pic/" << object.substr(11) << ":";
+	    for (int j= 1; j < units[i].size(); j++) {
+		os << " " << units[i][j];
+	    }
+	    os << endl;
+	}
+    }
     os << endl;
     os << "clean:" << endl;
-    os << "\trm -f runner.o" << endl;
-#endif
-
+    os << "\trm -rf runner.o runner.so pgo_mode obj obj_pgo obj_pic" << endl;
+    os << endl;
+    os << "clean_pgo:" << endl;
+    os << "\trm -rf obj_pgo \"$(GENN_PGO_DIR)\"" << endl;
+
+    // the objects depend on the compiler flags rather than on this Makefile, which changes with every code hash
+    GeneratedFile flagsFile;
+    name= path + "/" + model.name + "_CODE/compile_flags";
+    flagsFile.open(name.c_str());
+    flagsFile << flags << endl;
+    flagsFile.close();
 #endif
 
     os.close();
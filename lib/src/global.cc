@@ -36,6 +36,16 @@ namespace GENN_PREFERENCES {
     int autoChooseDevice= 1; //!< Flag to signal whether the GPU device should be chosen automatically 
     bool optimizeCode = false; //!< Request speed-optimized code, at the expense of floating-point accuracy
     bool debugCode = false; //!< Request debug data to be embedded in the generated code
+    bool optimiseSnippets = true; //!< Request constant folding, hoisting of repeated subexpressions and strength reduction of divisions in code snippets
+    bool mergeNeuronGroups = true; //!< Request that the CPU code of neuron groups that differ only in size and parameter values is generated as one loop over the groups
+    bool multiversionCPUCode = true; //!< Request that the CPU simulation functions are compiled for several x86 instruction set levels, of which the best one for the CPU is chosen at runtime
+    unsigned int maxCPUISA = 3; //!< Highest instruction set level of the multiversioned CPU functions that allocateMem() may choose (0: default, 1: SSE4.2, 2: AVX2, 3: AVX-512)
+    int optimiseCPUCode = 0; //!< Flag for signalling whether the configuration of the CPU code should be chosen by timing variants of the model (see tuneCPU.h)
+    bool bucketSparseSynapses = true; //!< Request that the CPU code of SPARSE synapse groups prefetches synapse rows when the synapses of the spikes of a time step do not fit into the L2 cache, and sorts the inputs by target before adding them when the targets do not fit into the last level cache
+    bool tileDenseSynapses = true; //!< Request that the CPU code of DENSE and ALLTOALL synapse groups whose weight update only adds to the postsynaptic input adds the rows of the spiking neurons tile by tile of postsynaptic neurons
+    double pullSpikeFraction = 1.0; //!< Fraction of spiking presynaptic neurons above which the CPU code of SPARSE synapse groups with reverse connectivity pulls the spikes into the targets rather than pushing them along the synapses (1: always push; chosen by tuneCPUCode() if the CPU code is tuned)
+    bool sharePostsynapticInputs = false; //!< Request that incoming synapse groups of a neuron group whose postsynaptic models are linear in the input and have the same parameters add to one shared postsynaptic input in CPU_ONLY code (changes the rounding of the summed inputs)
+    int hugePages = 1; //!< Use of huge pages for the arrays of CPU_ONLY models (0: none, 1: transparent huge pages, 2: explicit huge pages if available)
     bool showPtxInfo = false; //!< Request that PTX assembler information be displayed for each CUDA kernel during compilation
     double asGoodAsZero = 1e-19; //!< Global variable that is used when detecting close to zero values, for example when setting sparse connectivity from a dense matrix
     int defaultDevice= 0; //! default GPU device; used to determine which GPU to use if chooseDevice is 0 (off)
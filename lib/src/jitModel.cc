@@ -0,0 +1,159 @@
+//--------------------------------------------------------------------------
+/*! \file jitModel.cc
+
+  \brief Implementation of the functions for generating, compiling and loading the code of a model from within a running program. Part of the code generation section.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef JITMODEL_CC
+#define JITMODEL_CC
+
+#include "jitModel.h"
+#include "generateALL.h"
+#include "global.h"
+#include "utils.h"
+#include "stringUtils.h"
+
+#include <cstdlib>
+#include <vector>
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <unistd.h>
+#endif
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that looks up a symbol of the loaded model. Unknown symbols are an error.
+ */
+//--------------------------------------------------------------------------
+
+void *JITModel::getSymbol(const string &symbol)
+{
+#ifndef _WIN32
+    void *ptr= dlsym(library, symbol.c_str());
+    if (ptr == NULL) {
+	gennError("Model " + name + " has no symbol " + symbol + ".");
+    }
+    return ptr;
+#else
+    gennError("Loading models at runtime is not supported on Windows.");
+    return NULL;
+#endif
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that tells whether the loaded model has a symbol, e.g. one that only exists with some preferences.
+ */
+//--------------------------------------------------------------------------
+
+bool JITModel::hasSymbol(const string &symbol)
+{
+#ifndef _WIN32
+    return (dlsym(library, symbol.c_str()) != NULL);
+#else
+    return false;
+#endif
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that generates the code of a finalized model, compiles it into a shared library and loads it.
+ */
+//--------------------------------------------------------------------------
+
+JITModel *buildModelJIT(NNmodel &model, //!< Model description
+			string path //!< Directory in which the code is generated
+    )
+{
+#ifndef _WIN32
+    if (!model.final) {
+	gennError("Model was not finalized. Please call model.finalize() before building it.");
+    }
+    if (getenv("GENN_PATH") == NULL) {
+	gennError("GENN_PATH must be set to build models at runtime.");
+    }
+
+    // generate the code
+    if (path == "") {
+	const char *tmpDir= getenv("TMPDIR");
+	string pattern= string(tmpDir != NULL ? tmpDir : "/tmp") + "/genn_" + model.name + "_XXXXXX";
+	vector<char> buf(pattern.begin(), pattern.end());
+	buf.push_back('\0');
+	if (mkdtemp(&buf[0]) == NULL) {
+	    gennError("Could not create a temporary directory for model " + model.name + ".");
+	}
+	path= &buf[0];
+    }
+#ifndef CPU_ONLY
+    if (deviceProp == NULL) {
+	CHECK_CUDA_ERRORS(cudaGetDeviceCount(&deviceCount));
+	deviceProp = new cudaDeviceProp[deviceCount];
+	for (int device = 0; device < deviceCount; device++) {
+	    CHECK_CUDA_ERRORS(cudaSetDevice(device));
+	    CHECK_CUDA_ERRORS(cudaGetDeviceProperties(&(deviceProp[device]), device));
+	}
+    }
+    chooseDevice(model, path);
+#endif // CPU_ONLY
+    generate_model_runner(model, path);
+
+    // compile it into a shared library
+    string codePath= path + "/" + model.name + "_CODE";
+    const char *jobs= getenv("GENN_JOBS");
+    string command= "make -s -C \"" + codePath + "\" -j " + (jobs != NULL ? string(jobs) : tS(sysconf(_SC_NPROCESSORS_ONLN))) + " runner.so";
+    if (system(command.c_str()) != 0) {
+	gennError("Compiling the generated code of model " + model.name + " failed.");
+    }
+
+    // load it
+    JITModel *jit= new JITModel;
+    jit->name= model.name;
+    jit->path= path;
+    jit->library= dlopen((codePath + "/runner.so").c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (jit->library == NULL) {
+	gennError("Could not load model " + model.name + ": " + dlerror());
+    }
+    // the setters of runtime parameters compute derived parameters with the model types of the library's own copy of libgenn
+    vector<neuronModel> *libNModels= (vector<neuronModel> *) dlsym(jit->library, "nModels");
+    if ((libNModels != NULL) && (libNModels != &nModels)) *libNModels= nModels;
+    vector<weightUpdateModel> *libWeightUpdateModels= (vector<weightUpdateModel> *) dlsym(jit->library, "weightUpdateModels");
+    if ((libWeightUpdateModels != NULL) && (libWeightUpdateModels != &weightUpdateModels)) *libWeightUpdateModels= weightUpdateModels;
+    vector<postSynModel> *libPostSynModels= (vector<postSynModel> *) dlsym(jit->library, "postSynModels");
+    if ((libPostSynModels != NULL) && (libPostSynModels != &postSynModels)) *libPostSynModels= postSynModels;
+
+    jit->allocateMem= (void (*)()) jit->getSymbol("genn_allocateMem");
+    jit->initialize= (void (*)()) jit->getSymbol("genn_initialize");
+    jit->init= (void (*)()) jit->getSymbol("genn_init");
+    jit->stepTimeCPU= (void (*)()) jit->getSymbol("genn_stepTimeCPU");
+    jit->freeMem= (void (*)()) jit->getSymbol("genn_freeMem");
+    jit->exitGeNN= (void (*)()) jit->getSymbol("genn_exitGeNN");
+#ifndef CPU_ONLY
+    jit->stepTimeGPU= (void (*)()) jit->getSymbol("genn_stepTimeGPU");
+    jit->copyStateToDevice= (void (*)()) jit->getSymbol("genn_copyStateToDevice");
+    jit->copyStateFromDevice= (void (*)()) jit->getSymbol("genn_copyStateFromDevice");
+#endif
+    return jit;
+#else
+    gennError("Loading models at runtime is not supported on Windows.");
+    return NULL;
+#endif
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that unloads a model loaded by buildModelJIT() and deletes its handle.
+ */
+//--------------------------------------------------------------------------
+
+void unloadModelJIT(JITModel *jit)
+{
+#ifndef _WIN32
+    if (jit->library != NULL) {
+	dlclose(jit->library);
+    }
+#endif
+    delete jit;
+}
+
+#endif // JITMODEL_CC
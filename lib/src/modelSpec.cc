@@ -51,8 +51,10 @@ NNmodel::NNmodel()
     synDynGroups= 0;
     needSt= 0;
     needSynapseDelay = 0;
+    needGennrand= false;
     setDT(0.5);
     setPrecision(GENN_FLOAT);
+    setMathPrecision(GENN_MATH_EXACT);
     setTiming(false);
     RNtype= "uint64_t";
 #ifndef CPU_ONLY
@@ -199,8 +201,7 @@ void NNmodel::initLearnGrps()
 		
 		// do an early replacement of parameters, derived parameters and extraglobalsynapse parameters
 		string eCode= wu.evntThreshold;
-		value_substitutions(eCode, wu.pNames, synapsePara[synPopID]);
-		value_substitutions(eCode, wu.dpNames, dsp_w[synPopID]);						    
+		synapse_para_substitutions(eCode, *this, synPopID);
 		name_substitutions(eCode, "", wu.extraGlobalSynapseKernelParameters, synapseName[synPopID]);
 
 		// add to the source population spike event condition
@@ -272,6 +273,21 @@ void NNmodel::initLearnGrps()
 	    }
 	}
     }
+    // the counter-based random numbers of neurons are keyed by the seed and count the time steps
+    needGennrand= false;
+    for (int i = 0; i < neuronGrpN; i++) {
+	neuronModel nm= nModels[neuronType[i]];
+	if (nm.thresholdConditionCode.find("$(gennrand_") != string::npos) {
+	    gennError("The threshold condition code of neuron group " + neuronName[i] + " draws random numbers. Random numbers can only be drawn in the simCode and resetCode, as the threshold condition is evaluated more than once per time step.");
+	}
+	if (nm.needsGennrand()) needGennrand= true;
+    }
+    if (needGennrand) {
+	neuronKernelParameters.push_back("iT");
+	neuronKernelParameterTypes.push_back("unsigned long long");
+	neuronKernelParameters.push_back("gennrandSeed");
+	neuronKernelParameterTypes.push_back("unsigned int");
+    }
     // for synapse kernel
     for (int i = 0; i < synapseGrpN; i++) {
 	weightUpdateModel wu = weightUpdateModels[synapseType[i]];
@@ -404,6 +420,7 @@ void NNmodel::initLearnGrps()
 	    }
 	}
     }
+    registerRuntimeKernelParameters();
 
 #ifndef CPU_ONLY
     // figure out where to reset the spike counters
@@ -422,6 +439,95 @@ void NNmodel::initLearnGrps()
 }
 
 
+//--------------------------------------------------------------------------
+/*! \brief This function adds a parameter to a kernel parameter list unless it is already in it.
+ */
+//--------------------------------------------------------------------------
+
+static void addKernelParameter(vector<string> &kernelParameters, vector<string> &kernelParameterTypes, const string pnamefull, const string ptype)
+{
+    if (find(kernelParameters.begin(), kernelParameters.end(), pnamefull) == kernelParameters.end()) {
+	kernelParameters.push_back(pnamefull);
+	kernelParameterTypes.push_back(ptype);
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function adds those of the given runtime parameters that are used in a code snippet to a kernel parameter list.
+ */
+//--------------------------------------------------------------------------
+
+static void addUsedKernelParameters(vector<string> &kernelParameters, vector<string> &kernelParameterTypes, vector<string> names, const string ext, const string groupName, const string code, const string ptype)
+{
+    for (int j= 0, l= names.size(); j < l; j++) {
+	if (code.find("$(" + names[j] + ext + ")") != string::npos) {
+	    addKernelParameter(kernelParameters, kernelParameterTypes, names[j] + groupName, ptype);
+	}
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function adds the runtime parameters of all groups to the parameter lists of the kernels that use them.
+
+  Runtime parameters and the derived parameters of their groups are global variables in the generated code. Like the extra global kernel parameters they are passed to the kernels by value, so that the CPU and GPU code refer to them by the same name.
+ */
+//--------------------------------------------------------------------------
+
+void NNmodel::registerRuntimeKernelParameters()
+{
+    // runtime parameters become global variables and need unique names
+    vector<string> globalNames;
+    for (int i = 0; i < neuronGrpN; i++) {
+	vector<string> names= runtimeNeuronParaNames(i);
+	for (int j= 0, l= names.size(); j < l; j++) globalNames.push_back(names[j] + neuronName[i]);
+    }
+    for (int i = 0; i < synapseGrpN; i++) {
+	vector<string> names= runtimeSynapseParaNames(i);
+	for (int j= 0, l= names.size(); j < l; j++) globalNames.push_back(names[j] + synapseName[i]);
+	names= runtimePostSynapseParaNames(i);
+	for (int j= 0, l= names.size(); j < l; j++) globalNames.push_back(names[j] + synapseName[i]);
+    }
+    sort(globalNames.begin(), globalNames.end());
+    vector<string>::iterator dup= adjacent_find(globalNames.begin(), globalNames.end());
+    if (dup != globalNames.end()) {
+	gennError("The runtime parameter " + *dup + " is defined more than once. Please use distinct names for the parameters and groups involved.");
+    }
+
+    // for neuron kernel
+    for (int i = 0; i < neuronGrpN; i++) {
+	neuronModel nm= nModels[neuronType[i]];
+	string code= nm.simCode + nm.thresholdConditionCode + nm.resetCode;
+	for (int j= 0, l= inSyn[i].size(); j < l; j++) {
+	    unsigned int synPopID= inSyn[i][j];
+	    postSynModel psm= postSynModels[postSynapseType[synPopID]];
+	    addUsedKernelParameters(neuronKernelParameters, neuronKernelParameterTypes, runtimePostSynapseParaNames(synPopID), "", synapseName[synPopID], psm.postSyntoCurrent + psm.postSynDecay, ftype);
+	    code+= psm.postSyntoCurrent + psm.postSynDecay;
+	}
+	addUsedKernelParameters(neuronKernelParameters, neuronKernelParameterTypes, runtimeNeuronParaNames(i), "", neuronName[i], code, ftype);
+	for (int j= 0, l= outSyn[i].size(); j < l; j++) {
+	    unsigned int synPopID= outSyn[i][j];
+	    addUsedKernelParameters(neuronKernelParameters, neuronKernelParameterTypes, runtimeSynapseParaNames(synPopID), "", synapseName[synPopID], weightUpdateModels[synapseType[synPopID]].evntThreshold, ftype);
+	}
+    }
+    // for synapse kernel, simLearnPost and synapse dynamics
+    for (int i = 0; i < synapseGrpN; i++) {
+	weightUpdateModel wu = weightUpdateModels[synapseType[i]];
+	unsigned int src = synapseSource[i];
+	unsigned int trg = synapseTarget[i];
+	vector<string> *kernelParameters[3]= {&synapseKernelParameters, &simLearnPostKernelParameters, &synapseDynamicsKernelParameters};
+	vector<string> *kernelParameterTypes[3]= {&synapseKernelParameterTypes, &simLearnPostKernelParameterTypes, &synapseDynamicsKernelParameterTypes};
+	string code[3]= {wu.simCode + wu.simCodeEvnt + wu.evntThreshold, wu.simLearnPost, wu.synapseDynamics};
+	for (int k= 0; k < 3; k++) {
+	    addUsedKernelParameters(*kernelParameters[k], *kernelParameterTypes[k], runtimeSynapseParaNames(i), "", synapseName[i], code[k], ftype);
+	    addUsedKernelParameters(*kernelParameters[k], *kernelParameterTypes[k], runtimeNeuronParaNames(src), "_pre", neuronName[src], code[k], ftype);
+	    addUsedKernelParameters(*kernelParameters[k], *kernelParameterTypes[k], runtimeNeuronParaNames(trg), "_post", neuronName[trg], code[k], ftype);
+	}
+    }
+}
+
+
 //--------------------------------------------------------------------------
 /*! \brief This function is a tool to find the numeric ID of a synapse population based on the name of the synapse population.
  */
@@ -510,6 +616,7 @@ void NNmodel::addNeuronPopulation(
     neuronN.push_back(nNo);
     neuronType.push_back(type);
     neuronPara.push_back(p);
+    neuronParaRuntime.push_back(vector<bool>(p.size(), false));
     neuronIni.push_back(ini);
     inSyn.push_back(vector<unsigned int>());
     outSyn.push_back(vector<unsigned int>());
@@ -682,16 +789,18 @@ void NNmodel::addSynapsePopulation(
     }
     synapseIni.push_back(synini);
     synapsePara.push_back(p);
+    synapseParaRuntime.push_back(vector<bool>(p.size(), false));
     postSynapseType.push_back(postsyn);
     postSynIni.push_back(PSVini);  
     postSynapsePara.push_back(ps);  
+    postSynapseParaRuntime.push_back(vector<bool>(ps.size(), false));
     registerSynapsePopulation(i);
     maxConn.push_back(neuronN[trgNumber]);
     synapseSpanType.push_back(0);
 
-    // initially set synapase group indexing variables to device 0 host 0
-    synapseDeviceID.push_back(0);
-    synapseHostID.push_back(0);
+    // initially synapse groups are computed where their postsynaptic neuron group is
+    synapseDeviceID.push_back(-1);
+    synapseHostID.push_back(-1);
 
     // TODO set uses*** variables for synaptic populations
 }
@@ -739,6 +848,189 @@ void NNmodel::setSpanTypeToPre(const string sname /**<  */)
 }
 
 
+//--------------------------------------------------------------------------
+/*! \brief This function returns the names of the parameters of a group that are global variables in the generated code: the runtime parameters and, if there are any, all derived parameters, as these are recomputed whenever a runtime parameter changes.
+ */
+//--------------------------------------------------------------------------
+
+static vector<string> runtimeParaNames(vector<string> &pNames, vector<string> &dpNames, vector<bool> &runtime)
+{
+    vector<string> names;
+    for (int j= 0, l= pNames.size(); j < l; j++) {
+	if (runtime[j]) {
+	    names.push_back(pNames[j]);
+	}
+    }
+    if (names.size() > 0) {
+	names.insert(names.end(), dpNames.begin(), dpNames.end());
+    }
+    return names;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function returns the index of a parameter in a list of parameter names, or gives an error if there is no such parameter.
+ */
+//--------------------------------------------------------------------------
+
+static unsigned int findPara(vector<string> &pNames, const string paraName, const string groupName)
+{
+    vector<string>::iterator it= find(pNames.begin(), pNames.end(), paraName);
+    if (it == pNames.end()) {
+	gennError("Group " + groupName + " has no parameter " + paraName + ".");
+    }
+    return it - pNames.begin();
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function makes a parameter of a neuron group a runtime parameter.
+
+  Instead of being inserted as a constant into the generated code, the parameter becomes a global variable with a setter function that also recomputes the derived parameters of the group.
+ */
+//--------------------------------------------------------------------------
+
+void NNmodel::setNeuronParaRuntime(const string neuronGroup, /**< Name of the neuron population */
+				   const string paraName /**< Name of the parameter */)
+{
+    if (final) {
+	gennError("Trying to set a runtime parameter in a finalized model.");
+    }
+    unsigned int i= findNeuronGrp(neuronGroup);
+    neuronParaRuntime[i][findPara(nModels[neuronType[i]].pNames, paraName, neuronGroup)]= true;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function streams the values of an extra global parameter of a neuron group from a shared-memory channel (see gennChannel.h).
+
+  At the start of each time step, the newest message in the channel, if any, is copied into the parameter, and older messages are discarded. If the parameter is a pointer, a message holds size values that are copied into the array the parameter points to (in device memory in stepTimeGPU()); otherwise it holds one value.
+ */
+//--------------------------------------------------------------------------
+
+void NNmodel::addInputChannel(const string neuronGroup, /**< Name of the neuron population */
+			      const string paraName, /**< Name of the extra global parameter */
+			      const string file, /**< File of the channel, e.g. in /dev/shm */
+			      unsigned int size, /**< Number of values of a message */
+			      unsigned int slots /**< Number of messages the channel can hold */)
+{
+    if (final) {
+	gennError("Trying to add a channel to a finalized model.");
+    }
+#ifdef _WIN32
+    gennError("Shared-memory channels are not supported on Windows.");
+#endif
+    unsigned int i= findNeuronGrp(neuronGroup);
+    unsigned int k= findPara(nModels[neuronType[i]].extraGlobalNeuronKernelParameters, paraName, neuronGroup);
+    string type= nModels[neuronType[i]].extraGlobalNeuronKernelParameterTypes[k];
+    if ((size == 0) || ((type.find("*") == string::npos) && (size != 1))) {
+	gennError("The input channel of parameter " + paraName + " of group " + neuronGroup + " needs messages of " + ((type.find("*") == string::npos) ? "1 value." : "at least 1 value."));
+    }
+    if (slots == 0) {
+	gennError("The input channel of parameter " + paraName + " of group " + neuronGroup + " needs at least 1 slot.");
+    }
+    channelFile.push_back(file);
+    channelNeuronGrp.push_back(i);
+    channelParameter.push_back(paraName);
+    channelSize.push_back(size);
+    channelSlots.push_back(slots);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function streams the spikes of a neuron group to a shared-memory channel (see gennChannel.h).
+
+  After the neurons are updated in each time step, a message with the time step, the spike count and the spiking neurons of the group is sent. If the channel is full because the reader fell behind, the message is dropped rather than stalling the simulation.
+ */
+//--------------------------------------------------------------------------
+
+void NNmodel::addSpikeOutputChannel(const string neuronGroup, /**< Name of the neuron population */
+				    const string file, /**< File of the channel, e.g. in /dev/shm */
+				    unsigned int slots /**< Number of messages the channel can hold */)
+{
+    if (final) {
+	gennError("Trying to add a channel to a finalized model.");
+    }
+#ifdef _WIN32
+    gennError("Shared-memory channels are not supported on Windows.");
+#endif
+    if (slots == 0) {
+	gennError("The spike output channel of group " + neuronGroup + " needs at least 1 slot.");
+    }
+    unsigned int i= findNeuronGrp(neuronGroup);
+    channelFile.push_back(file);
+    channelNeuronGrp.push_back(i);
+    channelParameter.push_back("");
+    channelSize.push_back(neuronN[i]);
+    channelSlots.push_back(slots);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function makes a weight update parameter of a synapse group a runtime parameter.
+ */
+//--------------------------------------------------------------------------
+
+void NNmodel::setSynapseParaRuntime(const string synapseGroup, /**< Name of the synapse population */
+				    const string paraName /**< Name of the parameter */)
+{
+    if (final) {
+	gennError("Trying to set a runtime parameter in a finalized model.");
+    }
+    unsigned int i= findSynapseGrp(synapseGroup);
+    synapseParaRuntime[i][findPara(weightUpdateModels[synapseType[i]].pNames, paraName, synapseGroup)]= true;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function makes a postsynaptic parameter of a synapse group a runtime parameter.
+ */
+//--------------------------------------------------------------------------
+
+void NNmodel::setPostSynapseParaRuntime(const string synapseGroup, /**< Name of the synapse population */
+					const string paraName /**< Name of the parameter */)
+{
+    if (final) {
+	gennError("Trying to set a runtime parameter in a finalized model.");
+    }
+    unsigned int i= findSynapseGrp(synapseGroup);
+    postSynapseParaRuntime[i][findPara(postSynModels[postSynapseType[i]].pNames, paraName, synapseGroup)]= true;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function returns the names of the runtime and derived parameters of a neuron group that are global variables in the generated code.
+ */
+//--------------------------------------------------------------------------
+
+vector<string> NNmodel::runtimeNeuronParaNames(unsigned int i /**< Index of the neuron population */)
+{
+    return runtimeParaNames(nModels[neuronType[i]].pNames, nModels[neuronType[i]].dpNames, neuronParaRuntime[i]);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function returns the names of the runtime and derived weight update parameters of a synapse group that are global variables in the generated code.
+ */
+//--------------------------------------------------------------------------
+
+vector<string> NNmodel::runtimeSynapseParaNames(unsigned int i /**< Index of the synapse population */)
+{
+    return runtimeParaNames(weightUpdateModels[synapseType[i]].pNames, weightUpdateModels[synapseType[i]].dpNames, synapseParaRuntime[i]);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function returns the names of the runtime and derived postsynaptic parameters of a synapse group that are global variables in the generated code.
+ */
+//--------------------------------------------------------------------------
+
+vector<string> NNmodel::runtimePostSynapseParaNames(unsigned int i /**< Index of the synapse population */)
+{
+    return runtimeParaNames(postSynModels[postSynapseType[i]].pNames, postSynModels[postSynapseType[i]].dpNames, postSynapseParaRuntime[i]);
+}
+
+
 //--------------------------------------------------------------------------
 /*! \brief This functions sets the global value of the maximal synaptic conductance for a synapse population that was idfentified as conductance specifcation method "GLOBALG" 
  */
@@ -803,6 +1095,25 @@ void NNmodel::setPrecision(unsigned int floattype /**<  */)
 }
 
 
+//--------------------------------------------------------------------------
+/*! \brief This function sets the precision tier of the math functions exp, log, tanh and pow in the code snippets of the model.
+
+  With GENN_MATH_EXACT the functions of the math library are called. With GENN_MATH_FAST and GENN_MATH_APPROX, the calls are replaced by inline functions without branches that compilers can vectorize. Their accuracy is documented in the user manual. They assume finite arguments, and positive normal arguments for log and pow.
+ */
+//--------------------------------------------------------------------------
+
+void NNmodel::setMathPrecision(unsigned int precision /**< GENN_MATH_EXACT, GENN_MATH_FAST or GENN_MATH_APPROX */)
+{
+    if (final) {
+	gennError("Trying to set the math precision of a finalized model.");
+    }
+    if (precision > GENN_MATH_APPROX) {
+	gennError("Unrecognised math precision.");
+    }
+    mathPrecision= precision;
+}
+
+
 //--------------------------------------------------------------------------
 /*! \brief This function sets a flag to determine whether timers and timing commands are to be included in generated code.
  */
@@ -4,6 +4,9 @@
 
 #include "neuronModels.h"
 #include "stringUtils.h"
+#include "utils.h"
+
+#include <algorithm>
 
 
 //--------------------------------------------------------------------------
@@ -16,6 +19,8 @@ neuronModel::neuronModel()
     dps = NULL;
     needPreSt = false;
     needPostSt = false;
+    needAutoRefractory = true;
+    gateDT = "DT";
 }
 
 
@@ -27,6 +32,46 @@ neuronModel::neuronModel()
 neuronModel::~neuronModel() {}
 
 
+//--------------------------------------------------------------------------
+/*! \brief Function that generates the Rush-Larsen update of the gating variables of the model.
+
+  For constant membrane potential, a gating variable y relaxes exponentially towards y_inf= alpha_y/(alpha_y+beta_y) with rate alpha_y+beta_y, so that it is updated exactly as y= y_inf + (y-y_inf) exp(-(alpha_y+beta_y) dt). The rates of all gates are evaluated from the values of the model variables before the update.
+ */
+//--------------------------------------------------------------------------
+
+string neuronModel::gateUpdateCode() const
+{
+    string code;
+
+    if ((gateAlphaCode.size() != gateNames.size()) || (gateBetaCode.size() != gateNames.size())) {
+	gennError("Each gating variable of a neuron model needs an opening rate in gateAlphaCode and a closing rate in gateBetaCode.");
+    }
+    for (size_t k= 0; k < gateNames.size(); k++) {
+	if (find(varNames.begin(), varNames.end(), gateNames[k]) == varNames.end()) {
+	    gennError("The gating variable \"" + gateNames[k] + "\" is not a variable of its neuron model.");
+	}
+	code+= "      {\n";
+	code+= "        scalar _ga= " + gateAlphaCode[k] + ";\n";
+	code+= "        scalar _grate= _ga + (" + gateBetaCode[k] + ");\n";
+	code+= "        scalar _ginf= _ga/_grate;\n";
+	code+= "        $(" + gateNames[k] + ")= _ginf + ($(" + gateNames[k] + ") - _ginf)*exp(-_grate*(" + gateDT + "));\n";
+	code+= "      }\n";
+    }
+    return code;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that determines whether the code of the model draws random numbers from the counter-based generator.
+ */
+//--------------------------------------------------------------------------
+
+bool neuronModel::needsGennrand() const
+{
+    return (simCode.find("$(gennrand_") != string::npos) || (resetCode.find("$(gennrand_") != string::npos);
+}
+
+
 // Neuron Types
 vector<neuronModel> nModels; //!< Global C++ vector containing all neuron model descriptions
 unsigned int MAPNEURON; //!< variable attaching the name "MAPNEURON" 
@@ -39,6 +84,10 @@ unsigned int TRAUBMILES_PSTEP;//!< variable attaching the name "TRAUBMILES_PSTEP
 unsigned int IZHIKEVICH; //!< variable attaching the name "IZHIKEVICH" 
 unsigned int IZHIKEVICH_V; //!< variable attaching the name "IZHIKEVICH_V" 
 unsigned int SPIKESOURCE; //!< variable attaching the name "SPIKESOURCE"
+unsigned int TRAUBMILES_RL; //!< variable attaching the name "TRAUBMILES_RL"
+unsigned int POISSONNEURON_PHILOX; //!< variable attaching the name "POISSONNEURON_PHILOX"
+unsigned int POISSONNEURON_EVENT; //!< variable attaching the name "POISSONNEURON_EVENT"
+unsigned int SPIKESOURCEARRAY; //!< variable attaching the name "SPIKESOURCEARRAY"
 
 
 //--------------------------------------------------------------------------
@@ -394,6 +443,151 @@ void prepareStandardModels()
     SPIKESOURCE= nModels.size()-1;
 
 
+    // Traub and Miles HH neurons TRAUBMILES_RL - same equations as TRAUBMILES_PSTEP but the gating variables are integrated with the Rush-Larsen scheme and V semi-implicitly, which remains stable with only a few inner loops (2-5 for DT= 0.1 ms).
+    n.varNames.clear();
+    n.varTypes.clear();
+    n.varNames.push_back("V");
+    n.varTypes.push_back("scalar");
+    n.varNames.push_back("m");
+    n.varTypes.push_back("scalar");
+    n.varNames.push_back("h");
+    n.varTypes.push_back("scalar");
+    n.varNames.push_back("n");
+    n.varTypes.push_back("scalar");
+    n.pNames.clear();
+    n.pNames.push_back("gNa");
+    n.pNames.push_back("ENa");
+    n.pNames.push_back("gK");
+    n.pNames.push_back("EK");
+    n.pNames.push_back("gl");
+    n.pNames.push_back("El");
+    n.pNames.push_back("C");
+    n.pNames.push_back("ntimes");
+    n.dpNames.clear();
+    n.gateNames.push_back("m");
+    n.gateAlphaCode.push_back("(($(V) == -52.0) ? 1.28 : 0.32*(-52.0-$(V))/(exp((-52.0-$(V))/4.0)-1.0))");
+    n.gateBetaCode.push_back("(($(V) == -25.0) ? 1.4 : 0.28*($(V)+25.0)/(exp(($(V)+25.0)/5.0)-1.0))");
+    n.gateNames.push_back("h");
+    n.gateAlphaCode.push_back("0.128*exp((-48.0-$(V))/18.0)");
+    n.gateBetaCode.push_back("4.0/(exp((-25.0-$(V))/5.0)+1.0)");
+    n.gateNames.push_back("n");
+    n.gateAlphaCode.push_back("(($(V) == -50.0) ? 0.16 : 0.032*(-50.0-$(V))/(exp((-50.0-$(V))/5.0)-1.0))");
+    n.gateBetaCode.push_back("0.5*exp((-55.0-$(V))/40.0)");
+    n.gateDT= "mdt";
+    n.simCode= "   scalar _gNa, _gK, _f;\n\
+    unsigned int mt;\n\
+    scalar mdt= DT/scalar($(ntimes));\n\
+    for (mt=0; mt < $(ntimes); mt++) {\n\
+$(updateGates)\
+      _gNa= $(m)*$(m)*$(m)*$(h)*$(gNa);\n\
+      _gK= $(n)*$(n)*$(n)*$(n)*$(gK);\n\
+      _f= mdt/$(C);\n\
+      $(V)= ($(V)+_f*(_gNa*$(ENa)+_gK*$(EK)+$(gl)*$(El)+$(Isyn)))/(1.0+_f*(_gNa+_gK+$(gl)));\n\
+    }\n";
+    n.thresholdConditionCode = "$(V) > 0.0";
+    n.dps= NULL;
+    nModels.push_back(n);
+    TRAUBMILES_RL= nModels.size()-1;
+    n.gateNames.clear();
+    n.gateAlphaCode.clear();
+    n.gateBetaCode.clear();
+    n.gateDT= "DT";
+
+
+    // Poisson neurons drawing counter-based random numbers, which need no seed variable per neuron;
+    // the rates are thresholds on the scale of MYRAND_MAX as for POISSONNEURON
+    n.varNames.clear();
+    n.varTypes.clear();
+    n.varNames.push_back("V");
+    n.varTypes.push_back("scalar");
+    n.varNames.push_back("spikeTime");
+    n.varTypes.push_back("scalar");
+    n.pNames.clear();
+    n.pNames.push_back("therate");
+    n.pNames.push_back("trefract");
+    n.pNames.push_back("Vspike");
+    n.pNames.push_back("Vrest");
+    n.dpNames.clear();
+    n.extraGlobalNeuronKernelParameters.clear();
+    n.extraGlobalNeuronKernelParameterTypes.clear();
+    n.extraGlobalNeuronKernelParameters.push_back("rates");
+    n.extraGlobalNeuronKernelParameterTypes.push_back("uint64_t *");
+    n.extraGlobalNeuronKernelParameters.push_back("offset");
+    n.extraGlobalNeuronKernelParameterTypes.push_back("unsigned int");
+    n.simCode= "    if ($(V) > $(Vrest)) {\n\
+      $(V)= $(Vrest);\n\
+    }\n\
+    else {\n\
+      if ($(t) - $(spikeTime) > ($(trefract))) {\n\
+        if ($(gennrand_uniform)*MYRAND_MAX < *($(rates)+$(offset)+$(id))) {\n\
+          $(V)= $(Vspike);\n\
+          $(spikeTime)= $(t);\n\
+        }\n\
+      }\n\
+    }\n";
+    n.thresholdConditionCode = "$(V) >= $(Vspike)";
+    n.dps= NULL;
+    nModels.push_back(n);
+    POISSONNEURON_PHILOX= nModels.size()-1;
+
+
+    // Poisson neurons that draw the time step of their next spike rather than a random number in
+    // every time step; the intervals between the steps allowed by the refractory period are geometric,
+    // so that the spike trains are those of POISSONNEURON. Changes of the rates or offset take effect
+    // when the spikes are rescheduled, which is requested by setting reschedule to true.
+    n.varNames.push_back("nextSpike");
+    n.varTypes.push_back("unsigned long long");
+    n.dpNames.push_back("refractSteps");
+    n.extraGlobalNeuronKernelParameters.push_back("reschedule");
+    n.extraGlobalNeuronKernelParameterTypes.push_back("bool");
+    n.simCode= "    if ($(V) > $(Vrest)) {\n\
+      $(V)= $(Vrest);\n\
+    }\n\
+    if ($(reschedule)) {\n\
+      scalar _first= floor($(spikeTime)/DT + 0.5) + $(refractSteps);\n\
+      $(nextSpike)= gennrandNextEvent((_first > iT) ? (unsigned long long) _first : iT, $(gennrand_uniform), *($(rates)+$(offset)+$(id))*3.5527136788005009e-15);\n\
+    }\n\
+    if ($(nextSpike) == iT) {\n\
+      $(V)= $(Vspike);\n\
+      $(spikeTime)= $(t);\n\
+      $(nextSpike)= gennrandNextEvent(iT + (unsigned long long) $(refractSteps), $(gennrand_uniform), *($(rates)+$(offset)+$(id))*3.5527136788005009e-15);\n\
+    }\n";
+    n.dps= new poissonEventdp();
+    nModels.push_back(n);
+    POISSONNEURON_EVENT= nModels.size()-1;
+    n.dpNames.clear();
+    n.extraGlobalNeuronKernelParameters.clear();
+    n.extraGlobalNeuronKernelParameterTypes.clear();
+
+
+    // Spike source array (neurons that emit preloaded spike times) - the spike times of all neurons are
+    // held in spikeTimes in compressed sparse row format; startSpike is the cursor at the next spike of
+    // a neuron and endSpike the end of its spikes. Spikes that fall into the same time step are emitted
+    // once. The arrays are best set up with gennLoadSpikeSourceArray() from spikeSourceUtils.h.
+    n.varNames.clear();
+    n.varTypes.clear();
+    n.varNames.push_back("startSpike");
+    n.varTypes.push_back("unsigned int");
+    n.varNames.push_back("endSpike");
+    n.varTypes.push_back("unsigned int");
+    n.pNames.clear();
+    n.extraGlobalNeuronKernelParameters.push_back("spikeTimes");
+    n.extraGlobalNeuronKernelParameterTypes.push_back("scalar *");
+    n.simCode= "";
+    n.thresholdConditionCode= "$(startSpike) != $(endSpike) && $(t) >= $(spikeTimes)[$(startSpike)]";
+    n.resetCode= "do {\n\
+      $(startSpike)++;\n\
+    } while ($(startSpike) != $(endSpike) && $(t) >= $(spikeTimes)[$(startSpike)]);\n";
+    n.needAutoRefractory= false;
+    n.dps= NULL;
+    nModels.push_back(n);
+    SPIKESOURCEARRAY= nModels.size()-1;
+    n.resetCode= "";
+    n.needAutoRefractory= true;
+    n.extraGlobalNeuronKernelParameters.clear();
+    n.extraGlobalNeuronKernelParameterTypes.clear();
+
+
 #include "extra_neurons.h"
 }
 
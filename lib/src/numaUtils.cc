@@ -0,0 +1,198 @@
+//--------------------------------------------------------------------------
+/*! \file numaUtils.cc
+
+  \brief Implementation of the functions used by generated CPU code to simulate groups on the NUMA nodes given by their cluster index.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef NUMAUTILS_CC
+#define NUMAUTILS_CC
+
+#include "numaUtils.h"
+#include "stringUtils.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#ifndef _WIN32
+#include <pthread.h>
+#include <stdint.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using namespace std;
+
+namespace {
+    vector<int> nodeIDs; //!< NUMA node IDs of the threads
+#ifndef _WIN32
+    vector<pthread_t> workers; //!< Worker threads of nodeIDs[1] ...
+    pthread_mutex_t mutex= PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t taskReady= PTHREAD_COND_INITIALIZER;
+    pthread_cond_t taskDone= PTHREAD_COND_INITIALIZER;
+    void (*task)(int, void *)= NULL; //!< Current task
+    void *taskArg= NULL; //!< Argument of the current task
+    unsigned long taskNo= 0; //!< Number of tasks started so far
+    int busy= 0; //!< Number of workers still running the current task
+    bool stopping= false; //!< Whether the workers are asked to stop
+#endif
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that pins the calling thread to the CPUs of a NUMA node as listed by the kernel. Other operating systems keep the thread unpinned.
+ */
+//--------------------------------------------------------------------------
+
+static void pinToNode(int node //!< NUMA node ID
+    )
+{
+#ifdef __linux__
+    string name= "/sys/devices/system/node/node" + tS(node) + "/cpulist";
+    ifstream is(name.c_str());
+    string list;
+    if (!is.good() || !getline(is, list)) {
+	cerr << "Warning: NUMA node " << node << " does not exist; its thread is not pinned." << endl;
+	return;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    istringstream ranges(list);
+    string range;
+    while (getline(ranges, range, ',')) {
+	int first, last;
+	if (sscanf(range.c_str(), "%d-%d", &first, &last) < 2) last= first;
+	for (int cpu= first; cpu <= last; cpu++) CPU_SET(cpu, &cpus);
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+	cerr << "Warning: could not pin a thread to NUMA node " << node << "." << endl;
+    }
+#endif
+}
+
+
+#ifndef _WIN32
+//--------------------------------------------------------------------------
+/*! \brief Function run by the worker thread of a node, which waits for tasks until it is stopped.
+ */
+//--------------------------------------------------------------------------
+
+static void *numaWorker(void *arg //!< Index of the node
+    )
+{
+    int k= (int) (intptr_t) arg;
+    pinToNode(nodeIDs[k]);
+    unsigned long done= 0;
+    pthread_mutex_lock(&mutex);
+    while (true) {
+	while ((taskNo == done) && !stopping) pthread_cond_wait(&taskReady, &mutex);
+	if (stopping) break;
+	done= taskNo;
+	void (*f)(int, void *)= task;
+	void *a= taskArg;
+	pthread_mutex_unlock(&mutex);
+	f(k, a);
+	pthread_mutex_lock(&mutex);
+	if (--busy == 0) pthread_cond_signal(&taskDone);
+    }
+    pthread_mutex_unlock(&mutex);
+    return NULL;
+}
+#endif
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that pins the calling thread to nodes[0] and starts one pinned worker thread for each of the other NUMA nodes.
+ */
+//--------------------------------------------------------------------------
+
+void numaStartWorkers(const int *nodes, //!< NUMA node IDs
+		      int nodeN //!< Number of NUMA nodes
+    )
+{
+    numaStopWorkers();
+    nodeIDs.assign(nodes, nodes + nodeN);
+    pinToNode(nodeIDs[0]);
+#ifndef _WIN32
+    stopping= false;
+    workers.resize(nodeN - 1);
+    for (int k= 1; k < nodeN; k++) {
+	if (pthread_create(&workers[k - 1], NULL, numaWorker, (void *) (intptr_t) k) != 0) {
+	    cerr << "GeNN error: could not start the thread of NUMA node " << nodeIDs[k] << "." << endl;
+	    exit(EXIT_FAILURE);
+	}
+    }
+#endif
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that runs task(k, arg) on the thread of the k-th node for all nodes and waits until all of them are done.
+ */
+//--------------------------------------------------------------------------
+
+void numaRun(void (*f)(int, void *), //!< Task to run; its first argument is the index of the node
+	     void *arg //!< Argument passed on to the task
+    )
+{
+#ifndef _WIN32
+    if (workers.size() > 0) {
+	pthread_mutex_lock(&mutex);
+	task= f;
+	taskArg= arg;
+	busy= workers.size();
+	taskNo++;
+	pthread_cond_broadcast(&taskReady);
+	pthread_mutex_unlock(&mutex);
+	f(0, arg);
+	pthread_mutex_lock(&mutex);
+	while (busy > 0) pthread_cond_wait(&taskDone, &mutex);
+	pthread_mutex_unlock(&mutex);
+	return;
+    }
+#endif
+    for (int k= 0; k < (int) max(nodeIDs.size(), (size_t) 1); k++) f(k, arg);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that stops the worker threads.
+ */
+//--------------------------------------------------------------------------
+
+void numaStopWorkers()
+{
+#ifndef _WIN32
+    if (workers.size() == 0) return;
+    pthread_mutex_lock(&mutex);
+    stopping= true;
+    pthread_cond_broadcast(&taskReady);
+    pthread_mutex_unlock(&mutex);
+    for (int k= 0; k < workers.size(); k++) pthread_join(workers[k], NULL);
+    workers.clear();
+    // the next workers start counting from 0 and must not see the last task of these ones
+    taskNo= 0;
+    task= NULL;
+    taskArg= NULL;
+    busy= 0;
+#endif
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that writes zeros to an array, so that its pages are placed on the NUMA node of the calling thread.
+ */
+//--------------------------------------------------------------------------
+
+void numaTouch(void *array, //!< The array
+	       size_t size //!< Size of the array in bytes
+    )
+{
+    memset(array, 0, size);
+}
+
+#endif // NUMAUTILS_CC
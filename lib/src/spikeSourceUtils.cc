@@ -0,0 +1,126 @@
+//--------------------------------------------------------------------------
+/*! \file spikeSourceUtils.cc
+
+  \brief Implementation of the functions for loading the spike times of SPIKESOURCEARRAY neuron groups.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef SPIKESOURCEUTILS_CC
+#define SPIKESOURCEUTILS_CC
+
+#include "spikeSourceUtils.h"
+
+#include <cstring>
+#include <map>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+    map<char *, pair<char *, size_t> > mappedSpikeSources; //!< Start and size of the mapped spike source array files by the address of their spike times
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that maps a spike source array file into memory and returns the address of its spike times.
+
+  The cursors startSpike and the ends endSpike of the N neurons are set from the row starts in the file. Files whose row starts decrease or point beyond the spikes in the file are rejected. The mapping is private, i.e. the file is never changed. Without mmap (Windows) the file is read into memory instead.
+ */
+//--------------------------------------------------------------------------
+
+void *gennMapSpikeSourceArray(const string &file, //!< Name of the file
+			      unsigned int N, //!< Number of neurons of the group
+			      unsigned int timeSize, //!< Size of a spike time of the model in bytes
+			      unsigned int *startSpike, //!< Array of the startSpike variables of the group
+			      unsigned int *endSpike //!< Array of the endSpike variables of the group
+    )
+{
+    char *data;
+    size_t size;
+#ifdef _WIN32
+    FILE *f= fopen(file.c_str(), "rb");
+    if (f == NULL) {
+	gennError("Could not open spike source array file " + file + ".");
+    }
+    fseek(f, 0, SEEK_END);
+    size= ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data= new char[size];
+    bool ok= (fread(data, 1, size, f) == size);
+    fclose(f);
+    if (!ok) {
+	delete[] data;
+	gennError("Could not read spike source array file " + file + ".");
+    }
+#else
+    int fd= open(file.c_str(), O_RDONLY);
+    struct stat st;
+    if ((fd < 0) || (fstat(fd, &st) != 0)) {
+	gennError("Could not open spike source array file " + file + ".");
+    }
+    size= st.st_size;
+    void *mapped= (size > 0) ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (mapped == MAP_FAILED) {
+	gennError("Could not map spike source array file " + file + " into memory.");
+    }
+    data= (char *) mapped;
+#endif
+    unsigned int header[4]= {0, 0, 0, 0};
+    if (size >= sizeof(header)) memcpy(header, data, sizeof(header));
+    size_t timesOffset= ((sizeof(header) + (N + 1) * sizeof(unsigned int) + 7) / 8) * 8;
+    string problem;
+    if (header[0] != GENN_SSA_MAGIC) problem= " is not a spike source array file.";
+    else if (header[1] != timeSize) problem= " holds spike times of " + tS(header[1]) + " bytes but the model uses spike times of " + tS(timeSize) + " bytes.";
+    else if (header[2] != N) problem= " holds the spikes of " + tS(header[2]) + " neurons but the neuron group has " + tS(N) + " neurons.";
+    else if (size < timesOffset + (size_t) header[3] * timeSize) problem= " is truncated.";
+    else {
+	// the neuron code reads the spike times from startSpike to endSpike without further checks
+	const unsigned int *rows= (const unsigned int *) (data + sizeof(header));
+	for (unsigned int i= 0; i < N; i++) {
+	    if ((rows[i] > rows[i + 1]) || (rows[i + 1] > header[3])) {
+		problem= " has invalid row starts for neuron " + tS(i) + ".";
+		break;
+	    }
+	}
+    }
+    if (problem != "") {
+#ifdef _WIN32
+	delete[] data;
+#else
+	munmap(data, size);
+#endif
+	gennError("Spike source array file " + file + problem);
+    }
+    memcpy(startSpike, data + sizeof(header), N * sizeof(unsigned int));
+    memcpy(endSpike, data + sizeof(header) + sizeof(unsigned int), N * sizeof(unsigned int));
+    mappedSpikeSources[data + timesOffset]= make_pair(data, size);
+    return data + timesOffset;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that unmaps the spike times returned by gennLoadSpikeSourceArray(); NULL is ignored.
+ */
+//--------------------------------------------------------------------------
+
+void gennUnmapSpikeSourceArray(void *spikeTimes //!< Spike times returned by gennLoadSpikeSourceArray()
+    )
+{
+    if (spikeTimes == NULL) return;
+    map<char *, pair<char *, size_t> >::iterator mapped= mappedSpikeSources.find((char *) spikeTimes);
+    if (mapped == mappedSpikeSources.end()) {
+	gennError("The spike times were not loaded with gennLoadSpikeSourceArray().");
+    }
+#ifdef _WIN32
+    delete[] mapped->second.first;
+#else
+    munmap(mapped->second.first, mapped->second.second);
+#endif
+    mappedSpikeSources.erase(mapped);
+}
+
+#endif // SPIKESOURCEUTILS_CC
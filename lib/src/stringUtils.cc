@@ -4,6 +4,12 @@
 
 #include "stringUtils.h"
 #include "utils.h"
+#include "codeOptimiser.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+#include <cctype>
 
 #if !defined(__GNUC__) || (__GNUC__ >= 4 && __GNUC_MINOR__ >= 9)
 #include <regex>
@@ -210,6 +216,37 @@ void ensureMathFunctionFtype(string &code, string type)
 }
 
 
+//--------------------------------------------------------------------------
+/*! \brief This function replaces the calls of exp, log, tanh and pow by calls of the inline functions of the fast and approximate math precision tiers, which are defined in definitions.h. Only calls of these names are replaced, not of names that merely end in them (e.g. ldexp).
+ */
+//--------------------------------------------------------------------------
+
+void ensureMathPrecision(string &code, string type, unsigned int mathPrecision)
+{
+    if ((mathPrecision == GENN_MATH_EXACT) || ((type != "float") && (type != "double"))) return;
+    const char *names[]= { "exp", "log", "tanh", "pow" };
+    const char *gennNames[]= { "gennExp", "gennLog", "gennTanh", "gennPow" };
+    string suffix= ((type == "float") ? "f" : "");
+    for (int k= 0; k < 4; k++) {
+	string trg= string(names[k]) + suffix;
+	size_t pos= 0;
+	while ((pos= code.find(trg, pos)) != string::npos) {
+	    size_t end= pos + trg.size();
+	    while ((end < code.size()) && isspace(code[end])) end++;
+	    bool isCall= (end < code.size()) && (code[end] == '(');
+	    bool isName= (pos == 0) || !(isalnum(code[pos-1]) || (code[pos-1] == '_') || (code[pos-1] == '.'));
+	    if (isCall && isName) {
+		code.replace(pos, trg.size(), string(gennNames[k]) + suffix);
+		pos+= string(gennNames[k]).size();
+	    }
+	    else {
+		pos+= trg.size();
+	    }
+	}
+    }
+}
+
+
 //--------------------------------------------------------------------------
 /*! \brief This function is part of the parser that converts any floating point constant in a code snippet to a floating point constant with an explicit precision (by appending "f" or removing it). 
  */
@@ -239,11 +276,11 @@ void doFinal(string &code, unsigned int i, string type, unsigned int &state)
 
 
 //--------------------------------------------------------------------------
-/*! \brief This function implements a parser that converts any floating point constant in a code snippet to a floating point constant with an explicit precision (by appending "f" or removing it). 
+/*! \brief This function implements a parser that converts any floating point constant in a code snippet to a floating point constant with an explicit precision (by appending "f" or removing it). Math functions are converted to the precision and to the math precision tier of the model.
  */
 //--------------------------------------------------------------------------
 
-string ensureFtype(string oldcode, string type) 
+string ensureFtype(string oldcode, string type, unsigned int mathPrecision) 
 {
 //    cerr << "entering ensure" << endl;
 //    cerr << oldcode << endl;
@@ -337,6 +374,7 @@ string ensureFtype(string oldcode, string type)
 	}
     }
     ensureMathFunctionFtype(code, type);
+    ensureMathPrecision(code, type, mathPrecision);
     return code;
 }
 
@@ -369,6 +407,170 @@ void checkUnreplacedVariables(string code, string codeName)
 #endif
 
 
+//--------------------------------------------------------------------------
+/*! \brief This function substitutes the parameters and derived parameters of a neuron group in a code snippet.
+
+  Parameters are inserted as constants; the runtime parameters of the group and its derived parameters are replaced by the names of their global variables.
+ */
+//--------------------------------------------------------------------------
+
+void neuron_para_substitutions(string &code, NNmodel &model, unsigned int i, string ext)
+{
+    unsigned int nt= model.neuronType[i];
+    vector<string> names= model.runtimeNeuronParaNames(i);
+    extended_name_substitutions(code, tS(""), names, ext, model.neuronName[i]);
+    extended_value_substitutions(code, nModels[nt].pNames, ext, model.neuronPara[i]);
+    extended_value_substitutions(code, nModels[nt].dpNames, ext, model.dnp[i]);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function replaces the references $(NAME) to the tabulated functions of the model of neuron group i by calls of their lookup functions, which are generated by neuron_tables_code().
+ */
+//--------------------------------------------------------------------------
+
+void neuron_table_substitutions(string &code, NNmodel &model, unsigned int i)
+{
+    neuronModel &nm= nModels[model.neuronType[i]];
+    for (int k= 0, l= nm.tableNames.size(); k < l; k++) {
+	substitute(code, tS("$(") + nm.tableNames[k] + tS(")"), nm.tableNames[k] + model.neuronName[i] + tS("($(") + nm.tableVars[k] + tS("))"));
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function replaces $(gennrand_uniform) and $(gennrand_normal) in the code of neuron group i by calls of gennrandUniform() and gennrandNormal(). The counter of a draw is made of the index id of the neuron, the time step iT and the number rndN of draws of the neuron in this time step, which the code that declares the neuron's variables sets to 0.
+ */
+//--------------------------------------------------------------------------
+
+void gennrand_substitutions(string &code, unsigned int i, const string &id)
+{
+    string args= tS("(gennrandSeed, ") + tS(i) + tS(", ") + id + tS(", iT, rndN++)");
+    substitute(code, tS("$(gennrand_uniform)"), tS("gennrandUniform") + args);
+    substitute(code, tS("$(gennrand_normal)"), tS("gennrandNormal") + args);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function returns a floating point constant of type ftype with all the digits needed to reproduce val.
+ */
+//--------------------------------------------------------------------------
+
+string ftypeConstant(double val, const string &ftype)
+{
+    char buf[64];
+    if (ftype == tS("float")) snprintf(buf, sizeof(buf), "%#.9gf", val);
+    else snprintf(buf, sizeof(buf), "%#.17g", val);
+    return tS(buf);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function generates the lookup tables of the tabulated functions of the model of neuron group i and the functions that interpolate them linearly.
+
+  The functions are evaluated at generation time with the parameter values of the group and stored with the precision of the model. Arguments outside the range of a table are clamped to the range. The qualifier is prepended to the declarations of the tables and functions, e.g. "__device__" for the GPU code. If report is set, the largest error of the interpolation, estimated at the midpoints and quarter points of the table intervals, is printed.
+ */
+//--------------------------------------------------------------------------
+
+string neuron_tables_code(NNmodel &model, unsigned int i, string qualifier, bool report)
+{
+    neuronModel &nm= nModels[model.neuronType[i]];
+    unsigned int tableN= nm.tableNames.size();
+    if ((nm.tableCode.size() != tableN) || (nm.tableVars.size() != tableN) || (nm.tableMin.size() != tableN)
+	|| (nm.tableMax.size() != tableN) || (nm.tableStep.size() != tableN)) {
+	gennError("Each tabulated function of a neuron model needs its code, variable, range and step.");
+    }
+    string code;
+    for (unsigned int k= 0; k < tableN; k++) {
+	string name= nm.tableNames[k] + model.neuronName[i];
+	if (find(nm.varNames.begin(), nm.varNames.end(), nm.tableVars[k]) == nm.varNames.end()) {
+	    gennError("The tabulated function " + nm.tableNames[k] + " depends on \"" + nm.tableVars[k] + "\", which is not a variable of its neuron model.");
+	}
+	if ((nm.tableStep[k] <= 0.0) || (nm.tableMax[k] <= nm.tableMin[k])) {
+	    gennError("The tabulated function " + nm.tableNames[k] + " needs a positive step and a non-empty range.");
+	}
+	double x0= nm.tableMin[k];
+	unsigned int n= (unsigned int) floor((nm.tableMax[k] - x0)/nm.tableStep[k] + 0.5) + 1;
+	if (n < 2) n= 2;
+	double dx= (nm.tableMax[k] - x0)/(n - 1);
+
+	// evaluate the function at generation time
+	string fCode= nm.tableCode[k];
+	neuron_para_substitutions(fCode, model, i);
+	vector<double> y(4*(n-1)+1);
+	for (unsigned int j= 0; j < y.size(); j++) {
+	    char x[64];
+	    snprintf(x, sizeof(x), "(%.17g)", x0 + j*dx/4.0);
+	    string xCode= fCode;
+	    substitute(xCode, tS("$(") + nm.tableVars[k] + tS(")"), tS(x));
+	    if (!evaluateExpression(xCode, y[j]) || !isfinite(y[j])) {
+		gennError("The tabulated function " + nm.tableNames[k] + " of neuron group " + model.neuronName[i] + " cannot be evaluated at " + nm.tableVars[k] + "= " + tS(x) + "; it must be a finite function of " + nm.tableVars[k] + " and of parameters that are not runtime parameters.");
+	    }
+	}
+	if (report) {
+	    double absErr= 0.0, relErr= 0.0;
+	    for (unsigned int j= 0; j < n-1; j++) {
+		for (unsigned int q= 1; q < 4; q++) {
+		    double exact= y[4*j+q];
+		    double err= fabs(y[4*j] + 0.25*q*(y[4*j+4] - y[4*j]) - exact);
+		    absErr= max(absErr, err);
+		    if (exact != 0.0) relErr= max(relErr, err/fabs(exact));
+		}
+	    }
+	    cout << "table " << nm.tableNames[k] << " of neuron group " << model.neuronName[i] << ": " << n << " entries over " << nm.tableVars[k] << " in [" << x0 << ", " << nm.tableMax[k] << "], max. interpolation error " << absErr << " (relative " << relErr << ")" << endl;
+	}
+
+	// the table and its lookup function
+	code+= qualifier + tS("const ") + model.ftype + tS(" ") + name + tS("Table[") + tS(n) + tS("]= {");
+	for (unsigned int j= 0; j < n; j++) {
+	    if (j > 0) code+= tS(",");
+	    code+= ((j % 8 == 0) ? tS("\n    ") : tS(" ")) + ftypeConstant(y[4*j], model.ftype);
+	}
+	code+= tS("\n};\n\n");
+	code+= qualifier + tS("inline ") + model.ftype + tS(" ") + name + tS("(") + model.ftype + tS(" x)\n{\n");
+	code+= tS("    ") + model.ftype + tS(" p= (x - (") + ftypeConstant(x0, model.ftype) + tS("))*") + ftypeConstant(1.0/dx, model.ftype) + tS(";\n");
+	code+= tS("    if (p < 0) p= 0;\n");
+	code+= tS("    if (p > ") + tS(n-1) + tS(") p= ") + tS(n-1) + tS(";\n");
+	code+= tS("    unsigned int j= (unsigned int) p;\n");
+	code+= tS("    if (j > ") + tS(n-2) + tS(") j= ") + tS(n-2) + tS(";\n");
+	code+= tS("    p-= j;\n");
+	code+= tS("    return ") + name + tS("Table[j] + p*(") + name + tS("Table[j+1] - ") + name + tS("Table[j]);\n");
+	code+= tS("}\n\n");
+    }
+    return code;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function substitutes the weight update parameters and derived parameters of a synapse group in a code snippet.
+ */
+//--------------------------------------------------------------------------
+
+void synapse_para_substitutions(string &code, NNmodel &model, unsigned int i)
+{
+    unsigned int synt= model.synapseType[i];
+    vector<string> names= model.runtimeSynapseParaNames(i);
+    name_substitutions(code, tS(""), names, model.synapseName[i]);
+    value_substitutions(code, weightUpdateModels[synt].pNames, model.synapsePara[i]);
+    value_substitutions(code, weightUpdateModels[synt].dpNames, model.dsp_w[i]);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function substitutes the postsynaptic parameters and derived parameters of a synapse group in a code snippet.
+ */
+//--------------------------------------------------------------------------
+
+void postsynapse_para_substitutions(string &code, NNmodel &model, unsigned int i)
+{
+    unsigned int psynt= model.postSynapseType[i];
+    vector<string> names= model.runtimePostSynapseParaNames(i);
+    name_substitutions(code, tS(""), names, model.synapseName[i]);
+    value_substitutions(code, postSynModels[psynt].pNames, model.postSynapsePara[i]);
+    value_substitutions(code, postSynModels[psynt].dpNames, model.dpsp[i]);
+}
+
+
 //-------------------------------------------------------------------------
 /*!
   \brief Function for performing the code and value substitutions necessary to insert neuron related variables, parameters, and extraGlobal parameters into synaptic code.
@@ -402,8 +604,7 @@ void neuron_substitutions_in_synaptic_code(
 		       devPrefix + nModels[nt_pre].varNames[j] + model.neuronName[src] + tS("[") + preIdx + tS("]"));
 	}
     }
-    extended_value_substitutions(wCode, nModels[nt_pre].pNames, tS("_pre"), model.neuronPara[src]);
-    extended_value_substitutions(wCode, nModels[nt_pre].dpNames, tS("_pre"), model.dnp[src]);
+    neuron_para_substitutions(wCode, model, src, tS("_pre"));
     extended_name_substitutions(wCode, devPrefix, nModels[nt_pre].extraGlobalNeuronKernelParameters, tS("_pre"), model.neuronName[src]);
     
     // postsynaptic neuron variables, parameters, and global parameters
@@ -418,9 +619,108 @@ void neuron_substitutions_in_synaptic_code(
 		       devPrefix + nModels[nt_post].varNames[j] + model.neuronName[trg] + tS("[") + postIdx + tS("]"));
 	}
     }
-    extended_value_substitutions(wCode, nModels[nt_post].pNames, tS("_post"), model.neuronPara[trg]);
-    extended_value_substitutions(wCode, nModels[nt_post].dpNames, tS("_post"), model.dnp[trg]);
+    neuron_para_substitutions(wCode, model, trg, tS("_post"));
     extended_name_substitutions(wCode, devPrefix, nModels[nt_post].extraGlobalNeuronKernelParameters, tS("_post"), model.neuronName[trg]);
 }
 
+
+//--------------------------------------------------------------------------
+/*! \brief This function appends prefix + name + suffix to floatNames for all names whose type is scalar or ftype, or a pointer to them.
+ */
+//--------------------------------------------------------------------------
+
+static void addFloatNames(vector<string> &floatNames, const vector<string> &names, const vector<string> &types, const string &ftype, const string &prefix, const string &suffix)
+{
+    for (int k= 0, l= min(names.size(), types.size()); k < l; k++) {
+	string type= types[k];
+	type.erase(remove(type.begin(), type.end(), ' '), type.end());
+	if (!type.empty() && (type[type.size()-1] == '*')) type.erase(type.size()-1);
+	if ((type == tS("scalar")) || (type == ftype)) floatNames.push_back(prefix + names[k] + suffix);
+    }
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function returns the names of the floating point variables, arrays and parameters that the substituted code snippets of neuron group i and of the postsynaptic models of its incoming synapse groups can refer to, for optimiseStatements().
+ */
+//--------------------------------------------------------------------------
+
+vector<string> neuronFloatNames(NNmodel &model, //!< the neuronal network model to generate code for
+				unsigned int i, //!< the index of the neuron group
+				const string &suffix, //!< suffix of the local names of looked up parameters of merged groups; empty for a single group
+				const vector<string> &inSynSuffix //!< suffixes of the arrays of the incoming synapse groups; empty for their names
+    )
+{
+    neuronModel &nm= nModels[model.neuronType[i]];
+    vector<string> floatNames;
+    floatNames.push_back(tS("t"));
+    floatNames.push_back(tS("DT"));
+    floatNames.push_back(tS("Isyn"));
+    floatNames.push_back(tS("lsT"));
+    addFloatNames(floatNames, nm.varNames, nm.varTypes, model.ftype, tS("l"), tS(""));
+    addFloatNames(floatNames, nm.extraGlobalNeuronKernelParameters, nm.extraGlobalNeuronKernelParameterTypes, model.ftype, tS(""), model.neuronName[i]);
+    vector<string> names= model.runtimeNeuronParaNames(i);
+    for (int k= 0; k < names.size(); k++) floatNames.push_back(names[k] + model.neuronName[i]);
+    if (suffix != tS("")) {
+	for (int k= 0; k < nm.pNames.size(); k++) floatNames.push_back(nm.pNames[k] + suffix);
+	for (int k= 0; k < nm.dpNames.size(); k++) floatNames.push_back(nm.dpNames[k] + suffix);
+    }
+    for (int j= 0; j < model.inSyn[i].size(); j++) {
+	unsigned int synPopID= model.inSyn[i][j];
+	postSynModel &psm= postSynModels[model.postSynapseType[synPopID]];
+	string sName= (j < inSynSuffix.size()) ? inSynSuffix[j] : model.synapseName[synPopID];
+	floatNames.push_back(tS("inSyn") + sName);
+	floatNames.push_back(tS("linSyn") + sName);
+	floatNames.push_back(tS("dd_inSyn") + sName);
+	addFloatNames(floatNames, psm.varNames, psm.varTypes, model.ftype, tS("lps"), sName);
+	names= model.runtimePostSynapseParaNames(synPopID);
+	for (int k= 0; k < names.size(); k++) floatNames.push_back(names[k] + model.synapseName[synPopID]);
+	if (suffix != tS("")) {
+	    for (int k= 0; k < psm.pNames.size(); k++) floatNames.push_back(psm.pNames[k] + sName);
+	    for (int k= 0; k < psm.dpNames.size(); k++) floatNames.push_back(psm.dpNames[k] + sName);
+	}
+    }
+    return floatNames;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief This function returns the names of the floating point variables, arrays and parameters that the substituted code snippets of synapse group i can refer to, for optimiseStatements(). Both the host names and the device names with the prefix "dd_" are included.
+ */
+//--------------------------------------------------------------------------
+
+vector<string> synapseFloatNames(NNmodel &model, //!< the neuronal network model to generate code for
+				 unsigned int i //!< the index of the synapse group
+    )
+{
+    weightUpdateModel &wu= weightUpdateModels[model.synapseType[i]];
+    vector<string> floatNames;
+    floatNames.push_back(tS("t"));
+    floatNames.push_back(tS("DT"));
+    floatNames.push_back(tS("addtoinSyn"));
+    floatNames.push_back(tS("linSyn"));
+    floatNames.push_back(tS("shLg"));
+    const string prefixes[2]= {tS(""), tS("dd_")};
+    for (int p= 0; p < 2; p++) {
+	floatNames.push_back(prefixes[p] + tS("inSyn") + model.synapseName[i]);
+	addFloatNames(floatNames, wu.varNames, wu.varTypes, model.ftype, prefixes[p], model.synapseName[i]);
+	addFloatNames(floatNames, wu.extraGlobalSynapseKernelParameters, wu.extraGlobalSynapseKernelParameterTypes, model.ftype, prefixes[p], model.synapseName[i]);
+    }
+    vector<string> names= model.runtimeSynapseParaNames(i);
+    for (int k= 0; k < names.size(); k++) floatNames.push_back(names[k] + model.synapseName[i]);
+    const unsigned int groups[2]= {model.synapseSource[i], model.synapseTarget[i]};
+    for (int g= 0; g < 2; g++) {
+	neuronModel &nm= nModels[model.neuronType[groups[g]]];
+	const string &nName= model.neuronName[groups[g]];
+	for (int p= 0; p < 2; p++) {
+	    floatNames.push_back(prefixes[p] + tS("sT") + nName);
+	    addFloatNames(floatNames, nm.varNames, nm.varTypes, model.ftype, prefixes[p], nName);
+	    addFloatNames(floatNames, nm.extraGlobalNeuronKernelParameters, nm.extraGlobalNeuronKernelParameterTypes, model.ftype, prefixes[p], nName);
+	}
+	names= model.runtimeNeuronParaNames(groups[g]);
+	for (int k= 0; k < names.size(); k++) floatNames.push_back(names[k] + nName);
+    }
+    return floatNames;
+}
+
 #endif // STRINGUTILS_CC
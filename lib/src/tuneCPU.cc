@@ -0,0 +1,183 @@
+//--------------------------------------------------------------------------
+/*! \file tuneCPU.cc
+
+  \brief Implementation of the functions for choosing the configuration of the generated CPU code by timing variants of a model. Part of the code generation section.
+*/
+//--------------------------------------------------------------------------
+
+#ifndef TUNECPU_CC
+#define TUNECPU_CC
+
+#include "tuneCPU.h"
+#include "generateCPU.h"
+#include "global.h"
+#include "utils.h"
+#include "stringUtils.h"
+#include "hr_time.h"
+
+#include <fstream>
+#include <cstdlib>
+#include <vector>
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that tells whether the simulation of a model needs data that are not part of the model description, i.e. sparse connectivity or extra global parameters that are arrays.
+ */
+//--------------------------------------------------------------------------
+
+static bool needsSetup(NNmodel &model //!< Model description
+    )
+{
+    for (int i= 0; i < model.neuronGrpN; i++) {
+	vector<string> &types= nModels[model.neuronType[i]].extraGlobalNeuronKernelParameterTypes;
+	for (int k= 0; k < types.size(); k++) {
+	    if (types[k].find("*") != string::npos) return true;
+	}
+    }
+    for (int i= 0; i < model.synapseGrpN; i++) {
+	if (model.synapseConnType[i] == SPARSE) return true;
+	vector<string> &types= weightUpdateModels[model.synapseType[i]].extraGlobalSynapseKernelParameterTypes;
+	for (int k= 0; k < types.size(); k++) {
+	    if (types[k].find("*") != string::npos) return true;
+	}
+    }
+    return false;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that reads a stored configuration into the preferences. Returns false if there is none.
+ */
+//--------------------------------------------------------------------------
+
+static bool readConfiguration(string name //!< Name of the configuration file
+    )
+{
+    ifstream is(name.c_str());
+    if (!is.good()) return false;
+    string key;
+    while (is >> key) {
+	if (key == "mergeNeuronGroups") is >> GENN_PREFERENCES::mergeNeuronGroups;
+	else if (key == "optimiseSnippets") is >> GENN_PREFERENCES::optimiseSnippets;
+	else if (key == "maxCPUISA") is >> GENN_PREFERENCES::maxCPUISA;
+	else if (key == "pullSpikeFraction") is >> GENN_PREFERENCES::pullSpikeFraction;
+	else getline(is, key);
+    }
+    return true;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that chooses the configuration of the CPU code of a finalized model and sets the corresponding GENN_PREFERENCES.
+ */
+//--------------------------------------------------------------------------
+
+void tuneCPUCode(NNmodel &model, //!< Model description
+		 string path, //!< Directory in which the code of the model is generated
+		 void (*setup)(JITModel *), //!< Function that prepares a loaded variant for simulation
+		 unsigned int steps //!< Number of time steps for which each variant is timed
+    )
+{
+#ifndef _WIN32
+    string codePath= path + "/" + model.name + "_CODE";
+    string configName= codePath + "/cpu_tuning";
+    if (readConfiguration(configName)) {
+	cout << "using the CPU code configuration in " << configName << endl;
+	return;
+    }
+    if ((setup == NULL) && needsSetup(model)) {
+	cerr << "Warning: model " << model.name << " needs sparse connectivity or extra global arrays to be simulated; call tuneCPUCode() with a setup function to tune its CPU code." << endl;
+	return;
+    }
+    cout << "tuning CPU code..." << endl;
+
+    // variants that differ in their generated code
+    bool merge= GENN_PREFERENCES::mergeNeuronGroups;
+    bool optimise= GENN_PREFERENCES::optimiseSnippets;
+    double pullFraction= GENN_PREFERENCES::pullSpikeFraction;
+    vector<bool> mergeVariants(1, true), optimiseVariants;
+    vector<double> pullVariants(1, 1.0);
+    if (mergeNeuronGroups(model).size() < model.neuronGrpN) mergeVariants.push_back(false);
+    optimiseVariants.push_back(true);
+    optimiseVariants.push_back(false);
+    for (int i= 0; i < model.synapseGrpN; i++) {
+	if ((model.synapseConnType[i] == SPARSE) && model.synapseUsesPostLearning[i]) {
+	    pullVariants.push_back(0.25);
+	    break;
+	}
+    }
+
+    string tuningPath= path + "/" + model.name + "_TUNING";
+    if (system(("mkdir -p \"" + tuningPath + "\"").c_str()) != 0) {
+	gennError("Could not create the directory " + tuningPath + " for tuning the CPU code.");
+    }
+    const char *isaNames[]= {"default", "SSE4.2", "AVX2", "AVX-512"};
+    double bestTime= -1.0;
+    bool bestMerge= merge, bestOptimise= optimise;
+    double bestPull= pullFraction;
+    unsigned int bestISA= GENN_PREFERENCES::maxCPUISA;
+    unsigned int warmup= steps/10 + 1;
+    CStopWatch timer;
+    for (int m= 0; m < mergeVariants.size(); m++) {
+	for (int o= 0; o < optimiseVariants.size(); o++) {
+	    for (int p= 0; p < pullVariants.size(); p++) {
+		GENN_PREFERENCES::mergeNeuronGroups= mergeVariants[m];
+		GENN_PREFERENCES::optimiseSnippets= optimiseVariants[o];
+		GENN_PREFERENCES::pullSpikeFraction= pullVariants[p];
+		JITModel *jit= buildModelJIT(model, tuningPath);
+		jit->allocateMem();
+		jit->initialize();
+		jit->init();
+		if (setup != NULL) setup(jit);
+
+		// the instruction set level is chosen at runtime, so all levels up to the best one are timed in the same build
+		int *isa= (jit->hasSymbol("genn_isa") ? jit->getVar<int>("genn_isa") : NULL);
+		int maxISA= (isa != NULL ? *isa : 0);
+		for (int level= maxISA; level >= 0; level--) {
+		    if (isa != NULL) *isa= level;
+		    for (int i= 0; i < warmup; i++) jit->stepTimeCPU();
+		    timer.startTimer();
+		    for (int i= 0; i < steps; i++) jit->stepTimeCPU();
+		    timer.stopTimer();
+		    double time= timer.getElapsedTime()/steps;
+		    cout << "mergeNeuronGroups " << mergeVariants[m] << ", optimiseSnippets " << optimiseVariants[o] << ", pullSpikeFraction " << pullVariants[p];
+		    cout << ", instruction set " << (isa != NULL ? isaNames[level] : "default") << ": " << time*1e6 << " us per time step" << endl;
+		    if ((bestTime < 0.0) || (time < bestTime)) {
+			bestTime= time;
+			bestMerge= mergeVariants[m];
+			bestOptimise= optimiseVariants[o];
+			bestPull= pullVariants[p];
+			bestISA= (isa != NULL ? level : GENN_PREFERENCES::maxCPUISA);
+		    }
+		}
+		jit->freeMem();
+		unloadModelJIT(jit);
+	    }
+	}
+    }
+    if (system(("rm -rf \"" + tuningPath + "\"").c_str()) != 0) {
+	cerr << "Warning: could not remove the directory " << tuningPath << "." << endl;
+    }
+
+    // use and store the fastest configuration
+    GENN_PREFERENCES::mergeNeuronGroups= bestMerge;
+    GENN_PREFERENCES::optimiseSnippets= bestOptimise;
+    GENN_PREFERENCES::pullSpikeFraction= bestPull;
+    GENN_PREFERENCES::maxCPUISA= bestISA;
+    if (system(("mkdir -p \"" + codePath + "\"").c_str()) != 0) {
+	gennError("Could not create the directory " + codePath + ".");
+    }
+    ofstream os(configName.c_str());
+    os << "# CPU code configuration chosen by tuneCPUCode(); delete this file to tune again" << endl;
+    os << "mergeNeuronGroups " << bestMerge << endl;
+    os << "optimiseSnippets " << bestOptimise << endl;
+    os << "pullSpikeFraction " << bestPull << endl;
+    os << "maxCPUISA " << bestISA << endl;
+    os.close();
+    cout << "chose mergeNeuronGroups " << bestMerge << ", optimiseSnippets " << bestOptimise << ", maxCPUISA " << bestISA << endl;
+#else
+    cerr << "Warning: tuning the CPU code is not supported on Windows." << endl;
+#endif
+}
+
+#endif // TUNECPU_CC
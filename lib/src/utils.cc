@@ -24,7 +24,13 @@
 #include "utils.h"
 
 #include <fstream>
+#include <algorithm>
 #include <stdint.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
 
 
 #ifndef CPU_ONLY
@@ -105,6 +111,93 @@ void writeHeader(ostream &os)
 }
 
 
+//--------------------------------------------------------------------------
+/*! \brief Function that writes content to a file only if the file does not exist yet or its current content differs. Unchanged files keep their time stamp so that make does not recompile them.
+ */
+//--------------------------------------------------------------------------
+
+void writeFileIfChanged(const string &name, const string &content)
+{
+    ifstream is(name.c_str(), ios::in | ios::binary);
+    if (is.good()) {
+	ostringstream old;
+	old << is.rdbuf();
+	if (old.str() == content) return;
+    }
+    is.close();
+    ofstream os(name.c_str(), ios::out | ios::binary);
+    if (!os.good()) {
+	gennError("Could not open " + name + " for writing.");
+    }
+    os << content;
+    os.close();
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that extends a 64 bit FNV-1a hash by the characters of a string.
+ */
+//--------------------------------------------------------------------------
+
+uint64_t hashString(const string &s, uint64_t hash)
+{
+    for (size_t i= 0; i < s.size(); i++) {
+	hash^= (unsigned char) s[i];
+	hash*= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that extends a 64 bit FNV-1a hash by the content of a file. Missing files do not change the hash.
+ */
+//--------------------------------------------------------------------------
+
+uint64_t hashFile(const string &name, uint64_t hash)
+{
+    ifstream is(name.c_str(), ios::in | ios::binary);
+    if (!is.good()) return hash;
+    ostringstream content;
+    content << is.rdbuf();
+    return hashString(content.str(), hash);
+}
+
+
+//--------------------------------------------------------------------------
+/*! \brief Function that returns the names of the entries (files and subdirectories) of a directory in alphabetical order. The list is empty if the directory does not exist.
+ */
+//--------------------------------------------------------------------------
+
+vector<string> listDirectory(const string &path)
+{
+    vector<string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE h= FindFirstFileA((path + "\\*").c_str(), &data);
+    if (h != INVALID_HANDLE_VALUE) {
+	do {
+	    string name= data.cFileName;
+	    if ((name != ".") && (name != "..")) names.push_back(name);
+	} while (FindNextFileA(h, &data));
+	FindClose(h);
+    }
+#else
+    DIR *dir= opendir(path.c_str());
+    if (dir != NULL) {
+	struct dirent *entry;
+	while ((entry= readdir(dir)) != NULL) {
+	    string name= entry->d_name;
+	    if ((name != ".") && (name != "..")) names.push_back(name);
+	}
+	closedir(dir);
+    }
+#endif
+    sort(names.begin(), names.end());
+    return names;
+}
+
+
 //--------------------------------------------------------------------------
 //! \brief Tool for determining the size of variable types on the current architecture
 //--------------------------------------------------------------------------
@@ -37,6 +37,12 @@ endif
 ifeq ($(DARWIN),DARWIN)
     CXX                 :=clang++
 endif
+# Models whose groups are distributed over several processes (host IDs of setNeuronClusterIndex) are built
+# with "make GENN_MPI=1", which compiles and links with the MPI compiler wrapper
+ifdef GENN_MPI
+    MPICXX              ?=mpicxx
+    CXX                 :=$(MPICXX)
+endif
 ifndef CPU_ONLY
     CXXFLAGS            +=-std=c++11
 else
@@ -68,6 +74,32 @@ else
     endif
 endif
 
+# Profile-guided optimisation (GCC only): "make pgo PGO_ARGS=<arguments>" builds instrumented code, runs
+# $(EXECUTABLE) with these arguments (or the command PGO_RUN), for at most GENN_PGO_STEPS time steps if set,
+# and rebuilds the generated code and the simulation with the recorded profiles and -march=native; in
+# CPU_ONLY builds the simulation and the generated code are also optimised together at link time
+GENN_PGO_DIR            ?=$(CURDIR)/pgo
+PGO_RUN                 ?=./$(EXECUTABLE) $(PGO_ARGS)
+export GENN_PGO_DIR
+ifeq ($(GENN_PGO),generate)
+    CXXFLAGS            +=-fprofile-generate="$(GENN_PGO_DIR)"
+endif
+ifeq ($(GENN_PGO),use)
+    CXXFLAGS            +=-fprofile-use="$(GENN_PGO_DIR)" -fprofile-correction -Wno-missing-profile -march=native
+    ifdef CPU_ONLY
+        CXXFLAGS        +=-flto
+    endif
+endif
+
+# Number of parallel jobs used for compiling the generated code
+GENN_JOBS               ?=$(shell getconf _NPROCESSORS_ONLN 2>/dev/null || echo 1)
+
+# libdl is needed by programs that build and load models at runtime (jitModel.h), libpthread by models
+# whose groups are simulated on several NUMA nodes (numaUtils.h)
+ifneq ($(DARWIN),DARWIN)
+    LINK_FLAGS          +=-ldl -lpthread
+endif
+
 # An auto-generated file containing your cuda device's compute capability
 -include sm_version.mk
 
@@ -82,15 +114,20 @@ OBJECTS                 :=$(foreach obj,$(basename $(SOURCES)),$(obj).o) $(SIM_C
 
 
 # Target rules
-.PHONY: all clean purge show
+.PHONY: all clean purge show runner_code pgo
 
 all: $(EXECUTABLE)
 
 $(EXECUTABLE): $(OBJECTS)
 	$(CXX) $(CXXFLAGS) -o $@ $(OBJECTS) $(LINK_FLAGS)
 
-$(SIM_CODE)/runner.o:
-	cd $(SIM_CODE) && make
+# the generated Makefile decides whether runner.o is out of date and compiles its parts in parallel; the
+# empty recipe lets make look at the time stamp of runner.o again afterwards, so that the executable is
+# only linked again if the sub-make updated it
+$(SIM_CODE)/runner.o: runner_code ;
+
+runner_code:
+	cd $(SIM_CODE) && $(MAKE) -j $(GENN_JOBS)
 
 %.o: %.cc
 	$(CXX) $(CXXFLAGS) -c -o $@ $< $(INCLUDE_FLAGS)
@@ -103,8 +140,16 @@ ifndef CPU_ONLY
 	$(NVCC) $(NVCCFLAGS) -c -o $@ $< $(INCLUDE_FLAGS)
 endif
 
+pgo:
+	rm -rf $(EXECUTABLE) $(foreach obj,$(basename $(SOURCES)),$(obj).o) "$(GENN_PGO_DIR)"
+	cd $(SIM_CODE) && $(MAKE) clean_pgo
+	$(MAKE) GENN_PGO=generate
+	$(PGO_RUN)
+	rm -f $(EXECUTABLE) $(foreach obj,$(basename $(SOURCES)),$(obj).o)
+	$(MAKE) GENN_PGO=use
+
 clean:
-	rm -rf $(EXECUTABLE) *.o *.dSYM/ generateALL
+	rm -rf $(EXECUTABLE) *.o *.dSYM/ generateALL pgo
 	cd $(SIM_CODE) && make clean
 
 purge: clean